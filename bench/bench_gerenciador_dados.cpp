@@ -0,0 +1,423 @@
+// Benchmark: disputa no GerenciadorDados, comparado com a versão de mutex
+// único.
+// 1. Snapshot: um produtor publica amostras (setDados) sem pausa enquanto N
+//    leitores leem o último estado (lerUltimoEstado), como navegação, CAS,
+//    planejador, lógica de comando, coletor e cockpit.
+// 2. Domínios: a atuação lê o comando (getComandosAtuador) enquanto sensor,
+//    coletor de histórico e interface martelam os próprios dados.
+// 3. Histórico: o sensor publica a uma taxa fixa (dezenas de kHz) e o
+//    coletor consome uma amostra por vez; mede perdas e custo do produtor.
+// 4. Lotes: o mesmo com consumirLote; mede amostras por despertar.
+// 5. Frota: um produtor atualiza todos os caminhões enquanto o controle em
+//    lote lê a frota inteira por passada; um GerenciadorDados por caminhão
+//    contra os slots contíguos de FrotaDados.
+//
+// Uso: bin/bench_gerenciador_dados [leitores_max] [ms_por_medida]
+
+#include "frota_dados.h"
+#include "gerenciador_dados.h"
+#include <algorithm>
+#include <boost/circular_buffer.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Relogio;
+
+// Versão antiga: todos os domínios sob o mesmo mutex
+class MutexUnico {
+public:
+  MutexUnico() : historico(200), ultimo(), estado(), operador(), atuador() {}
+  void setDados(const DadosSensores &d) {
+    std::lock_guard<std::mutex> lock(mtx);
+    historico.push_back(d);
+    ultimo = d;
+    cv.notify_one();
+  }
+  uint64_t getDescartadosHistorico() const { return 0; } // Sobrescreve
+  DadosSensores lerUltimoEstado() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ultimo;
+  }
+  DadosSensores consumirDados() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return !historico.empty(); });
+    DadosSensores d = historico.front();
+    historico.pop_front();
+    return d;
+  }
+  int getContadorDados() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return historico.size();
+  }
+  EstadoVeiculo getEstadoVeiculo() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return estado;
+  }
+  void setComandosOperador(const ComandosOperador &c) {
+    std::lock_guard<std::mutex> lock(mtx);
+    operador = c;
+  }
+  ComandosAtuador getComandosAtuador() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return atuador;
+  }
+
+private:
+  boost::circular_buffer<DadosSensores> historico;
+  DadosSensores ultimo;
+  EstadoVeiculo estado;
+  ComandosOperador operador;
+  ComandosAtuador atuador;
+  mutable std::mutex mtx;
+  std::condition_variable cv;
+};
+
+struct Resultado {
+  double escritas_s;   // Publicações por segundo
+  double leituras_s;   // Leituras por segundo (todos os leitores)
+  double escrita_max;  // Pior setDados (us)
+  uint64_t rasgadas;   // Leituras com campos de amostras diferentes
+};
+
+template <typename Loja>
+Resultado medir(Loja &loja, int leitores, int ms) {
+  std::atomic<bool> parar(false);
+  std::atomic<uint64_t> leituras(0), rasgadas(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < leitores; ++i) {
+    threads.emplace_back([&]() {
+      uint64_t n = 0, r = 0;
+      while (!parar.load(std::memory_order_relaxed)) {
+        DadosSensores d = loja.lerUltimoEstado();
+        // O produtor grava o mesmo valor em todos os campos
+        if (d.i_posicao_x != d.i_posicao_y || d.i_posicao_x != d.i_velocidade)
+          ++r;
+        ++n;
+      }
+      leituras += n;
+      rasgadas += r;
+    });
+  }
+
+  DadosSensores d = {0};
+  uint64_t escritas = 0;
+  double pior = 0.0;
+  Relogio::time_point fim = Relogio::now() + std::chrono::milliseconds(ms);
+  Relogio::time_point inicio = Relogio::now();
+  while (Relogio::now() < fim) {
+    int v = (int)(escritas & 0x7fffffff);
+    d.i_posicao_x = d.i_posicao_y = d.i_velocidade = v;
+    Relogio::time_point t0 = Relogio::now();
+    loja.setDados(d);
+    pior = std::max(pior, std::chrono::duration<double, std::micro>(
+                              Relogio::now() - t0)
+                              .count());
+    ++escritas;
+  }
+  double segundos =
+      std::chrono::duration<double>(Relogio::now() - inicio).count();
+  parar = true;
+  for (std::thread &t : threads)
+    t.join();
+
+  return Resultado{escritas / segundos, leituras / segundos, pior,
+                   rasgadas.load()};
+}
+
+volatile int sorvedouro; // Impede o compilador de descartar a leitura
+
+// Uma amostra do histórico, esperando o quanto for preciso
+DadosSensores consumir_um(MutexUnico &loja) { return loja.consumirDados(); }
+
+DadosSensores consumir_um(GerenciadorDados &loja) {
+  static thread_local std::vector<DadosSensores> lote;
+  while (loja.consumirLote(lote, 1, std::chrono::seconds(1)) == 0) {
+  }
+  return lote[0];
+}
+
+// Atuação medida enquanto as outras tarefas usam domínios sem relação
+struct ResultadoDominios {
+  double leituras_s; // getComandosAtuador por segundo
+  double pior;       // Pior leitura (us)
+};
+
+template <typename Loja> ResultadoDominios medir_dominios(Loja &loja, int ms) {
+  std::atomic<bool> parar(false);
+  std::vector<std::thread> outras;
+  outras.emplace_back([&]() { // Sensor
+    DadosSensores d = {0};
+    while (!parar.load(std::memory_order_relaxed))
+      loja.setDados(d);
+  });
+  outras.emplace_back([&]() { // Coletor de histórico (único consumidor)
+    while (!parar.load(std::memory_order_relaxed))
+      if (loja.getContadorDados() > 0)
+        consumir_um(loja);
+  });
+  outras.emplace_back([&]() { // Interface
+    ComandosOperador c = {};
+    while (!parar.load(std::memory_order_relaxed)) {
+      loja.setComandosOperador(c);
+      c.c_acelerar = loja.getEstadoVeiculo().e_automatico;
+    }
+  });
+
+  uint64_t leituras = 0;
+  double pior = 0.0;
+  Relogio::time_point inicio = Relogio::now();
+  Relogio::time_point fim = inicio + std::chrono::milliseconds(ms);
+  for (Relogio::time_point t0 = inicio; t0 < fim; ++leituras) {
+    sorvedouro = loja.getComandosAtuador().aceleracao;
+    Relogio::time_point t1 = Relogio::now();
+    pior = std::max(pior,
+                    std::chrono::duration<double, std::micro>(t1 - t0).count());
+    t0 = t1;
+  }
+  double segundos =
+      std::chrono::duration<double>(Relogio::now() - inicio).count();
+  parar = true;
+  for (std::thread &t : outras)
+    t.join();
+  return ResultadoDominios{leituras / segundos, pior};
+}
+
+// Sensor a `taxa` amostras/s; o coletor marca as que viu em ordem
+struct ResultadoHistorico {
+  double setdados_us; // Custo médio de setDados
+  uint64_t publicadas, consumidas, descartadas;
+};
+
+template <typename Loja>
+ResultadoHistorico medir_historico(Loja &loja, double taxa, int ms) {
+  std::atomic<uint64_t> consumidas(0);
+  std::thread coletor([&]() {
+    uint64_t n = 0;
+    for (;;) {
+      DadosSensores d = consumir_um(loja);
+      if (d.id < 0) // Amostra de encerramento
+        break;
+      ++n;
+    }
+    consumidas = n;
+  });
+
+  const std::chrono::nanoseconds passo((int64_t)(1e9 / taxa));
+  DadosSensores d = {0};
+  uint64_t publicadas = 0;
+  double custo = 0.0;
+  Relogio::time_point inicio = Relogio::now();
+  Relogio::time_point fim = inicio + std::chrono::milliseconds(ms);
+  for (Relogio::time_point prox = inicio; prox < fim; prox += passo) {
+    while (Relogio::now() < prox) {
+    }
+    Relogio::time_point t0 = Relogio::now();
+    loja.setDados(d);
+    custo += std::chrono::duration<double, std::micro>(Relogio::now() - t0)
+                 .count();
+    ++publicadas;
+  }
+  // Encerra o coletor; repete enquanto o histórico estiver cheio
+  const uint64_t descartadas = loja.getDescartadosHistorico();
+  d.id = -1;
+  for (uint64_t antes = descartadas;; std::this_thread::yield()) {
+    loja.setDados(d);
+    if (loja.getDescartadosHistorico() == antes)
+      break;
+    antes = loja.getDescartadosHistorico();
+  }
+  coletor.join();
+  return ResultadoHistorico{custo / std::max<uint64_t>(publicadas, 1),
+                            publicadas, consumidas.load(), descartadas};
+}
+
+// Coletor em lotes: quantas vezes acordou para as mesmas amostras
+struct ResultadoLote {
+  uint64_t publicadas, consumidas, despertares;
+};
+
+ResultadoLote medir_lotes(GerenciadorDados &loja, double taxa, size_t minimo,
+                          int ms) {
+  std::atomic<bool> parar(false);
+  std::atomic<uint64_t> consumidas(0), despertares(0);
+  std::thread coletor([&]() {
+    std::vector<DadosSensores> lote;
+    lote.reserve(4096);
+    uint64_t n = 0, k = 0;
+    while (!parar.load() || loja.getContadorDados() > 0) {
+      size_t m = loja.consumirLote(lote, 4096, std::chrono::milliseconds(50),
+                                   minimo);
+      n += m;
+      k += m > 0;
+    }
+    consumidas = n;
+    despertares = k;
+  });
+
+  const std::chrono::nanoseconds passo((int64_t)(1e9 / taxa));
+  DadosSensores d = {0};
+  uint64_t publicadas = 0;
+  Relogio::time_point inicio = Relogio::now();
+  Relogio::time_point fim = inicio + std::chrono::milliseconds(ms);
+  for (Relogio::time_point prox = inicio; prox < fim; prox += passo) {
+    while (Relogio::now() < prox) {
+    }
+    loja.setDados(d);
+    ++publicadas;
+  }
+  parar = true;
+  coletor.join();
+  return ResultadoLote{publicadas, consumidas.load(), despertares.load()};
+}
+
+// Passadas de leitura da frota inteira com o produtor ativo
+struct ResultadoFrota {
+  double passadas_s;
+  double ns_caminhao; // Custo de leitura por caminhão
+};
+
+template <typename Publicar, typename Passada>
+ResultadoFrota medir_frota(size_t caminhoes, Publicar publicar,
+                           Passada passada, int ms) {
+  std::atomic<bool> parar(false);
+  std::thread produtor([&]() {
+    DadosSensores d = {0};
+    while (!parar.load(std::memory_order_relaxed)) {
+      for (size_t i = 0; i < caminhoes; ++i) {
+        d.id = (int)i;
+        ++d.i_posicao_x;
+        publicar(i, d);
+      }
+    }
+  });
+
+  uint64_t passadas = 0;
+  Relogio::time_point inicio = Relogio::now();
+  Relogio::time_point fim = inicio + std::chrono::milliseconds(ms);
+  while (Relogio::now() < fim) {
+    sorvedouro = passada();
+    ++passadas;
+  }
+  double segundos =
+      std::chrono::duration<double>(Relogio::now() - inicio).count();
+  parar = true;
+  produtor.join();
+  return ResultadoFrota{passadas / segundos,
+                        segundos * 1e9 / (passadas * (double)caminhoes)};
+}
+
+void imprimir(const char *nome, int leitores, const Resultado &r) {
+  std::printf("  %-8s %2d leitores: %9.0f escritas/s %11.0f leituras/s "
+              "pior escrita %8.1f us, rasgadas %llu\n",
+              nome, leitores, r.escritas_s, r.leituras_s, r.escrita_max,
+              (unsigned long long)r.rasgadas);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int leitores_max = argc > 1 ? std::atoi(argv[1]) : 8;
+  int ms = argc > 2 ? std::atoi(argv[2]) : 500;
+
+  std::printf("%u nucleos, %d ms por medida\n",
+              std::thread::hardware_concurrency(), ms);
+  std::printf("Snapshot:\n");
+  for (int n = 1; n <= leitores_max; n *= 2) {
+    MutexUnico antigo;
+    GerenciadorDados novo;
+    imprimir("mutex", n, medir(antigo, n, ms));
+    imprimir("seqlock", n, medir(novo, n, ms));
+  }
+
+  std::printf("Atuacao com sensor, coletor e interface ativos:\n");
+  {
+    MutexUnico antigo;
+    GerenciadorDados novo;
+    ResultadoDominios a = medir_dominios(antigo, ms);
+    ResultadoDominios b = medir_dominios(novo, ms);
+    std::printf("  mutex unico:  %11.0f leituras/s, pior %8.1f us\n",
+                a.leituras_s, a.pior);
+    std::printf("  por dominio:  %11.0f leituras/s, pior %8.1f us\n",
+                b.leituras_s, b.pior);
+  }
+
+  std::printf("Historico (sensor em taxa fixa, coletor consumindo):\n");
+  for (double taxa = 10000.0; taxa <= 80000.0; taxa *= 2.0) {
+    MutexUnico antigo;
+    GerenciadorDados novo;
+    ResultadoHistorico a = medir_historico(antigo, taxa, ms);
+    ResultadoHistorico b = medir_historico(novo, taxa, ms);
+    std::printf("  %5.0f kHz  mutex+cv: setDados %6.3f us, %llu/%llu "
+                "consumidas\n",
+                taxa / 1000.0, a.setdados_us, (unsigned long long)a.consumidas,
+                (unsigned long long)a.publicadas);
+    std::printf("             anel:     setDados %6.3f us, %llu/%llu "
+                "consumidas, %llu descartadas\n",
+                b.setdados_us, (unsigned long long)b.consumidas,
+                (unsigned long long)b.publicadas,
+                (unsigned long long)b.descartadas);
+  }
+
+  std::printf("Lotes (consumirLote, sensor a 40 kHz):\n");
+  for (size_t minimo = 1; minimo <= 1024; minimo *= 8) {
+    GerenciadorDados novo;
+    ResultadoLote r = medir_lotes(novo, 40000.0, minimo, ms);
+    std::printf("  minimo %4zu: %llu/%llu consumidas em %llu despertares "
+                "(%.0f por despertar)\n",
+                minimo, (unsigned long long)r.consumidas,
+                (unsigned long long)r.publicadas,
+                (unsigned long long)r.despertares,
+                (double)r.consumidas / std::max<uint64_t>(r.despertares, 1));
+  }
+
+  std::printf("Frota (um produtor, leitura de todos os caminhoes):\n");
+  for (size_t caminhoes = 16; caminhoes <= 256; caminhoes *= 4) {
+    std::vector<std::unique_ptr<GerenciadorDados>> separados;
+    std::vector<int> ids;
+    for (size_t i = 0; i < caminhoes; ++i) {
+      separados.emplace_back(new GerenciadorDados());
+      ids.push_back((int)i);
+    }
+    FrotaDados frota(ids);
+
+    // O coletor não roda: o histórico enche e descarta, igual nos dois
+    ResultadoFrota a = medir_frota(
+        caminhoes,
+        [&](size_t i, const DadosSensores &d) { separados[i]->setDados(d); },
+        [&]() {
+          int soma = 0;
+          for (size_t i = 0; i < caminhoes; ++i)
+            soma += separados[i]->lerUltimoEstado().i_posicao_x;
+          return soma;
+        },
+        ms);
+    ResultadoFrota b = medir_frota(
+        caminhoes,
+        [&](size_t i, const DadosSensores &d) { frota.setDados(i, d); },
+        [&]() {
+          int soma = 0;
+          frota.paraCada([&](size_t, const DadosSensores &d, uint64_t) {
+            soma += d.i_posicao_x;
+          });
+          return soma;
+        },
+        ms);
+    std::printf("  %3zu caminhoes  separados: %9.0f passadas/s "
+                "(%5.1f ns/caminhao)\n",
+                caminhoes, a.passadas_s, a.ns_caminhao);
+    std::printf("                 frota:     %9.0f passadas/s "
+                "(%5.1f ns/caminhao)\n",
+                b.passadas_s, b.ns_caminhao);
+  }
+  return 0;
+}
@@ -0,0 +1,129 @@
+// Benchmark: custo por ciclo da trigonometria dos caminhos quentes (modelo de
+// bicicleta, LiDAR, colisão e pure pursuit) para uma frota inteira, com a
+// libm e com as funções de utils/trigonometria.h (tabela de seno na
+// planta, polinômios no controle).
+//
+// Uso: bin/bench_trigonometria [caminhoes] [ciclos]
+
+#include "utils/trigonometria.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+const float GRAUS = (float)M_PI / 180.0f;
+const float RADIANOS = 180.0f / (float)M_PI;
+
+struct Caminhao {
+  float x, y, angulo, velocidade, alvo_x, alvo_y;
+};
+
+// Chamadas de um caminhão num ciclo: bicicleta, LiDAR e colisão (sen/cos do
+// rumo) e pure pursuit (atan2, sen, atan)
+float ciclo_libm(const std::vector<Caminhao> &frota) {
+  float soma = 0.0f;
+  for (const Caminhao &c : frota) {
+    for (int k = 0; k < 3; ++k) {
+      float rad = c.angulo * GRAUS;
+      soma += std::cos(rad) + std::sin(rad);
+    }
+    float alpha =
+        std::atan2(c.alvo_y - c.y, c.alvo_x - c.x) * RADIANOS - c.angulo;
+    soma += std::atan(12.0f * std::sin(alpha * GRAUS) / 2.8f) * RADIANOS;
+  }
+  return soma;
+}
+
+// Estrutura de arrays do pure pursuit, como em LoteControle
+struct LotePursuit {
+  std::vector<float> dx, dy, angulo, giro;
+};
+
+LotePursuit lote;
+
+// Planta com a tabela, caminhão a caminhão; pure pursuit numa passada
+// sobre o lote, como no núcleo de controle_lote.cpp (laço vetorizado)
+float ciclo_rapido(const std::vector<Caminhao> &frota) {
+  float soma = 0.0f;
+  for (const Caminhao &c : frota) {
+    for (int k = 0; k < 3; ++k)
+      soma += cos_graus(c.angulo) + sen_graus(c.angulo);
+  }
+  const float *dx = lote.dx.data(), *dy = lote.dy.data();
+  const float *ang = lote.angulo.data();
+  float *giro = lote.giro.data();
+  for (size_t i = 0; i < frota.size(); ++i) {
+    float alpha = atan2_graus(dy[i], dx[i]) - ang[i];
+    giro[i] = atan_graus(12.0f * sen_poli(alpha) / 2.8f);
+  }
+  for (size_t i = 0; i < frota.size(); ++i)
+    soma += giro[i];
+  return soma;
+}
+
+template <typename F>
+double medir_us(F ciclo, const std::vector<Caminhao> &frota, int ciclos,
+                float &soma) {
+  auto inicio = std::chrono::steady_clock::now();
+  for (int i = 0; i < ciclos; ++i)
+    soma += ciclo(frota);
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - inicio)
+             .count() /
+         ciclos;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int caminhoes = argc > 1 ? std::atoi(argv[1]) : 500;
+  int ciclos = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+  std::mt19937 gerador(42);
+  std::uniform_real_distribution<float> pos(0.0f, 1000.0f), ang(0.0f, 360.0f),
+      desvio(-20.0f, 20.0f);
+  std::vector<Caminhao> frota(caminhoes);
+  for (Caminhao &c : frota) {
+    c.x = pos(gerador);
+    c.y = pos(gerador);
+    c.angulo = ang(gerador);
+    c.velocidade = 10.0f;
+    c.alvo_x = c.x + desvio(gerador);
+    c.alvo_y = c.y + desvio(gerador);
+    lote.dx.push_back(c.alvo_x - c.x);
+    lote.dy.push_back(c.alvo_y - c.y);
+    lote.angulo.push_back(c.angulo);
+  }
+  lote.giro.resize(frota.size());
+
+  // Erro máximo no intervalo usado
+  double erro_sen = 0.0, erro_poli = 0.0, erro_atan2 = 0.0;
+  for (float g = -720.0f; g < 720.0f; g += 0.001f) {
+    double ref = std::sin((double)g * M_PI / 180);
+    erro_sen = std::max(erro_sen, std::fabs(sen_graus(g) - ref));
+    erro_poli = std::max(erro_poli, std::fabs(sen_poli(g) - ref));
+  }
+  for (const Caminhao &c : frota) {
+    double ref = std::atan2((double)(c.alvo_y - c.y), (double)(c.alvo_x - c.x));
+    erro_atan2 = std::max(
+        erro_atan2, std::fabs(atan2_graus(c.alvo_y - c.y, c.alvo_x - c.x) -
+                              ref * 180.0 / M_PI));
+  }
+
+  float soma = 0.0f;
+  medir_us(ciclo_libm, frota, ciclos / 10, soma); // Aquecimento
+  double t_libm = medir_us(ciclo_libm, frota, ciclos, soma);
+  double t_rapido = medir_us(ciclo_rapido, frota, ciclos, soma);
+
+  std::printf("%d caminhoes, %d ciclos\n", caminhoes, ciclos);
+  std::printf("  libm:    %8.2f us/ciclo\n", t_libm);
+  std::printf("  rapidas: %8.2f us/ciclo (%.1fx)\n", t_rapido,
+              t_libm / t_rapido);
+  std::printf("  erro max: sen %.2g (poli %.2g), atan2 %.2g graus (soma %g)\n",
+              erro_sen, erro_poli, erro_atan2, soma);
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file cache_caminhos.h
+ * @brief Cache LRU de caminhos planejados por (célula inicial, célula final).
+ */
+
+#ifndef CACHE_CAMINHOS_H
+#define CACHE_CAMINHOS_H
+
+#include "planejador_rota.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+const size_t MAX_CAMINHOS_CACHE = 64; ///< Caminhos mantidos (LRU).
+
+/**
+ * @class CacheCaminhos
+ * @brief Caminhos célula a célula já planejados, reaproveitados em ciclos
+ * repetitivos (carga/basculamento).
+ *
+ * Cada entrada leva a versão do mapa em que foi calculada; a primeira
+ * consulta ou inserção com versão diferente descarta o cache inteiro. Guarda
+ * também quanto tempo cada caminho custou para estimar a CPU economizada.
+ */
+class CacheCaminhos {
+public:
+  explicit CacheCaminhos(size_t capacidade = MAX_CAMINHOS_CACHE);
+
+  /**
+   * @return Caminho guardado para (inicio, objetivo), ou nullptr. O ponteiro
+   * vale até a próxima inserção.
+   */
+  const std::vector<Celula> *buscar(const Celula &inicio,
+                                    const Celula &objetivo, uint32_t versao);
+
+  /**
+   * @param caminho Trocado com o vetor da entrada, sem cópia: volta com o
+   * conteúdo antigo dela (ou vazio), para ser reaproveitado como buffer.
+   * @param custo_us Tempo gasto para planejar o caminho.
+   * @return Caminho guardado; vale até a próxima inserção.
+   */
+  const std::vector<Celula> &guardar(const Celula &inicio,
+                                     const Celula &objetivo, uint32_t versao,
+                                     std::vector<Celula> &caminho,
+                                     double custo_us);
+
+  void limpar();
+  size_t tamanho() const { return entradas.size(); }
+  size_t acertos() const { return acertos_; }
+  size_t falhas() const { return falhas_; }
+  double economizadoUs() const { return economizado_us; }
+
+private:
+  struct Entrada {
+    std::vector<Celula> caminho;
+    double custo_us;
+    std::list<uint64_t>::iterator pos_uso;
+  };
+
+  size_t capacidade;
+  uint32_t versao_atual;
+  std::list<uint64_t> uso; ///< Chaves da mais recente à mais antiga.
+  std::unordered_map<uint64_t, Entrada> entradas;
+  size_t acertos_, falhas_;
+  double economizado_us;
+
+  static uint64_t chave(const Celula &a, const Celula &b) {
+    return ((uint64_t)(uint16_t)a.x << 48) | ((uint64_t)(uint16_t)a.y << 32) |
+           ((uint64_t)(uint16_t)b.x << 16) | (uint64_t)(uint16_t)b.y;
+  }
+  void atualizarVersao(uint32_t versao);
+};
+
+#endif // CACHE_CAMINHOS_H
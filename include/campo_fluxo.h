@@ -0,0 +1,142 @@
+/**
+ * @file campo_fluxo.h
+ * @brief Campos de fluxo (custo até o destino) compartilhados pela frota.
+ */
+
+#ifndef CAMPO_FLUXO_H
+#define CAMPO_FLUXO_H
+
+#include "planejador_rota.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// Memória dos campos em cache (LRU): ~5 B/célula, um campo a 4096², seis a
+/// 2048².
+const size_t LIMITE_BYTES_CAMPOS_FLUXO = (size_t)128 << 20;
+const int PEDIDOS_PARA_CAMPO = 2; ///< Pedidos a um destino até gerar o campo.
+
+/**
+ * @class CampoFluxo
+ * @brief Campo de integração (Dijkstra a partir do destino) sobre a grade.
+ *
+ * Para cada célula alcançável guarda o custo até o destino e a direção do
+ * próximo passo, de modo que seguir o campo custa O(1) por célula.
+ */
+class CampoFluxo {
+public:
+  static const unsigned char SEM_DIRECAO = 0xFF;
+
+  CampoFluxo(const GradeNavegacao &grade, const Celula &destino);
+
+  const Celula &destino() const { return destino_; }
+
+  /**
+   * @brief Custo (em células) até o destino; negativo se inalcançável.
+   */
+  float custo(int x, int y) const;
+
+  /**
+   * @brief Próxima célula a partir de c seguindo o gradiente.
+   * @return false se c não alcança o destino ou já é o destino.
+   */
+  bool proximo(const Celula &c, Celula &prox) const;
+
+  /**
+   * @brief A mudança da célula (x,y) pode alterar este campo?
+   *
+   * Só células alcançadas pelo campo, ou vizinhas delas, influenciam os
+   * custos; mudanças em regiões isoladas não invalidam o campo.
+   */
+  bool afetadoPor(int x, int y) const;
+
+  /// Memória ocupada pelo campo.
+  size_t bytes() const {
+    return custos.capacity() * sizeof(float) + direcao.capacity();
+  }
+
+private:
+  int w, h;
+  Celula destino_;
+  std::vector<float> custos;
+  std::vector<unsigned char> direcao; ///< Índice em DIRECOES ou SEM_DIRECAO.
+  int bx0, by0, bx1, by1;            ///< Caixa das células alcançadas.
+
+  bool alcancada(int x, int y) const;
+};
+
+struct TrabalhoCampos;
+
+/**
+ * @class CacheCamposFluxo
+ * @brief Um campo por destino frequente, compartilhado entre consultas.
+ *
+ * O campo só é pedido depois de PEDIDOS_PARA_CAMPO pedidos ao mesmo destino
+ * (pontos de carga e basculamento); destinos avulsos continuam com busca
+ * ponto a ponto. A geração (~0,6 s a 2048²) roda numa thread própria sobre
+ * uma cópia do mapa: quem pede não espera e usa a busca ponto a ponto até o
+ * campo ficar pronto. O cache é limitado em bytes, descartando o campo menos
+ * usado; a invalidação é por célula alterada do mapa.
+ */
+class CacheCamposFluxo {
+public:
+  explicit CacheCamposFluxo(size_t limite_bytes = LIMITE_BYTES_CAMPOS_FLUXO);
+  ~CacheCamposFluxo();
+
+  /**
+   * @brief Mapa sobre o qual os próximos campos são gerados (chamar depois
+   * de invalidar ou limpar, a cada mapa novo).
+   */
+  void setGrade(std::shared_ptr<const GradeNavegacao> grade);
+
+  /**
+   * @brief Registra um pedido ao destino e devolve o campo, se houver.
+   *
+   * Quando o destino atinge PEDIDOS_PARA_CAMPO pedidos, encomenda o campo à
+   * thread de geração; não bloqueia.
+   * @return nullptr se o destino ainda não tem campo pronto.
+   */
+  std::shared_ptr<const CampoFluxo> pedir(const Celula &destino);
+
+  /**
+   * @brief Campo já calculado para o destino, sem contar pedido.
+   */
+  std::shared_ptr<const CampoFluxo> buscar(const Celula &destino) const;
+
+  /**
+   * @brief Descarta os campos afetados pelas células alteradas.
+   */
+  void invalidar(const std::vector<Celula> &alteradas);
+
+  void limpar();
+  size_t tamanho() const { return campos.size(); }
+  size_t camposGerados() const { return gerados; }
+  size_t bytesUsados() const { return bytes_usados; }
+
+private:
+  std::shared_ptr<const GradeNavegacao> grade;
+  size_t limite_bytes;
+  size_t bytes_usados;
+  size_t gerados;
+  std::list<int> uso; ///< Destinos do mais recente ao mais antigo.
+  struct Entrada {
+    std::shared_ptr<const CampoFluxo> campo;
+    std::list<int>::iterator pos_uso;
+  };
+  std::unordered_map<int, Entrada> campos;
+  std::unordered_map<int, int> pedidos;
+  std::unordered_set<int> encomendados; ///< Na fila ou em geração.
+  std::shared_ptr<TrabalhoCampos> trabalho; ///< Estado da thread de geração.
+
+  int chave(const Celula &c) const {
+    return c.y * (grade ? grade->largura() : 0) + c.x;
+  }
+  void recolherProntos();
+  void descartarEncomendas();
+  void remover(std::unordered_map<int, Entrada>::iterator it);
+};
+
+#endif // CAMPO_FLUXO_H
@@ -0,0 +1,46 @@
+/**
+ * @file config_tarefas.h
+ * @brief Taxas das tarefas periódicas, lidas de arquivo de configuração.
+ */
+
+#ifndef CONFIG_TAREFAS_H
+#define CONFIG_TAREFAS_H
+
+#include <chrono>
+#include <string>
+
+const float TAXA_MINIMA_HZ = 1.0f;   ///< Abaixo disso a taxa é ajustada.
+const float TAXA_MAXIMA_HZ = 200.0f; ///< Acima disso a taxa é ajustada.
+
+/**
+ * @struct ConfigTarefas
+ * @brief Frequência (Hz) de cada tarefa; os padrões são as taxas originais.
+ */
+struct ConfigTarefas {
+  float sensores = 10.0f;
+  float comando = 10.0f;
+  float navegacao = 10.0f;
+  float monitoramento = 5.0f;
+  float cas = 20.0f;
+  float planejamento = 10.0f;
+  float atuacao = 10.0f;
+
+  /// Sensor -> navegação -> atuação por eventos: a navegação segue a taxa
+  /// do sensor e a taxa de atuação passa a ser só timeout.
+  bool encadeado = false;
+};
+
+/**
+ * @brief Período correspondente a uma frequência em Hz.
+ */
+std::chrono::steady_clock::duration periodo_tarefa(float hz);
+
+/**
+ * @brief Lê linhas "tarefa = hz" e "encadeado = 0|1" (comentários com '#').
+ *
+ * Arquivo ausente mantém os padrões; chaves desconhecidas são avisadas e
+ * taxas fora de [TAXA_MINIMA_HZ, TAXA_MAXIMA_HZ] são limitadas.
+ */
+ConfigTarefas carregar_config_tarefas(const std::string &arquivo);
+
+#endif // CONFIG_TAREFAS_H
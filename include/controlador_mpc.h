@@ -0,0 +1,123 @@
+/**
+ * @file controlador_mpc.h
+ * @brief Controle preditivo por biblioteca de primitivas de movimento.
+ */
+
+#ifndef CONTROLADOR_MPC_H
+#define CONTROLADOR_MPC_H
+
+#include "modelo_veiculo.h"
+#include "perfil_velocidade.h"
+#include <cstddef>
+#include <vector>
+
+const float DT_PRIMITIVA = 0.1f;   ///< Passo do modelo nas primitivas (s).
+const int HORIZONTE_MPC = 15;      ///< Passos por primitiva (1,5 s).
+const float PASSO_VEL_PRIMITIVA = 1.0f; ///< Resolução das tabelas (m/s).
+const int ORCAMENTO_MPC_US = 800;  ///< Tempo máximo de avaliação por ciclo.
+const float FOLGA_SEGURA = 3.0f;   ///< Folga até a parede sem penalidade (m).
+const float FOLGA_COLISAO = 1.6f;  ///< Meia largura do caminhão (m).
+
+/**
+ * @class MapaFolga
+ * @brief Distância de um ponto à parede mais próxima, a partir do grid.
+ *
+ * Calcula a distância exata até os quadrados de parede vizinhos (3x3
+ * células); o resultado é limitado a um lado de célula, mais do que o MPC
+ * precisa para ponderar a folga.
+ */
+class MapaFolga {
+public:
+  MapaFolga(const std::vector<std::vector<char>> &mapa, float tamanho_celula);
+
+  /**
+   * @brief Folga (m) de (x,y) até a parede; 0 dentro da parede ou fora do
+   * mapa.
+   */
+  float folga(float x, float y) const;
+
+private:
+  int w, h;
+  float tamanho_celula;
+  std::vector<unsigned char> parede;
+
+  bool ehParede(int cx, int cy) const {
+    return cx < 0 || cy < 0 || cx >= w || cy >= h ||
+           parede[(size_t)cy * w + cx];
+  }
+};
+
+/**
+ * @class BibliotecaPrimitivas
+ * @brief Trajetórias de curto horizonte geradas uma vez pelo modelo de
+ * bicicleta.
+ *
+ * Para cada velocidade inicial (de 0 a VELOCIDADE_MAXIMA_VEICULO, passo
+ * PASSO_VEL_PRIMITIVA) e cada par (aceleração %, taxa de giro) constante,
+ * guarda os HORIZONTE_MPC estados no referencial do veículo. Os limites de
+ * atuação do simulador já estão embutidos nas trajetórias.
+ */
+class BibliotecaPrimitivas {
+public:
+  static const BibliotecaPrimitivas &instancia();
+
+  int faixas() const { return n_faixas; }
+  int porFaixa() const { return (int)acel.size(); }
+  float aceleracao(int p) const { return acel[p]; }
+  float giro(int p) const { return giros[p]; }
+
+  /**
+   * @brief Estados da primitiva p na faixa de velocidade f (origem na pose
+   * inicial, orientação inicial 0).
+   */
+  const EstadoCinematico *estados(int f, int p) const {
+    return &tabela[((size_t)f * acel.size() + p) * HORIZONTE_MPC];
+  }
+
+  int faixa(float velocidade) const;
+
+private:
+  BibliotecaPrimitivas();
+
+  int n_faixas;
+  std::vector<float> acel;  ///< Comando de aceleração (%) da primitiva.
+  std::vector<float> giros; ///< Taxa de giro comandada (graus/s).
+  std::vector<EstadoCinematico> tabela;
+};
+
+/**
+ * @class ControladorMPC
+ * @brief Escolhe, a cada ciclo, a primitiva de menor custo e aplica o seu
+ * primeiro comando (horizonte deslizante).
+ *
+ * O custo soma, ao longo do horizonte, o erro lateral e de rumo em relação à
+ * rota suavizada, o erro em relação à velocidade do perfil e a falta de folga
+ * até as paredes; trajetórias que encostam na parede são descartadas.
+ */
+class ControladorMPC {
+public:
+  ControladorMPC();
+
+  /**
+   * @param angulo Orientação atual em graus.
+   * @param[in,out] dica Amostra do perfil mais próxima do veículo.
+   * @param folga Mapa de folga; nulo ignora as paredes.
+   * @param[out] aceleracao Comando de aceleração (%).
+   * @param[out] direcao Direção absoluta comandada (graus, [0, 360)).
+   * @return false se nenhuma primitiva foi avaliada.
+   */
+  bool calcular(float x, float y, float angulo, float velocidade,
+                const PerfilVelocidade &perfil, size_t &dica,
+                const MapaFolga *folga, int &aceleracao, int &direcao);
+
+  float ultimoTempoUs() const { return ultimo_tempo_us; }
+  int avaliadas() const { return n_avaliadas; }
+
+private:
+  const BibliotecaPrimitivas &biblioteca;
+  float acel_anterior;
+  float ultimo_tempo_us;
+  int n_avaliadas;
+};
+
+#endif // CONTROLADOR_MPC_H
@@ -0,0 +1,128 @@
+/**
+ * @file controle_lote.h
+ * @brief Malha IP de velocidade e pure pursuit calculadas para vários
+ * caminhões de uma vez.
+ *
+ * O núcleo é uma função pura sobre vetores (estrutura de arrays): o laço não
+ * tem desvios de controle, chamadas virtuais nem alocação. A trigonometria
+ * é a polinomial de utils/trigonometria.h, sem desvios, e o GCC vetoriza o
+ * laço com -O3 (conferido com -fopt-info-vec; o Makefile compila este
+ * arquivo assim). A navegação embarcada usa um lote de um caminhão; um
+ * processo que hospede a frota inteira calcula os comandos de centenas de
+ * caminhões por ciclo numa única thread.
+ */
+
+#ifndef CONTROLE_LOTE_H
+#define CONTROLE_LOTE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class PerfilVelocidade;
+
+/**
+ * @struct GanhosControle
+ * @brief Ganhos e geometria comuns a todos os caminhões do lote.
+ */
+struct GanhosControle {
+  float kp_vel;          ///< Realimentação da velocidade (IP).
+  float ki_vel;          ///< Ganho do integrador do erro de velocidade.
+  float limite_integral; ///< Anti-windup do integrador.
+  float entre_eixos;     ///< Distância entre eixos (m).
+  float k_antecipacao;   ///< Distância de antecipação por velocidade (s).
+  float antecipacao_min; ///< Distância de antecipação mínima (m).
+  float antecipacao_vel_s;   ///< Consulta de velocidade à frente (s).
+  float antecipacao_vel_min; ///< Consulta de velocidade à frente mínima (m).
+
+  GanhosControle()
+      : kp_vel(20.0f), ki_vel(20.0f), limite_integral(100.0f),
+        entre_eixos(6.0f), k_antecipacao(1.1f), antecipacao_min(2.8f),
+        antecipacao_vel_s(0.5f), antecipacao_vel_min(2.0f) {}
+};
+
+/**
+ * @brief Lê ganhos de linhas "chave = valor" (nomes dos campos, comentários
+ * com '#'). Arquivo ausente mantém os padrões.
+ */
+GanhosControle carregar_ganhos_controle(const std::string &arquivo);
+
+/**
+ * @brief Grava os ganhos no formato lido por carregar_ganhos_controle.
+ * @param cabecalho Comentário no início do arquivo (uma linha por '\n').
+ */
+bool salvar_ganhos_controle(const std::string &arquivo,
+                            const GanhosControle &g,
+                            const std::string &cabecalho = "");
+
+/**
+ * @brief Distância de antecipação do pure pursuit na velocidade v.
+ *
+ * O ponto alvo de cada caminhão deve ser escolhido a essa distância antes de
+ * chamar calcular_controle_lote, que usa o mesmo valor na lei de direção.
+ */
+inline float distancia_antecipacao(float v, const GanhosControle &g) {
+  return std::max(g.antecipacao_min, v * g.k_antecipacao);
+}
+
+/**
+ * @struct DicasPerfil
+ * @brief Trechos do perfil consultados no ciclo anterior (buscas locais).
+ */
+struct DicasPerfil {
+  size_t perfil;      ///< Amostra mais próxima do veículo.
+  size_t velocidade;  ///< Trecho da consulta de velocidade.
+  size_t antecipacao; ///< Trecho do ponto de antecipação.
+
+  DicasPerfil() : perfil(0), velocidade(0), antecipacao(0) {}
+};
+
+/**
+ * @brief Referência de um caminhão sobre o perfil da rota.
+ *
+ * A velocidade é consultada um pouco à frente (compensa o atraso da malha e
+ * tira o veículo da inércia no início da rota); o ponto alvo fica a
+ * distancia_antecipacao metros à frente sobre a curva suavizada.
+ * @return Comprimento de arco da posição atual (m).
+ */
+float referencia_perfil(const PerfilVelocidade &perfil, float x, float y,
+                        float v, const GanhosControle &g, DicasPerfil &dicas,
+                        float &v_ref, float &alvo_x, float &alvo_y);
+
+/**
+ * @struct LoteControle
+ * @brief Estado, referência e saída de n caminhões, um vetor por grandeza.
+ */
+struct LoteControle {
+  // Entradas (sensores e planejamento)
+  std::vector<float> x, y;       ///< Posição (m).
+  std::vector<float> angulo;     ///< Orientação (graus).
+  std::vector<float> velocidade; ///< m/s.
+  std::vector<float> v_ref;      ///< Velocidade de referência (m/s).
+  std::vector<float> alvo_x, alvo_y; ///< Ponto de antecipação (m).
+
+  // Estado da malha, preservado entre ciclos
+  std::vector<float> integral_vel;
+
+  // Saídas
+  std::vector<int> aceleracao; ///< Comando de aceleração, [-100, 100] %.
+  std::vector<int> direcao;    ///< Direção absoluta, [0, 360) graus.
+
+  size_t tamanho() const { return x.size(); }
+
+  /// Redimensiona todos os vetores; caminhões novos começam com integral 0.
+  void redimensionar(size_t n);
+};
+
+/**
+ * @brief Um passo de controle para todos os caminhões do lote.
+ *
+ * Lei IP na velocidade (u = -Kp·v + Ki·∫e, com anti-windup) e pure pursuit na
+ * direção (comando = rumo + atan(2·L·sin α / Ld)). Lê as entradas, atualiza
+ * integral_vel e escreve aceleracao e direcao.
+ */
+void calcular_controle_lote(LoteControle &lote, float dt,
+                            const GanhosControle &ganhos = GanhosControle());
+
+#endif // CONTROLE_LOTE_H
@@ -1,6 +1,24 @@
 #ifndef DADOS_H
 #define DADOS_H
 
+#include "utils/anel_fixo.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct CarimboAmostra
+ * @brief Origem e idade de uma amostra de sensores.
+ *
+ * Tempos em microssegundos do relógio monotônico (relogio_monotonico_us),
+ * comum aos processos da mesma máquina.
+ */
+struct CarimboAmostra {
+  uint64_t seq;          // Sequência por caminhão, atribuída na origem
+                         // (simulador); 0 = amostra sem carimbo.
+  int64_t t_origem_us;   // Instante em que a origem gerou a amostra.
+  int64_t t_recepcao_us; // Instante em que o driver a recebeu.
+};
+
 /**
  * @struct DadosSensores
  * @brief Armazena os dados lidos dos sensores do veículo.
@@ -39,6 +57,23 @@ struct DadosSensores {
 
   int o_direcao; // Determina a direção do veículo em graus (-180 a 180°). Ao
                  // acelerar, o veículo se moverá nessa direção.
+
+  CarimboAmostra carimbo; // Sequência e instantes da leitura de origem.
+};
+
+/**
+ * @struct EstatisticasSensores
+ * @brief Contadores de lacuna e idade das amostras, acumulados desde o início
+ * pela tarefa de sensores.
+ */
+struct EstatisticasSensores {
+  uint64_t amostras;    // Amostras novas (sequência diferente da anterior).
+  uint64_t perdidas;    // Sequências puladas: mensagem MQTT perdida ou
+                        // sobrescrita no driver antes de ser lida.
+  uint64_t repetidas;   // Ciclos que releram a mesma amostra (origem parada
+                        // ou mais lenta que a tarefa).
+  int64_t idade_us;     // Idade da última amostra ao ser publicada.
+  int64_t idade_max_us; // Maior idade publicada.
 };
 
 /**
@@ -97,6 +132,28 @@ struct ObjetivoNavegacao {
   float velocidade_alvo; // Velocidade desejada para este segmento.
 };
 
+/**
+ * @struct BloqueioDetectado
+ * @brief Obstáculo visto pelo LiDAR, repassado ao planejador para desvio.
+ */
+struct BloqueioDetectado {
+  float x, y; // Ponto estimado do obstáculo em coordenadas globais (m).
+};
+
+/**
+ * @struct Point
+ * @brief Waypoint de rota em coordenadas globais (metros).
+ */
+struct Point {
+  float x, y;  // Posição do waypoint.
+  float speed; // Velocidade desejada ao seguir para este ponto (m/s).
+};
+
+const size_t CAPACIDADE_ROTA = 2048; ///< Waypoints na fila do planejador.
+
+/// Fila de waypoints do planejador, alocada uma vez.
+typedef AnelFixo<Point, CAPACIDADE_ROTA> Rota;
+
 /**
  * @struct CaminhaoFisico
  * @brief Representa o estado físico completo de um caminhão na simulação.
@@ -117,6 +174,8 @@ struct CaminhaoFisico {
   bool i_falha_hidraulica;        ///< Flag de falha hidráulica injetada.
   int temperatura_ambiente;       ///< Temperatura ambiente local (°C).
   float i_lidar_distancia;        ///< Distância simulada para obstáculo (m).
+  uint64_t seq;                   ///< Passos de simulação deste caminhão.
+  int64_t t_amostra_us;           ///< Instante do último passo (monotônico).
 };
 
 #endif // DADOS_H
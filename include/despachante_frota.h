@@ -0,0 +1,184 @@
+/**
+ * @file despachante_frota.h
+ * @brief Despacho da frota entre pontos de carga e de basculamento.
+ */
+
+#ifndef DESPACHANTE_FROTA_H
+#define DESPACHANTE_FROTA_H
+
+#include "campo_fluxo.h"
+#include "reserva_espaco_tempo.h"
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+const int VAGAS_SITIO_PADRAO = 64;      ///< Caminhões por sítio (fila inclusa).
+const float TEMPO_SERVICO_PADRAO = 60.0f; ///< Carga ou basculamento (s).
+const float VELOCIDADE_DESPACHO = 20.0f;  ///< Velocidade das rotas (m/s).
+const float VELOCIDADE_MEDIA_FROTA = 8.0f; ///< Para estimar o tempo de viagem.
+const float RAIO_CHEGADA_SITIO = 15.0f;   ///< Distância que conta como chegada.
+const float PERIODO_REOTIMIZACAO = 30.0f; ///< Reatribuição completa (s).
+
+/**
+ * @enum TipoSitio
+ * @brief Papel de um ponto de despacho no ciclo do caminhão.
+ */
+enum TipoSitio {
+  SITIO_CARGA,       ///< Frente de lavra: o caminhão sai cheio.
+  SITIO_BASCULAMENTO ///< Britador ou pilha: o caminhão sai vazio.
+};
+
+/**
+ * @struct Sitio
+ * @brief Ponto de carga ou de basculamento.
+ */
+struct Sitio {
+  Celula celula;       ///< Célula livre do ponto no grid de navegação.
+  TipoSitio tipo;
+  int vagas;           ///< Máximo de caminhões a caminho, na fila ou em serviço.
+  float tempo_servico; ///< Duração de uma carga/basculamento (s).
+};
+
+/**
+ * @struct Despacho
+ * @brief Rota nova para um caminhão.
+ *
+ * Sem sítio (-1) e com rota vazia, o caminhão deve parar: não há vaga para
+ * ele ou o destino ficou inalcançável. Volta a ser atribuído nos passos
+ * seguintes.
+ */
+struct Despacho {
+  int id;
+  int sitio;
+  std::deque<Point> rota;
+};
+
+/**
+ * @class DespachanteFrota
+ * @brief Atribuição incremental de caminhões a sítios por custo de viagem.
+ *
+ * Cada sítio tem um campo de fluxo próprio, então a linha da matriz de custos
+ * de um caminhão (tempo de viagem até cada sítio) custa O(sítios) consultas e
+ * só é refeita quando ele muda de célula. O custo de um sítio inclui a fila:
+ * o k-ésimo caminhão atribuído espera k serviços, custo marginal convexo.
+ *
+ * A atribuição é um problema de transporte (caminhões x sítios com vagas)
+ * resolvido por caminhos aumentantes: cada caminhão que fica livre entra pelo
+ * caminho mais barato no grafo residual dos sítios, que pode desviar para
+ * outro sítio caminhões ainda a caminho. Como os nós são só os sítios, cada
+ * inserção custa O(caminhões x sítios); a reatribuição completa da frota é
+ * repetida a cada PERIODO_REOTIMIZACAO para desfazer o que as saídas de
+ * caminhões deixam de subótimo.
+ *
+ * As rotas emitidas passam pela tabela de reservas espaço-tempo da frota
+ * (PlanejadorMultiCaminhao): os primeiros HORIZONTE_RESERVA_PADRAO slots são
+ * planejados sem conflito com as reservas dos outros caminhões, e o restante
+ * segue o campo do sítio. Quando a janela reservada de um caminhão a caminho
+ * está acabando, ela é replanejada a partir da posição atual.
+ */
+class DespachanteFrota {
+public:
+  explicit DespachanteFrota(const GradeNavegacao &grade);
+
+  /**
+   * @brief Cadastra um sítio (posição em metros) e gera o seu campo.
+   * @return Índice do sítio, ou -1 se não houver célula livre próxima.
+   */
+  int adicionarSitio(float x, float y, TipoSitio tipo,
+                     int vagas = VAGAS_SITIO_PADRAO,
+                     float tempo_servico = TEMPO_SERVICO_PADRAO);
+
+  /**
+   * @brief Regera os campos afetados pelas células alteradas do grid.
+   *
+   * A grade passada no construtor já deve estar atualizada.
+   */
+  void mapaAlterado(const std::vector<Celula> &alteradas);
+
+  /**
+   * @brief Posição e disponibilidade (automático e sem falha) do caminhão.
+   *
+   * Caminhões indisponíveis saem da atribuição até voltarem.
+   */
+  void atualizarCaminhao(int id, float x, float y, bool disponivel);
+  void removerCaminhao(int id);
+
+  /**
+   * @brief Avança o ciclo dos caminhões e atribui os que ficaram livres.
+   * @param agora Tempo em segundos (monotônico).
+   * @param saida Rotas novas a publicar (atribuições e desvios).
+   */
+  void passo(double agora, std::vector<Despacho> &saida);
+
+  /**
+   * @brief Refaz a atribuição de todos os caminhões que ainda não chegaram.
+   */
+  void reotimizar(std::vector<Despacho> &saida);
+
+  const std::vector<Sitio> &sitios() const { return sitios_; }
+  size_t caminhoes() const { return frota.size(); }
+  int sitioAtribuido(int id) const;
+
+  /**
+   * @brief Tempo estimado de viagem (s) do caminhão até o sítio; <0 se
+   * inalcançável.
+   */
+  float custoViagem(int id, int sitio) const;
+
+private:
+  enum EstadoCiclo {
+    LIVRE,      ///< Aguardando atribuição.
+    A_CAMINHO,  ///< Atribuído; pode ser desviado.
+    EM_SERVICO, ///< Na fila ou sendo carregado/basculado.
+    PARADO      ///< Indisponível (manual ou em falha).
+  };
+
+  struct Caminhao {
+    int id;
+    float x, y;
+    Celula celula;
+    bool cheio;       ///< Próximo destino é um basculamento.
+    EstadoCiclo estado;
+    int sitio;        ///< Sítio atribuído ou em serviço; -1 se nenhum.
+    double fim_servico;
+    bool linha_valida; ///< custos[] reflete a célula atual.
+    int fim_reserva;   ///< Último slot reservado (máximo: até o sítio).
+  };
+
+  const GradeNavegacao &grade;
+  std::vector<Sitio> sitios_;
+  std::vector<std::shared_ptr<const CampoFluxo>> campos;
+  std::vector<Caminhao> frota;
+  std::unordered_map<int, size_t> indice_id;
+  std::vector<float> custos; ///< frota.size() x sitios_.size(), em segundos.
+  std::vector<int> carga;    ///< Caminhões atribuídos ou em serviço por sítio.
+  std::vector<double> livre_servico; ///< Quando o sítio termina a fila.
+  double agora_;
+  double ultima_reotimizacao;
+
+  // Reservas espaço-tempo das rotas emitidas
+  PlanejadorMultiCaminhao multi;
+  float duracao_slot; ///< Uma célula reta à velocidade média (s).
+  std::vector<PedidoCaminho> pedidos;
+  std::vector<CaminhoTemporal> caminhos;
+
+  // Buffers da busca de caminho aumentante
+  std::vector<float> transf;
+  std::vector<int> transf_arg;
+  std::vector<float> dist;
+  std::vector<int> pred;
+
+  float custo(size_t i, int s);
+  void atualizarLinha(size_t i);
+  float marginal(int s) const;
+  bool inserir(size_t i, TipoSitio tipo, std::vector<size_t> &movidos);
+  void atribuir(size_t i, int s);
+  void desatribuir(size_t i);
+  void parar(size_t i, std::vector<Despacho> &saida);
+  int slotAtual() const { return (int)(agora_ / duracao_slot); }
+  void emitir(const std::vector<size_t> &indices,
+              std::vector<Despacho> &saida);
+};
+
+#endif // DESPACHANTE_FROTA_H
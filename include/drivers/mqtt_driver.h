@@ -9,9 +9,20 @@
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
 using json = nlohmann::json;
 
+/**
+ * @struct MissaoDecodificada
+ * @brief Missão recebida em caminhao/rota, já convertida no thread do MQTT.
+ */
+struct MissaoDecodificada {
+  bool tem_destino = false; // Só destino: o caminho é planejado a bordo.
+  Point destino = {0, 0, 0};
+  std::vector<Point> pontos; // Waypoints (capacidade reaproveitada).
+};
+
 class MqttDriver : public ISensorDriver, public IVeiculoDriver {
 private:
   struct mosquitto *mosq;
@@ -19,8 +30,9 @@ private:
   int port;
   int truck_id; // Added member
 
-  DadosSensores ultimos_dados;
+  DadosSensores ultimos_dados; // Inclui o carimbo da última mensagem
   std::mutex dados_mtx;
+  std::atomic<uint64_t> mensagens_perdidas; // Lacunas na sequência recebida
   std::atomic<bool> conectado; // Kept as std::atomic<bool> based on original
                                // context, assuming the diff's `bool conectado;`
                                // was a partial or incorrect snippet.
@@ -32,6 +44,7 @@ public:
 
   // ISensorDriver
   CaminhaoFisico readSensorData(int id) override;
+  CaminhaoFisico readSensorData(int id, CarimboAmostra &carimbo) override;
   DadosSensores
   lerDados(int id); // Mantemos para compatibilidade se necessário, mas a
                     // interface pede readSensorData
@@ -40,6 +53,10 @@ public:
   void setAtuadores(int aceleracao, int direcao) override;
   void publishSystemState(bool manual, bool fault);
 
+  // Mensagens de sensores que não chegaram (saltos na sequência do
+  // simulador)
+  uint64_t getMensagensPerdidas() const { return mensagens_perdidas.load(); }
+
   // Callbacks
   static void on_connect(struct mosquitto *mosq, void *obj, int rc);
   static void on_message(struct mosquitto *mosq, void *obj,
@@ -48,12 +65,32 @@ public:
 private:
   void handle_sensor_message(const std::string &payload);
   void handle_route_message(const std::string &payload);
+  void handle_map_message(const std::string &payload);
 
-  std::string last_route_json;
-  std::mutex route_mtx;
+  // Buffer triplo sem trava: o thread do MQTT decodifica em
+  // missoes[missao_escrita], o planejador lê missoes[missao_leitura] e os dois
+  // trocam de buffer com o do meio por exchange atômico. MISSAO_NOVA marca um
+  // meio ainda não lido.
+  static const int MISSAO_NOVA = 4;
+  MissaoDecodificada missoes[3];
+  int missao_escrita = 0;
+  int missao_leitura = 1;
+  std::atomic<int> missao_meio{2};
+
+  std::vector<std::vector<char>> ultimo_mapa;
+  bool mapa_novo = false;
+  std::mutex map_mtx;
 
 public:
-  std::string checkNewRoute();
+  /**
+   * @brief Missão recebida desde a última chamada, ou nullptr.
+   * Não bloqueia, não decodifica e não aloca; o ponteiro vale até a próxima
+   * chamada que devolver outra missão.
+   */
+  const MissaoDecodificada *checkNewMission();
+
+  // Entrega o mapa publicado em caminhao/mapa uma única vez por recebimento.
+  bool checkNewMap(std::vector<std::vector<char>> &mapa);
 };
 
 #endif // MQTT_DRIVER_H
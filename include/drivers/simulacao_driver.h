@@ -15,6 +15,8 @@ class SimulacaoDriver : public ISensorDriver, public IVeiculoDriver {
 
     //declaração do método da interface do sensor
     CaminhaoFisico readSensorData(int id_caminhao) override;
+    CaminhaoFisico readSensorData(int id_caminhao,
+                                  CarimboAmostra &carimbo) override;
 
     //declaração do método da interface do veículo
     void setAtuadores(int aceleracao, int direcao) override;
@@ -0,0 +1,153 @@
+/**
+ * @file frota_dados.h
+ * @brief Dados de vários caminhões num único objeto, indexados pelo id.
+ */
+
+#ifndef FROTA_DADOS_H
+#define FROTA_DADOS_H
+
+#include "dados.h"
+#include "utils/anel_spsc.h"
+#include "utils/seqlock.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/// Amostras guardadas por caminhão (~25 s a 10 Hz).
+const size_t CAPACIDADE_HISTORICO_FROTA = 256;
+
+/**
+ * @class FrotaDados
+ * @brief Equivalente de GerenciadorDados para um processo que hospeda a
+ * frota (o despachante): um slot por caminhão, todos num único vetor
+ * contíguo.
+ *
+ * A capacidade é fixada na construção (os slots não mudam de endereço) e os
+ * caminhões ocupam slots conforme aparecem. Cada slot tem o último valor
+ * publicado (SeqLock) e o próprio histórico (anel SPSC), sem mutex nem
+ * variável de condição: o produtor de um caminhão não disputa nada com o de
+ * outro. Os históricos de todos os slots ficam num só buffer, um trecho por
+ * slot. O id é traduzido para o slot uma vez, por tabela de hash; as
+ * operações quentes recebem o índice do slot. Os consumidores da frota
+ * (controle em lote, coletor, despachante) percorrem todos os slots numa
+ * passada em vez de acordar uma tarefa por caminhão.
+ */
+class FrotaDados {
+public:
+  /// @param capacidade Máximo de caminhões; nenhum registrado ainda.
+  explicit FrotaDados(size_t capacidade);
+
+  /// @param ids Caminhões da frota; ids repetidos ocupam um único slot.
+  explicit FrotaDados(const std::vector<int> &ids);
+  ~FrotaDados();
+
+  FrotaDados(const FrotaDados &) = delete;
+  FrotaDados &operator=(const FrotaDados &) = delete;
+
+  /// Slots ocupados; os slots [0, tamanho()) podem ser lidos.
+  size_t tamanho() const { return ocupados.load(std::memory_order_acquire); }
+  size_t capacidade() const { return capacidade_; }
+
+  /**
+   * @brief Slot do caminhão, ocupando um novo se o id ainda não apareceu.
+   *
+   * Lado do produtor: registrar, slot(id) e setDados(dados) devem vir de
+   * uma mesma thread. O slot só fica visível aos consumidores com o id já
+   * gravado.
+   * @return -1 se a frota está cheia.
+   */
+  int registrar(int id);
+
+  /// Slot do caminhão, ou -1 se o id não pertence à frota (lado do produtor).
+  int slot(int id) const {
+    std::unordered_map<int, size_t>::const_iterator it = indice_id.find(id);
+    return it == indice_id.end() ? -1 : (int)it->second;
+  }
+
+  /// Id do caminhão no slot.
+  int id(size_t slot) const { return ids_[slot]; }
+
+  /**
+   * @brief PRODUTOR: publica a amostra do caminhão no slot (último valor e
+   * histórico). Um único produtor por slot; slots diferentes podem ser
+   * escritos por threads diferentes. Com o histórico cheio a amostra só vai
+   * para o último valor e conta em getDescartadosHistorico.
+   */
+  void setDados(size_t slot, const DadosSensores &dados);
+
+  /// Como setDados(slot, dados), localizando o slot por dados.id (lado do
+  /// produtor). @return false se o id não pertence à frota.
+  bool setDados(const DadosSensores &dados);
+
+  /// Última amostra do slot, sem bloquear (seqlock).
+  DadosSensores lerUltimoEstado(size_t slot) const;
+
+  /// Idem, com a sequência por slot e o instante de publicação.
+  DadosSensores
+  lerUltimoEstado(size_t slot, uint64_t &seq,
+                  std::chrono::steady_clock::time_point &instante) const;
+
+  /// Comando calculado para o caminhão (controle em lote -> atuação).
+  void setComandosAtuador(size_t slot, const ComandosAtuador &comandos);
+  ComandosAtuador getComandosAtuador(size_t slot) const;
+
+  /**
+   * @brief Percorre a frota numa passada, em ordem de slot, chamando
+   * f(slot, dados, seq) com a última amostra de cada caminhão. Slots ainda
+   * sem amostra têm seq 0.
+   */
+  template <typename F> void paraCada(F f) const {
+    size_t n = tamanho();
+    for (size_t i = 0; i < n; ++i) {
+      AmostraPublicada a = slots[i].ultimo.ler();
+      f(i, a.dados, a.seq);
+    }
+  }
+
+  /// Últimas amostras de todos os slots, em ordem de slot.
+  void lerFrota(std::vector<DadosSensores> &saida) const;
+
+  /**
+   * @brief CONSUMIDOR DE LOG: substitui o conteúdo de saida pelo histórico
+   * de todos os caminhões, até `maximo_por_caminhao` amostras de cada,
+   * agrupadas por slot. Não bloqueia; um único consumidor para a frota.
+   * @return Número de amostras em saida.
+   */
+  size_t consumirLote(std::vector<DadosSensores> &saida,
+                      size_t maximo_por_caminhao);
+
+  /// Amostras fora do histórico por ele estar cheio (slot / frota).
+  uint64_t getDescartadosHistorico(size_t slot) const;
+  uint64_t getDescartadosHistorico() const;
+
+private:
+  struct AmostraPublicada {
+    DadosSensores dados;
+    uint64_t seq;
+    std::chrono::steady_clock::rep instante; // Ticks desde a época do relógio
+  };
+
+  // Campos do produtor primeiro; o anel separa os índices em linhas de cache
+  struct Slot {
+    SeqLock<AmostraPublicada> ultimo;
+    uint64_t seq; // Amostras publicadas; só o produtor do slot escreve
+    std::atomic<uint64_t> descartados;
+    SeqLock<ComandosAtuador> comandos;
+    AnelSPSC<DadosSensores, CAPACIDADE_HISTORICO_FROTA> historico;
+
+    explicit Slot(DadosSensores *itens)
+        : seq(0), descartados(0), historico(itens) {}
+  };
+
+  size_t capacidade_;
+  std::atomic<size_t> ocupados;
+  std::vector<DadosSensores> itens_historico; // Trecho do slot i: i * CAP
+  Slot *slots; // Contíguos, endereço fixo (construídos no lugar)
+  std::vector<int> ids_; // Id por slot
+  std::unordered_map<int, size_t> indice_id;
+};
+
+#endif // FROTA_DADOS_H
@@ -7,28 +7,99 @@
 #define GERENCIADOR_DADOS_H
 
 #include "dados.h"
-#include <boost/circular_buffer.hpp>
+#include "utils/anel_spsc.h"
+#include "utils/seqlock.h"
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <vector>
 
+class PerfilVelocidade;
+class MapaFolga;
+
+/// Amostras guardadas para o coletor (~0,2 s a 20 kHz).
+const size_t CAPACIDADE_HISTORICO = 4096;
+
+/**
+ * @class GerenciadorDados
+ * @brief Ponto de troca de dados entre as tarefas do caminhão.
+ *
+ * Cada domínio tem a própria sincronização, dimensionada para o seu uso:
+ * valores pequenos lidos a todo ciclo (snapshot dos sensores, estado,
+ * comandos, objetivo) são células SeqLock sem mutex na leitura; o histórico
+ * é um anel SPSC (sensor -> coletor); as esperas por amostra/comando, as
+ * publicações do planejador e o desvio têm cada um seu mutex curto. Tarefas sem relação (atuação, coletor,
+ * interface) não disputam um lock único.
+ */
 class GerenciadorDados {
 private:
-  const int TAMANHO_BUFFER = 200;
-
-  // STREAM: Histórico para log/auditoria (FIFO)
-  boost::circular_buffer<DadosSensores> bufferHistorico;
+  // STREAM: Histórico para log/auditoria (FIFO). Sem lock entre o sensor e o
+  // coletor; o mutex e a variável de condição só são usados quando o coletor
+  // dorme, e o produtor só o acorda ao atingir o lote pedido (limiarColetor)
+  AnelSPSC<DadosSensores, CAPACIDADE_HISTORICO> bufferHistorico;
+  std::atomic<uint64_t> descartadosHistorico; // Amostras com o anel cheio
+  std::atomic<size_t> limiarColetor; // 0: coletor acordado
+  std::mutex mtx_historico;
+  std::condition_variable cv_dados;
 
   // SNAPSHOT: Estado mais recente para controle em tempo real (LVC - Last Value
-  // Cache)
-  DadosSensores ultimoEstado;
+  // Cache). Publicado por seqlock: os leitores não tomam mutex.
+  struct AmostraPublicada {
+    DadosSensores dados;
+    uint64_t seq;
+    std::chrono::steady_clock::rep instante; // Ticks desde a época do relógio
+  };
+  SeqLock<AmostraPublicada> ultimoEstado;
+  // A navegação encadeada anuncia que vai dormir (esperandoEstado); sem
+  // ninguém esperando, o sensor publica sem mutex nem notificação
+  std::atomic<uint64_t> seqEstado; // Amostras publicadas
+  std::atomic<int> esperandoEstado;
+  std::mutex mtx_estado; // Só para a espera da navegação encadeada
+  std::condition_variable cv_estado;
 
-  EstadoVeiculo estadoVeiculo;
-  ComandosOperador comandosOperador;
-  ComandosAtuador comandosAtuador;
-  ObjetivoNavegacao objetivoAtual; // O "General's" order
+  SeqLock<EstatisticasSensores> estatisticasSensores; // Lacunas e idade
 
-  mutable std::mutex mtx;
-  std::condition_variable cv_dados;
+  SeqLock<EstadoVeiculo> estadoVeiculo;
+  SeqLock<ComandosOperador> comandosOperador;
+  SeqLock<ObjetivoNavegacao> objetivoAtual; // O "General's" order
+
+  // Comando dos atuadores com a amostra que o originou (latência)
+  struct ComandosPublicados {
+    ComandosAtuador comandos;
+    uint64_t seq;
+    bool com_amostra; // false: comando sem amostra de origem (falha, recuo)
+    std::chrono::steady_clock::rep instante_amostra;
+  };
+  SeqLock<ComandosPublicados> comandosAtuador;
+  uint64_t seqComandos; // Comandos publicados (acorda a atuação encadeada)
+  std::mutex mtx_comandos;
+  std::condition_variable cv_comandos;
+
+  // Publicações do planejador (trocadas só quando a rota ou o mapa mudam)
+  std::shared_ptr<const PerfilVelocidade> perfilVelocidade; // Da rota atual
+  const PerfilVelocidade *perfilNavegacao; // O último que a navegação pegou
+  std::shared_ptr<const MapaFolga> mapaFolga; // Do mapa atual (MPC)
+  mutable std::mutex mtx_publicacoes;
+
+  // Bloqueio visto pelo CAS (CAS -> Route Planner)
+  BloqueioDetectado bloqueio;
+  bool bloqueioPendente;
+  std::mutex mtx_bloqueio;
+  std::atomic<bool> replanejamentoAtivo;
+  std::atomic<float> limiteVelocidade; // Teto do CAS durante o desvio
+
+  // Recuo após colisão: os atuadores pertencem à lógica de comando
+  std::atomic<bool> manobraRecuo;
+
+  void publicarComandos(const ComandosAtuador &comandos, bool com_amostra,
+                        std::chrono::steady_clock::rep instante_amostra);
+
+  // Dorme até o histórico ter `minimo` amostras (ou até limite)
+  bool aguardarHistorico(size_t minimo,
+                         std::chrono::steady_clock::time_point limite);
 
 public:
   GerenciadorDados();
@@ -36,24 +107,55 @@ public:
   /**
    * @brief PRODUTOR: Insere dados no sistema.
    * Atualiza tanto o histórico (buffer) quanto o snapshot (estado atual).
-   * Thread-safe e não bloqueante (sobrescreve se buffer cheio).
+   * Não bloqueante; um único produtor (tarefa de sensores). Com o histórico
+   * cheio a amostra só vai para o snapshot e conta em getDescartadosHistorico.
+   * Os leitores do snapshot nunca atrasam o produtor.
    */
   void setDados(const DadosSensores &dados);
 
   /**
-   * @brief CONSUMIDOR DE LOG: Retira o dado mais antigo do histórico.
-   * Use apenas para tarefas que precisam salvar o histórico (Coletor de Dados).
-   * BLOQUEANTE: Espera se o buffer estiver vazio.
+   * @brief CONSUMIDOR DE LOG em lote: substitui o conteúdo de saida por até
+   * `maximo` amostras do histórico, em ordem, numa única operação.
+   *
+   * Espera até haver pelo menos `minimo` amostras ou até o timeout; no
+   * timeout devolve o que houver (possivelmente nada). O produtor acorda o
+   * coletor uma vez por lote, não por amostra. Um único consumidor
+   * (Coletor de Dados).
+   * @return Número de amostras em saida.
    */
-  DadosSensores consumirDados();
+  size_t consumirLote(std::vector<DadosSensores> &saida, size_t maximo,
+                      std::chrono::steady_clock::duration timeout,
+                      size_t minimo = 1);
 
   /**
    * @brief LEITOR DE CONTROLE: Lê o estado mais recente sem remover do buffer.
    * Use para Navegação e Lógica de Comando.
-   * NÃO BLOQUEANTE: Retorna imediatamente a última cópia conhecida.
+   * NÃO BLOQUEANTE: Retorna imediatamente a última cópia conhecida, sem
+   * mutex (seqlock); leitores simultâneos não disputam entre si.
    */
   DadosSensores lerUltimoEstado() const;
 
+  /**
+   * @brief Como lerUltimoEstado, devolvendo também o número de sequência e o
+   * instante de publicação da amostra.
+   */
+  DadosSensores lerUltimoEstado(
+      uint64_t &seq, std::chrono::steady_clock::time_point &instante) const;
+
+  /**
+   * @brief Bloqueia até haver amostra mais nova que seq ou até o timeout.
+   * @return Sequência da amostra atual (igual a seq se expirou).
+   */
+  uint64_t aguardarNovoEstado(uint64_t seq,
+                              std::chrono::steady_clock::duration timeout);
+
+  /**
+   * @brief Lacunas de sequência e idade das amostras, publicadas pela tarefa
+   * de sensores a cada ciclo (latência da cadeia simulador -> controle).
+   */
+  void setEstatisticasSensores(const EstatisticasSensores &e);
+  EstatisticasSensores getEstatisticasSensores() const;
+
   // --- Getters e Setters de Estado (Mantidos iguais) ---
   void setEstadoVeiculo(const EstadoVeiculo &estado);
   EstadoVeiculo getEstadoVeiculo() const;
@@ -65,15 +167,106 @@ public:
   void atualizarComandosOperador(const ComandosOperador &comandos);
 
   // --- Acesso Direto à Memória de Atuação (Novo) ---
+  /**
+   * @brief Publica um comando que não deriva de amostra de sensor (freio de
+   * falha, recuo). Não entra na medição de latência sensor -> atuador.
+   */
   void setComandosAtuador(const ComandosAtuador &comandos);
   ComandosAtuador getComandosAtuador() const;
 
+  /**
+   * @brief Publica um comando calculado a partir da amostra publicada em
+   * instante_amostra (base da medição de latência sensor -> atuador).
+   */
+  void setComandosAtuador(
+      const ComandosAtuador &comandos,
+      std::chrono::steady_clock::time_point instante_amostra);
+  /**
+   * @param com_amostra false se o comando foi publicado sem amostra de
+   * origem; instante_amostra então não tem significado.
+   */
+  ComandosAtuador
+  getComandosAtuador(uint64_t &seq, bool &com_amostra,
+                     std::chrono::steady_clock::time_point &instante_amostra)
+      const;
+
+  /**
+   * @brief Bloqueia até haver comando mais novo que seq ou até o timeout.
+   * @return Sequência do comando atual (igual a seq se expirou).
+   */
+  uint64_t aguardarComandosAtuador(uint64_t seq,
+                                   std::chrono::steady_clock::duration timeout);
+
   // --- Interface de Navegação (Route Planner -> Navigation) ---
   void setObjetivo(const ObjetivoNavegacao &obj);
   ObjetivoNavegacao getObjetivo() const;
 
+  /**
+   * @brief Perfil de velocidade da rota atual (nulo sem rota).
+   * Publicado pelo planejador quando a rota muda; a navegação só consulta.
+   */
+  void setPerfilVelocidade(std::shared_ptr<const PerfilVelocidade> perfil);
+
+  /**
+   * @brief Perfil publicado, que passa a ser o perfil em uso da navegação.
+   *
+   * O anterior fica liberado: a navegação não volta a lê-lo depois desta
+   * chamada, e o mutex ordena as leituras dele antes de o planejador
+   * reescrevê-lo.
+   */
+  std::shared_ptr<const PerfilVelocidade> usarPerfilVelocidade();
+
+  /**
+   * @brief Perfil que a navegação pode estar lendo (nulo se nenhum).
+   * O planejador não reescreve este nem o publicado.
+   */
+  const PerfilVelocidade *perfilEmUso() const;
+
+  /**
+   * @brief Folga até as paredes do mapa atual, publicada pelo planejador
+   * quando o mapa chega; usada pelo controle MPC.
+   */
+  void setMapaFolga(std::shared_ptr<const MapaFolga> folga);
+  std::shared_ptr<const MapaFolga> getMapaFolga() const;
+
+  // --- Interface de Desvio (CAS -> Route Planner) ---
+  /**
+   * @brief Reporta um obstáculo ao planejador (sobrescreve o anterior).
+   */
+  void reportarBloqueio(const BloqueioDetectado &b);
+
+  /**
+   * @brief Retira o último bloqueio reportado, se houver.
+   */
+  bool consumirBloqueio(BloqueioDetectado &b);
+
+  /**
+   * @brief O planejador sinaliza se consegue desviar (mapa e rota ativos).
+   * Sem desvio disponível o CAS volta a intertravar (falha 4).
+   */
+  void setReplanejamentoAtivo(bool ativo);
+  bool getReplanejamentoAtivo() const;
+
+  /**
+   * @brief Teto de velocidade (m/s) imposto pelo CAS enquanto um bloqueio à
+   * frente é contornado; infinito sem teto. A navegação freia acima dele.
+   */
+  void setLimiteVelocidade(float v);
+  float getLimiteVelocidade() const;
+
+  /**
+   * @brief Manobra de recuo em curso (lógica de comando). Enquanto ativa,
+   * a navegação não publica comandos e o CAS não intertrava pelo obstáculo
+   * do qual o caminhão está se afastando.
+   */
+  void setManobraRecuo(bool ativa);
+  bool getManobraRecuo() const;
+
   // Retorna tamanho do buffer (para monitoramento)
   int getContadorDados() const;
+
+  /// Amostras que não entraram no histórico por ele estar cheio.
+  uint64_t getDescartadosHistorico() const;
 };
 
 #endif // GERENCIADOR_DADOS_H
\ No newline at end of file
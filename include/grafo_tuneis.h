@@ -0,0 +1,88 @@
+/**
+ * @file grafo_tuneis.h
+ * @brief Grafo topológico da mina: junções, salas e segmentos de túnel.
+ */
+
+#ifndef GRAFO_TUNEIS_H
+#define GRAFO_TUNEIS_H
+
+#include <vector>
+
+/**
+ * @enum TipoNo
+ * @brief Classificação de um nó do grafo de túneis.
+ */
+enum TipoNo {
+  NO_JUNCAO,     ///< Bifurcação de três ou mais túneis.
+  NO_SALA,       ///< Área aberta de escavação (salas, zona de partida).
+  NO_EXTREMIDADE ///< Fim de túnel sem saída.
+};
+
+/**
+ * @struct NoGrafo
+ * @brief Nó do grafo, posicionado em coordenadas de célula do grid.
+ */
+struct NoGrafo {
+  int x, y;    ///< Célula representativa (centro da sala ou da junção).
+  TipoNo tipo; ///< Classificação do nó.
+};
+
+/**
+ * @struct ArestaGrafo
+ * @brief Segmento de túnel entre dois nós.
+ */
+struct ArestaGrafo {
+  int a, b;          ///< Índices dos nós nas extremidades.
+  float comprimento; ///< Comprimento do segmento em células.
+};
+
+/**
+ * @class GrafoTuneis
+ * @brief Representação compacta da topologia da mina.
+ *
+ * Substitui milhões de células por alguns milhares de nós para planejamento
+ * de rota e despacho. Pode ser emitido pelo MineGenerator durante a escavação
+ * ou reconstruído a partir de qualquer grid por esqueletonização.
+ */
+class GrafoTuneis {
+public:
+  int adicionarNo(int x, int y, TipoNo tipo);
+  void adicionarAresta(int a, int b, float comprimento);
+
+  const std::vector<NoGrafo> &nos() const { return nos_; }
+  const std::vector<ArestaGrafo> &arestas() const { return arestas_; }
+
+  /**
+   * @brief Índices (em arestas()) das arestas incidentes ao nó.
+   */
+  const std::vector<int> &arestasDoNo(int no) const { return adjacencia[no]; }
+
+  /**
+   * @brief Nó mais próximo (euclidiano) de uma célula; -1 se o grafo é vazio.
+   */
+  int noMaisProximo(int x, int y) const;
+
+  void limpar();
+
+private:
+  std::vector<NoGrafo> nos_;
+  std::vector<ArestaGrafo> arestas_;
+  std::vector<std::vector<int>> adjacencia;
+};
+
+/**
+ * @brief Reconstrói o grafo de túneis de um grid arbitrário.
+ *
+ * Afina o espaço livre até um esqueleto de 1 célula (Zhang-Suen), marca como
+ * nó os pixels de extremidade e de bifurcação (número de cruzamentos != 2),
+ * agrupa nós adjacentes e transforma cada trecho restante do esqueleto em uma
+ * aresta. Nós com folga até a parede de pelo menos `folga_sala` células são
+ * classificados como sala.
+ *
+ * @param mapa Grid de caracteres ('1' = parede).
+ * @param folga_sala Distância mínima à parede para classificar como sala.
+ */
+GrafoTuneis extrair_grafo_esqueleto(const std::vector<std::vector<char>> &mapa,
+                                    int folga_sala = 3);
+
+#endif // GRAFO_TUNEIS_H
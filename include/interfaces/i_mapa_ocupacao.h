@@ -0,0 +1,44 @@
+#ifndef I_MAPA_OCUPACAO_H
+#define I_MAPA_OCUPACAO_H
+
+/**
+ * @brief Interface de consulta de ocupação do mapa da mina.
+ *
+ * Abstrai a representação do grid (denso ou multi-resolução) para que a
+ * simulação faça raycast e detecção de colisão sem depender do formato
+ * interno. Todas as coordenadas são em células; fora dos limites conta como
+ * ocupado (borda do mundo).
+ */
+class IMapaOcupacao {
+public:
+  virtual ~IMapaOcupacao() = default;
+
+  virtual int largura() const = 0;
+  virtual int altura() const = 0;
+
+  /**
+   * @brief Indica se a célula (gx, gy) é parede ou está fora do mapa.
+   */
+  virtual bool ocupado(int gx, int gy) const = 0;
+
+  /**
+   * @brief Verifica se todas as células do retângulo [x0,x1]x[y0,y1]
+   * (inclusivo) estão livres.
+   */
+  virtual bool regiao_livre(int x0, int y0, int x1, int y1) const = 0;
+
+  /**
+   * @brief Lança um raio a partir de (ox, oy) na direção unitária (dx, dy).
+   * @return Distância (em células) até a primeira célula ocupada, limitada a
+   * dist_max.
+   */
+  virtual float raycast(float ox, float oy, float dx, float dy,
+                        float dist_max) const = 0;
+
+  /**
+   * @brief Nome do backend (para log/diagnóstico).
+   */
+  virtual const char *nome() const = 0;
+};
+
+#endif // I_MAPA_OCUPACAO_H
@@ -7,6 +7,14 @@ class ISensorDriver {
 public:
     virtual ~ISensorDriver() = default;
     virtual CaminhaoFisico readSensorData(int id_caminhao) = 0;
+
+    // Leitura com a sequência e os instantes da amostra; drivers que não
+    // carimbam devolvem seq 0
+    virtual CaminhaoFisico readSensorData(int id_caminhao,
+                                          CarimboAmostra &carimbo) {
+        carimbo = CarimboAmostra{0, 0, 0};
+        return readSensorData(id_caminhao);
+    }
 };
 
 
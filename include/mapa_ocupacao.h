@@ -0,0 +1,111 @@
+/**
+ * @file mapa_ocupacao.h
+ * @brief Backends de ocupação do mapa: grid denso e quadtree.
+ */
+
+#ifndef MAPA_OCUPACAO_H
+#define MAPA_OCUPACAO_H
+
+#include "interfaces/i_mapa_ocupacao.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @class MapaGrade
+ * @brief Backend denso: um byte por célula, raycast por DDA célula a célula.
+ *
+ * Melhor escolha para labirintos estreitos, onde quase toda célula está perto
+ * de uma parede e não há blocos uniformes para agrupar.
+ */
+class MapaGrade : public IMapaOcupacao {
+public:
+  explicit MapaGrade(const std::vector<std::vector<char>> &mapa);
+
+  int largura() const override { return w; }
+  int altura() const override { return h; }
+  bool ocupado(int gx, int gy) const override;
+  bool regiao_livre(int x0, int y0, int x1, int y1) const override;
+  float raycast(float ox, float oy, float dx, float dy,
+                float dist_max) const override;
+  const char *nome() const override { return "grade"; }
+
+private:
+  int w, h;
+  std::vector<unsigned char> celulas; ///< 1 = parede, 0 = livre (row-major).
+};
+
+/**
+ * @class MapaQuadtree
+ * @brief Backend multi-resolução para cavas abertas (open pit).
+ *
+ * O mapa é coberto por um quadrado de lado potência de 2; regiões uniformes
+ * (todas livres ou todas parede) colapsam em uma única folha. A área de
+ * preenchimento além de largura/altura é tratada como parede, de modo que a
+ * borda do mundo também colapsa.
+ *
+ * O raycast salta folhas livres inteiras (sai da caixa da folha em um passo)
+ * e consultas de região descartam blocos livres sem visitar células.
+ */
+class MapaQuadtree : public IMapaOcupacao {
+public:
+  explicit MapaQuadtree(const std::vector<std::vector<char>> &mapa);
+
+  int largura() const override { return w; }
+  int altura() const override { return h; }
+  bool ocupado(int gx, int gy) const override;
+  bool regiao_livre(int x0, int y0, int x1, int y1) const override;
+  float raycast(float ox, float oy, float dx, float dy,
+                float dist_max) const override;
+  const char *nome() const override { return "quadtree"; }
+
+  /**
+   * @brief Número de nós da árvore (para comparar com largura*altura).
+   */
+  size_t numeroNos() const { return nos.size(); }
+
+private:
+  enum Estado : unsigned char { LIVRE = 0, OCUPADO = 1, MISTO = 2 };
+
+  struct No {
+    unsigned char estado;
+    int filhos; ///< Índice do primeiro dos 4 filhos contíguos (-1 se folha).
+  };
+
+  int w, h;
+  int lado_raiz; ///< Lado do quadrado raiz (potência de 2).
+  std::vector<No> nos;
+
+  void construir(const std::vector<std::vector<char>> &mapa, int idx, int x0,
+                 int y0, int lado);
+
+  /**
+   * @brief Localiza a folha que contém a célula (gx, gy).
+   * @param[out] bx,by,lado Caixa (em células) da folha encontrada.
+   * @return Estado da folha.
+   */
+  unsigned char folha(int gx, int gy, int &bx, int &by, int &lado) const;
+
+  bool regiao_livre_no(int idx, int nx, int ny, int lado, int x0, int y0,
+                       int x1, int y1) const;
+};
+
+/**
+ * @brief Fração de células de fronteira abaixo da qual a quadtree compensa.
+ */
+const float LIMIAR_FRONTEIRA_QUADTREE = 0.15f;
+
+/**
+ * @brief Escolhe o backend de ocupação pela densidade de fronteiras do mapa.
+ *
+ * Conta a fração de células cujo vizinho à direita ou abaixo tem estado
+ * diferente. Mapas esparsos (cava aberta, poucas paredes finas) ficam abaixo
+ * do limiar e usam a quadtree; labirintos densos usam o grid.
+ *
+ * @param mapa Grid de caracteres ('1' = parede).
+ * @param limiar_fronteira Fração máxima de fronteiras para usar a quadtree.
+ */
+std::unique_ptr<IMapaOcupacao>
+criar_mapa_ocupacao(const std::vector<std::vector<char>> &mapa,
+                    float limiar_fronteira = LIMIAR_FRONTEIRA_QUADTREE);
+
+#endif // MAPA_OCUPACAO_H
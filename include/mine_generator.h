@@ -1,6 +1,7 @@
 #ifndef MINE_GENERATOR_H
 #define MINE_GENERATOR_H
 
+#include "grafo_tuneis.h"
 #include <random>
 #include <vector>
 
@@ -51,7 +52,24 @@ public:
    */
   const std::vector<std::vector<char>> &getMinefield() const;
 
+  /**
+   * @brief Retorna o grafo topológico emitido durante a geração.
+   *
+   * Nós são junções e extremidades da árvore do labirinto e as salas (incluindo
+   * a zona de partida); arestas são os túneis entre eles com o comprimento em
+   * células. Corredores extras abertos pelo alargamento não entram no grafo,
+   * então toda aresta é garantidamente transitável.
+   */
+  const GrafoTuneis &getGrafo() const;
+
 private:
+  /**
+   * @brief Retângulo escavado como sala (em células).
+   */
+  struct Sala {
+    int x, y, largura, altura;
+  };
+
   int width;
   int height;
   std::vector<std::vector<char>>
@@ -59,6 +77,12 @@ private:
   std::mt19937 rng;
   int lastX, lastY; // Armazena a última posição gerada para colocar o 'B'
 
+  // Estrutura conhecida durante a escavação (base do grafo de túneis)
+  std::vector<std::vector<int>>
+      arvoreLabirinto; // Vizinhos de cada célula ímpar na árvore do labirinto
+  std::vector<Sala> salas; // Salas escavadas (índice 0 = zona de partida)
+  GrafoTuneis grafo;
+
   /**
    * @brief Função recursiva principal do algoritmo.
    * @param x Coordenada X atual.
@@ -71,6 +95,16 @@ private:
    */
   bool isValid(int x, int y);
   void createStartRoom();
+
+  /**
+   * @brief Índice de uma célula ímpar (nó do labirinto) em arvoreLabirinto.
+   */
+  int indiceLabirinto(int x, int y) const;
+
+  /**
+   * @brief Comprime a árvore do labirinto e as salas em um GrafoTuneis.
+   */
+  void construirGrafo();
 };
 
 #endif // MINE_GENERATOR_H
\ No newline at end of file
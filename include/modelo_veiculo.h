@@ -0,0 +1,61 @@
+/**
+ * @file modelo_veiculo.h
+ * @brief Dinâmica do modelo de bicicleta e limites de atuação do caminhão.
+ *
+ * Compartilhado pelo simulador (física) e pelo controlador MPC (geração das
+ * primitivas de movimento), para que os dois usem exatamente o mesmo modelo.
+ */
+
+#ifndef MODELO_VEICULO_H
+#define MODELO_VEICULO_H
+
+#include "utils/trigonometria.h"
+#include <algorithm>
+#include <cmath>
+
+const float ACEL_POR_PERCENT = 0.2f;        ///< m/s² por % de comando.
+const float VELOCIDADE_MAXIMA_VEICULO = 25.0f; ///< Limite (m/s), ~90 km/h.
+const float TAXA_GIRO_VEICULO = 50.0f;      ///< Taxa de giro máxima (graus/s).
+
+/**
+ * @struct EstadoCinematico
+ * @brief Pose e velocidade usadas pelo modelo.
+ */
+struct EstadoCinematico {
+  float x, y;       ///< Posição (m).
+  float angulo;     ///< Orientação em graus, [0, 360), 0 = Leste.
+  float velocidade; ///< m/s, nunca negativa.
+};
+
+/**
+ * @brief Avança o modelo de bicicleta em dt (sem colisão).
+ *
+ * A aceleração é proporcional ao comando (-100 a 100 %); a orientação segue
+ * o ângulo absoluto comandado com taxa limitada; a posição integra a nova
+ * velocidade na nova orientação.
+ */
+inline void avancar_bicicleta(EstadoCinematico &e, float aceleracao_pct,
+                              float direcao_cmd, float dt) {
+  e.velocidade += aceleracao_pct * ACEL_POR_PERCENT * dt;
+  if (e.velocidade < 0.0f)
+    e.velocidade = 0.0f;
+  if (e.velocidade > VELOCIDADE_MAXIMA_VEICULO)
+    e.velocidade = VELOCIDADE_MAXIMA_VEICULO;
+
+  float diff_angulo = direcao_cmd - e.angulo;
+  while (diff_angulo > 180.0f)
+    diff_angulo -= 360.0f;
+  while (diff_angulo < -180.0f)
+    diff_angulo += 360.0f;
+  e.angulo += std::max(-TAXA_GIRO_VEICULO * dt,
+                       std::min(TAXA_GIRO_VEICULO * dt, diff_angulo));
+  if (e.angulo >= 360.0f)
+    e.angulo -= 360.0f;
+  if (e.angulo < 0.0f)
+    e.angulo += 360.0f;
+
+  e.x += e.velocidade * cos_graus(e.angulo) * dt;
+  e.y += e.velocidade * sen_graus(e.angulo) * dt;
+}
+
+#endif // MODELO_VEICULO_H
@@ -0,0 +1,102 @@
+/**
+ * @file perfil_velocidade.h
+ * @brief Suavização da rota e perfil de velocidade limitado por curvatura.
+ */
+
+#ifndef PERFIL_VELOCIDADE_H
+#define PERFIL_VELOCIDADE_H
+
+#include "dados.h"
+#include <cstddef>
+#include <vector>
+
+const float PASSO_PERFIL = 1.0f;         ///< Espaçamento das amostras (m).
+const float CORTE_CANTO_MAX = 5.0f;      ///< Recuo máximo do arco no canto (m).
+const float ACEL_MAX_PERFIL = 2.0f;      ///< Aceleração longitudinal (m/s²).
+const float FRENAGEM_MAX_PERFIL = 3.0f;  ///< Desaceleração longitudinal (m/s²).
+const float ACEL_LATERAL_MAX = 3.0f;     ///< Limite de v²·k (m/s²).
+const float TAXA_GIRO_MAX = 0.87f;       ///< Limite de v·k (rad/s), ~50°/s.
+const size_t AMOSTRAS_RESERVADAS = 8192; ///< ~8 km de rota sem realocar.
+
+/**
+ * @struct AmostraPerfil
+ * @brief Ponto da curva suavizada com a velocidade planejada.
+ */
+struct AmostraPerfil {
+  float x, y;       ///< Posição (m).
+  float s;          ///< Comprimento de arco desde o início (m).
+  float curvatura;  ///< |k| (1/m).
+  float velocidade; ///< Velocidade alvo (m/s).
+};
+
+/**
+ * @class PerfilVelocidade
+ * @brief Rota suavizada e amostrada com velocidade alvo por comprimento de arco.
+ *
+ * Cada canto da poligonal vira um arco de Bézier quadrático tangente aos dois
+ * trechos (spline G1 que não sai do triângulo do canto). A velocidade de cada
+ * amostra é limitada pela velocidade do trecho, pela aceleração lateral e pela
+ * taxa de giro; uma passada para a frente (aceleração) e outra para trás
+ * (frenagem) tornam o perfil dinamicamente viável. Construído uma vez por
+ * rota; a navegação só consulta. Os buffers são reservados na construção e
+ * mantidos entre construir(), então reusar o objeto não aloca.
+ */
+class PerfilVelocidade {
+public:
+  PerfilVelocidade();
+
+  /**
+   * @brief Suaviza a rota a partir de (x0,y0) e calcula o perfil.
+   * @param v0 Velocidade atual do veículo (início da passada para a frente).
+   * @param parar_no_fim Termina com velocidade zero no último waypoint (falso
+   * quando a rota ainda será estendida, p.ex. refinamento HPA* pendente).
+   */
+  void construir(float x0, float y0, float v0, const Rota &rota,
+                 bool parar_no_fim = true);
+
+  bool vazio() const { return amostras_.empty(); }
+  float comprimento() const {
+    return amostras_.empty() ? 0.0f : amostras_.back().s;
+  }
+  const std::vector<AmostraPerfil> &amostras() const { return amostras_; }
+
+  /**
+   * @brief Velocidade alvo no comprimento de arco s (interpolação linear).
+   */
+  float velocidadeEm(float s) const;
+
+  /**
+   * @brief Como velocidadeEm(s), andando a partir do trecho da consulta
+   * anterior: O(1) quando s avança pouco entre ciclos.
+   * @param[in,out] dica Índice do trecho que contém s.
+   */
+  float velocidadeEm(float s, size_t &dica) const;
+
+  /**
+   * @brief Ponto da curva no comprimento de arco s (limitado às pontas).
+   * @param[in,out] dica Índice do trecho que contém s.
+   */
+  void pontoEm(float s, size_t &dica, float &x, float &y) const;
+
+  /**
+   * @brief Comprimento de arco do ponto da curva mais próximo de (x,y).
+   *
+   * Parte de `dica` (amostra da consulta anterior) e desce a distância ao
+   * longo da curva, o que custa O(amostras percorridas desde o último ciclo);
+   * volta à busca completa se o veículo estiver longe do resultado.
+   * @param[in,out] dica Índice da amostra mais próxima.
+   */
+  float localizar(float x, float y, size_t &dica) const;
+
+private:
+  std::vector<AmostraPerfil> amostras_;
+  std::vector<Point> poligonal_; // Rascunho de construir()
+
+  void amostrarReta(float x0, float y0, float x1, float y1, float v_max);
+  void amostrarCanto(float x0, float y0, float cx, float cy, float x1,
+                     float y1, float v_max);
+  void adicionar(float x, float y, float v_max);
+  size_t trechoEm(float s, size_t &dica) const;
+};
+
+#endif // PERFIL_VELOCIDADE_H
@@ -0,0 +1,175 @@
+/**
+ * @file planejador_hierarquico.h
+ * @brief Planejamento hierárquico (HPA*) sobre a GradeNavegacao.
+ */
+
+#ifndef PLANEJADOR_HIERARQUICO_H
+#define PLANEJADOR_HIERARQUICO_H
+
+#include "planejador_rota.h"
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+const int TAMANHO_CLUSTER_PADRAO = 32; ///< Lado do cluster em células.
+
+/**
+ * @class BuscaLocal
+ * @brief A* 8-conexo (sem cortar quinas) restrito a um retângulo do grid.
+ *
+ * Usado para os custos intra-cluster e para o refinamento dos trechos. Os
+ * buffers são do tamanho do maior retângulo já pedido e reaproveitados.
+ */
+class BuscaLocal {
+public:
+  explicit BuscaLocal(const GradeNavegacao &grade);
+
+  /**
+   * @brief Custos de `origem` até todas as células do retângulo (Dijkstra).
+   * @param[out] custos Um valor por alvo; negativo se inalcançável.
+   */
+  void custos(const Celula &origem, int x0, int y0, int x1, int y1,
+              const std::vector<Celula> &alvos, std::vector<float> &custos);
+
+  /**
+   * @brief Caminho célula a célula de `origem` a `destino` no retângulo.
+   * @return Custo do caminho, ou negativo se não houver.
+   */
+  float caminho(const Celula &origem, const Celula &destino, int x0, int y0,
+                int x1, int y1, std::vector<Celula> &saida);
+
+private:
+  const GradeNavegacao &grade;
+  int rx0, ry0, rw, rh;
+  std::vector<float> g;
+  std::vector<int> pai;
+  std::vector<uint32_t> marca; ///< Geração em que a célula foi tocada.
+  uint32_t geracao;
+  struct Entrada {
+    float f;
+    int idx;
+    bool operator<(const Entrada &o) const { return f > o.f; }
+  };
+  std::vector<Entrada> aberta;
+
+  float buscar(const Celula &origem, const Celula *destino);
+  void preparar(int x0, int y0, int x1, int y1);
+};
+
+/**
+ * @struct CaminhoAbstrato
+ * @brief Resultado de uma consulta HPA*, ainda não refinado.
+ *
+ * Guarda a sequência de nós abstratos (entradas de cluster) do início ao
+ * objetivo; `proximo` aponta o primeiro trecho ainda não refinado.
+ */
+struct CaminhoAbstrato {
+  std::vector<Celula> pontos; ///< Células dos nós abstratos, em ordem.
+  std::vector<int> nos;       ///< Id do nó abstrato (-1 = início/objetivo).
+  size_t proximo = 0;         ///< Índice do próximo trecho a refinar.
+
+  bool pendente() const { return proximo + 1 < pontos.size(); }
+  void limpar() {
+    pontos.clear();
+    nos.clear();
+    proximo = 0;
+  }
+};
+
+/**
+ * @class PlanejadorHPA
+ * @brief Hierarchical Path-Finding A* (Botea et al., 2004).
+ *
+ * O grid é dividido em clusters quadrados. Cada trecho livre da fronteira
+ * entre dois clusters vira uma entrada (um nó de cada lado, ou dois pares se
+ * o trecho for longo); os custos entre entradas do mesmo cluster são
+ * calculados uma vez por mapa. Uma consulta só busca no grafo abstrato mais os
+ * clusters de início e objetivo, e o caminho é refinado sob demanda, trecho a
+ * trecho, com os trechos intra-cluster guardados em cache.
+ */
+class PlanejadorHPA {
+public:
+  explicit PlanejadorHPA(const GradeNavegacao &grade);
+
+  /**
+   * @brief Reconstrói o grafo abstrato para o mapa atual da grade.
+   *
+   * Em mapas grandes leva segundos; PlanejadorRota chama em outra thread.
+   * @param cancelar Se apontado e ficar true, a construção para no próximo
+   * cluster e o grafo fica incompleto (para ser descartado).
+   */
+  void construir(int tamanho_cluster = TAMANHO_CLUSTER_PADRAO,
+                 const std::atomic<bool> *cancelar = nullptr);
+
+  bool construido() const { return !nos_cluster.empty(); }
+  size_t numNos() const { return nos.size(); }
+  size_t numArestas() const { return num_arestas; }
+  size_t trechosEmCache() const { return cache.size(); }
+
+  /**
+   * @brief Busca no grafo abstrato entre duas células livres.
+   * @param[out] caminho Sequência de nós abstratos a refinar.
+   * @return false se não houver caminho.
+   */
+  bool planejar(const Celula &inicio, const Celula &objetivo,
+                CaminhoAbstrato &caminho);
+
+  /**
+   * @brief Refina até `trechos` trechos pendentes, anexando as células.
+   *
+   * A primeira célula de cada trecho (já presente em `saida` ou sendo o
+   * início) não é repetida.
+   * @return false se um trecho não puder ser refinado (mapa mudou).
+   */
+  bool refinar(CaminhoAbstrato &caminho, size_t trechos,
+               std::vector<Celula> &saida);
+
+private:
+  struct Aresta {
+    int destino;
+    float custo;
+  };
+  struct NoAbstrato {
+    Celula c;
+    int cluster;
+  };
+  struct EntradaAberta {
+    float f;
+    int no;
+    bool operator<(const EntradaAberta &o) const { return f > o.f; }
+  };
+
+  const GradeNavegacao &grade;
+  int lado;
+  int clusters_x, clusters_y;
+  std::vector<NoAbstrato> nos;
+  std::vector<std::vector<Aresta>> adjacencia;
+  std::vector<std::vector<int>> nos_cluster;
+  std::unordered_map<int, int> no_da_celula;
+  size_t num_arestas;
+  BuscaLocal local;
+
+  // Cache de trechos intra-cluster refinados, chave (a, b)
+  std::unordered_map<uint64_t, std::vector<Celula>> cache;
+
+  // Buffers do A* abstrato (reaproveitados entre consultas)
+  std::vector<float> g;
+  std::vector<int> pai;
+  std::vector<uint32_t> marca;
+  uint32_t geracao;
+  std::vector<EntradaAberta> aberta;
+
+  int cluster(int x, int y) const {
+    return (y / lado) * clusters_x + (x / lado);
+  }
+  void limitesCluster(int c, int &x0, int &y0, int &x1, int &y1) const;
+  int obterNo(const Celula &c);
+  void adicionarAresta(int a, int b, float custo);
+  void criarEntradas(int ca, int cb, bool horizontal);
+  void ligarIntraCluster(int c);
+  int inserirTemporario(const Celula &c);
+  void removerTemporarios(size_t n_original);
+};
+
+#endif // PLANEJADOR_HIERARQUICO_H
@@ -0,0 +1,315 @@
+/**
+ * @file planejador_rota.h
+ * @brief Planejamento de caminho embarcado sobre o grid de ocupação (JPS).
+ */
+
+#ifndef PLANEJADOR_ROTA_H
+#define PLANEJADOR_ROTA_H
+
+#include "dados.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+const float TAMANHO_CELULA_PADRAO = 10.0f; ///< Lado da célula do mapa (m).
+const float RAIO_VEICULO_PADRAO =
+    2.9f; ///< Meia diagonal do caminhão 4.8 x 3.2 m.
+const int AREA_MINIMA_HIERARQUICO =
+    256 * 256; ///< Células a partir das quais missões usam HPA*.
+
+/**
+ * @struct Celula
+ * @brief Coordenada inteira no grid.
+ */
+struct Celula {
+  int x, y;
+};
+
+/**
+ * @class GradeNavegacao
+ * @brief Grid de ocupação inflado pelo tamanho do veículo.
+ *
+ * As paredes são dilatadas de modo que qualquer célula marcada como livre
+ * comporte o caminhão com o centro no centro da célula. Além do vetor de
+ * bytes, mantém bitsets por linha e por coluna (células livres e vizinhos
+ * forçados) para que o JPS varra 64 células por instrução.
+ */
+class GradeNavegacao {
+public:
+  GradeNavegacao();
+
+  /**
+   * @param mapa Grid de caracteres ('1' = parede).
+   * @param tamanho_celula Lado de cada célula em metros.
+   * @param raio_veiculo Raio do círculo que envolve o veículo (m).
+   */
+  GradeNavegacao(const std::vector<std::vector<char>> &mapa,
+                 float tamanho_celula = TAMANHO_CELULA_PADRAO,
+                 float raio_veiculo = RAIO_VEICULO_PADRAO);
+
+  int largura() const { return w; }
+  int altura() const { return h; }
+  float tamanhoCelula() const { return tamanho_celula; }
+  bool vazia() const { return w == 0 || h == 0; }
+
+  /**
+   * @brief Célula transitável (dentro do mapa e fora da zona inflada).
+   */
+  bool livre(int x, int y) const {
+    return x >= 0 && y >= 0 && x < w && y < h && livre_[(size_t)y * w + x];
+  }
+
+  Celula paraCelula(float x, float y) const;
+  Point paraMundo(const Celula &c, float velocidade) const;
+
+  /**
+   * @brief Verifica se o segmento entre os centros de a e b é transitável.
+   *
+   * Percorre todas as células tocadas pelo segmento (supercover), incluindo
+   * as duas laterais quando o segmento passa exatamente por um vértice.
+   */
+  bool linhaLivre(const Celula &a, const Celula &b) const;
+
+  /**
+   * @brief Procura a célula livre mais próxima (busca em anel até raio_max).
+   * @return false se não houver célula livre no raio.
+   */
+  bool celulaLivreProxima(Celula &c, int raio_max) const;
+
+  /**
+   * @brief Marca uma célula livre como ocupada (bloqueio visto pelo sensor).
+   *
+   * Atualiza os bitsets e os vizinhos forçados das linhas e colunas
+   * adjacentes, de modo que JPS e linha de visada passam a evitá-la.
+   */
+  void bloquear(const Celula &c);
+
+  // Bitsets (bit i da palavra k = célula 64k+i livre); usados pelo JPS
+  int palavrasLinha() const { return palavras_linha; }
+  int palavrasColuna() const { return palavras_coluna; }
+  const uint64_t *linha(int y) const;
+  const uint64_t *coluna(int x) const;
+  // Vizinhos forçados pré-calculados para varrer no sentido dir (+1/-1)
+  const uint64_t *forcadosLinha(int y, int dir) const;
+  const uint64_t *forcadosColuna(int x, int dir) const;
+
+private:
+  int w, h;
+  float tamanho_celula;
+  int palavras_linha, palavras_coluna;
+  std::vector<unsigned char> livre_;
+  std::vector<uint64_t> bits_linhas;
+  std::vector<uint64_t> bits_colunas;
+  std::vector<uint64_t> forc_linhas[2];
+  std::vector<uint64_t> forc_colunas[2];
+};
+
+/**
+ * @class PlanejadorJPS
+ * @brief A* com Jump Point Search (8-conexo, sem cortar quinas).
+ *
+ * Os saltos retos são feitos em blocos de 64 células sobre os bitsets da
+ * GradeNavegacao; apenas pontos de salto entram na lista aberta. Buffers são
+ * reaproveitados entre consultas.
+ *
+ * Os nós tocados ficam num vetor compacto e cada célula guarda a posição do
+ * seu nó (4 bytes por célula). A posição só vale se o nó apontado é o da
+ * própria célula: a consulta seguinte invalida todas esvaziando o vetor, sem
+ * limpar o arranjo por célula nem calcular hash.
+ */
+class PlanejadorJPS {
+public:
+  explicit PlanejadorJPS(const GradeNavegacao &grade);
+
+  /**
+   * @brief Planeja entre duas células livres.
+   * @param[out] caminho Pontos de salto do início ao objetivo (inclusivos).
+   * @return false se não houver caminho.
+   */
+  bool planejar(const Celula &inicio, const Celula &objetivo,
+                std::vector<Celula> &caminho);
+
+  /**
+   * @brief Nós expandidos na última consulta (diagnóstico).
+   */
+  size_t nosExpandidos() const { return expandidos; }
+
+private:
+  struct InfoNo {
+    int idx; ///< Célula do nó (confere a posição guardada nela).
+    float g;
+    int pai;
+    bool fechado;
+  };
+  struct EntradaAberta {
+    float f;
+    float g;
+    int idx;
+    // Heap de mínimo em f; no empate, prefere o nó mais profundo (maior g)
+    bool operator<(const EntradaAberta &o) const {
+      return f > o.f || (f == o.f && g < o.g);
+    }
+  };
+
+  const GradeNavegacao &grade;
+  std::vector<uint32_t> posicao; ///< Por célula: índice do nó em `nos`.
+  std::vector<InfoNo> nos;       ///< Nós da consulta atual.
+  std::vector<EntradaAberta> aberta;
+  size_t expandidos;
+  Celula alvo;
+
+  int indice(int x, int y) const { return y * grade.largura() + x; }
+  InfoNo *no(int idx) {
+    uint32_t k = posicao[idx];
+    return k < nos.size() && nos[k].idx == idx ? &nos[k] : nullptr;
+  }
+  void criarNo(int idx, float g, int pai) {
+    posicao[idx] = (uint32_t)nos.size();
+    nos.push_back(InfoNo{idx, g, pai, false});
+  }
+  int saltar(int x, int y, int dx, int dy) const;
+  int saltarReto(int x, int y, int dx, int dy) const;
+  int vizinhosPodados(int x, int y, int pai, int dirs[8][2]) const;
+};
+
+class PlanejadorHPA;
+struct ConstrucaoHPA;
+class CacheCamposFluxo;
+class CacheCaminhos;
+class ReplanejadorDStarLite;
+struct MissaoPendente;
+
+/**
+ * @class PlanejadorRota
+ * @brief Fachada usada pela tarefa de planejamento.
+ *
+ * Converte posições do mundo (metros) para o grid, planeja com JPS, reduz os
+ * pontos de salto por linha de visada e preenche a fila de waypoints. Caminhos
+ * JPS repetidos saem de um cache LRU. Em mapas
+ * grandes, missões são planejadas com HPA* e refinadas aos poucos; destinos
+ * frequentes ganham um campo de fluxo compartilhado. Bloqueios vistos pelo
+ * LiDAR são contornados com D* Lite incremental.
+ */
+class PlanejadorRota {
+public:
+  PlanejadorRota();
+  ~PlanejadorRota();
+
+  /**
+   * @brief (Re)constrói o grid inflado a partir do mapa recebido.
+   */
+  void setMapa(const std::vector<std::vector<char>> &mapa,
+               float tamanho_celula = TAMANHO_CELULA_PADRAO,
+               float raio_veiculo = RAIO_VEICULO_PADRAO);
+  bool temMapa() const { return !grade.vazia(); }
+  const GradeNavegacao &getGrade() const { return grade; }
+  CacheCamposFluxo &getCamposFluxo() { return *campos; }
+  const CacheCaminhos &getCacheCaminhos() const { return *cache_caminhos; }
+
+  /**
+   * @brief Planeja de (x0,y0) até (x1,y1) e anexa os waypoints à rota.
+   * @return false se não houver mapa ou caminho.
+   */
+  bool planejar(float x0, float y0, float x1, float y1, float velocidade,
+                Rota &rota);
+
+  /**
+   * @brief Verifica se a reta entre dois pontos do mundo é transitável.
+   */
+  bool segmentoTransitavel(float x0, float y0, float x1, float y1) const;
+
+  /**
+   * @brief Substitui cada trecho não transitável da rota por um caminho JPS.
+   * @param x0,y0 Posição atual do veículo (origem do primeiro trecho).
+   * @return false se algum trecho não tiver caminho ou a rota corrigida não
+   * couber no anel (a rota fica como estava).
+   */
+  bool validarRota(float x0, float y0, Rota &rota);
+
+  /**
+   * @brief Planeja uma missão até (x1,y1).
+   *
+   * Se o destino tem campo de fluxo pronto, apenas segue o gradiente.
+   * Senão, em mapas pequenos equivale a planejar(); em mapas grandes busca só
+   * no grafo abstrato e anexa os primeiros trechos, deixando o restante
+   * pendente para refinarPendente().
+   */
+  bool planejarMissao(float x0, float y0, float x1, float y1,
+                      float velocidade, Rota &rota);
+
+  /**
+   * @brief Refina os próximos trechos da missão pendente, se houver.
+   *
+   * Pendente é o caminho abstrato ainda não refinado e o trecho de qualquer
+   * caminho que não coube no anel da rota; este entra primeiro.
+   * @return false se o refinamento falhar (a missão pendente é descartada).
+   */
+  bool refinarPendente(Rota &rota);
+
+  bool temPendente() const;
+  void descartarPendente();
+
+  /**
+   * @brief Recolhe o grafo HPA* se a construção em segundo plano terminou.
+   *
+   * Em mapas grandes setMapa só dispara a construção (segundos a 4096²) numa
+   * thread própria; até ela terminar, planejarMissao usa JPS direto.
+   * @return true se o grafo acabou de ficar disponível.
+   */
+  bool receberHierarquia();
+  bool hierarquiaPronta() const { return hpa != nullptr; }
+
+  /**
+   * @brief Registra um bloqueio visto pelo sensor no ponto (x,y) do mundo.
+   *
+   * A célula passa a ser ocupada para todas as buscas seguintes. Um bloqueio
+   * reavisado não é marcado de novo, mas faz desviarBloqueios() conferir a
+   * rota outra vez (trechos anexados depois podem cruzá-lo).
+   * @return false se a célula já era parede no mapa ou já estava marcada.
+   */
+  bool marcarBloqueio(float x, float y);
+
+  /**
+   * @brief Desvia a rota dos bloqueios marcados ou reavisados desde a
+   * última chamada, se ela cruzar algum.
+   *
+   * Substitui os waypoints até o destino da busca pelo caminho do D* Lite. A
+   * busca é mantida enquanto o destino for o mesmo, de modo que bloqueios
+   * novos só reabrem a região afetada; se o orçamento acabar, a reparação
+   * continua na chamada seguinte.
+   * @return false se o destino ficou inalcançável.
+   */
+  bool desviarBloqueios(float x0, float y0, Rota &rota,
+                        int orcamento_us);
+
+private:
+  GradeNavegacao grade;
+  PlanejadorJPS jps;
+  std::shared_ptr<const GradeNavegacao> grade_hpa; ///< Cópia usada pelo hpa.
+  std::unique_ptr<PlanejadorHPA> hpa; ///< Nulo em mapas pequenos.
+  std::shared_ptr<ConstrucaoHPA> construcao_hpa; ///< Em segundo plano.
+  std::unique_ptr<MissaoPendente> pendente;
+  std::unique_ptr<CacheCamposFluxo> campos;
+  std::unique_ptr<ReplanejadorDStarLite> dstar;
+  std::unique_ptr<CacheCaminhos> cache_caminhos;
+  uint32_t versao_mapa; ///< Muda a cada mapa novo ou bloqueio do sensor.
+  bool desvio_pendente; ///< Há bloqueio marcado ainda não contornado.
+  bool grade_campos_antiga; ///< Bloqueios fora da cópia dos campos de fluxo.
+  std::vector<Celula> caminho; ///< Buffer reaproveitado entre consultas.
+  Rota auxiliar; ///< Rota corrigida e desvio, sem alocar por consulta.
+
+  bool seguirCampo(const Celula &inicio, const Celula &objetivo,
+                   float velocidade, const Point &destino, Rota &rota);
+  size_t trechoBloqueado(float x0, float y0, const Rota &rota,
+                         size_t desde) const;
+  /// @return Índice da última célula anexada (a anterior ao anel encher).
+  size_t anexarReduzido(const std::vector<Celula> &celulas, float velocidade,
+                        Rota &rota) const;
+  /// Anexa o caminho reduzido terminando em `destino` (se `final`); o que
+  /// não couber no anel fica pendente para refinarPendente().
+  void anexarCaminho(const std::vector<Celula> &celulas, float velocidade,
+                     const Point &destino, bool final, Rota &rota);
+};
+
+#endif // PLANEJADOR_ROTA_H
@@ -0,0 +1,120 @@
+/**
+ * @file replanejador_dstar.h
+ * @brief Replanejamento incremental (D* Lite) para bloqueios vistos pelo LiDAR.
+ */
+
+#ifndef REPLANEJADOR_DSTAR_H
+#define REPLANEJADOR_DSTAR_H
+
+#include "planejador_rota.h"
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class ReplanejadorDStarLite
+ * @brief D* Lite (Koenig & Likhachev, 2002) sobre a GradeNavegacao.
+ *
+ * A busca é feita do objetivo para o veículo e mantida entre ciclos: quando o
+ * LiDAR acusa uma célula bloqueada que o mapa dava como livre, só os vértices
+ * cujo custo muda são reabertos. A reparação tem orçamento de tempo e pode
+ * continuar no ciclo seguinte se não convergir.
+ */
+class ReplanejadorDStarLite {
+public:
+  explicit ReplanejadorDStarLite(const GradeNavegacao &grade);
+
+  /**
+   * @brief Inicia uma nova busca (descarta o estado incremental).
+   */
+  void iniciar(const Celula &inicio, const Celula &objetivo);
+
+  bool ativo() const { return ativo_; }
+  const Celula &objetivo() const { return objetivo_; }
+
+  /**
+   * @brief Atualiza a posição do veículo (ajusta km sem reabrir a busca).
+   */
+  void moverPara(const Celula &atual);
+
+  /**
+   * @brief Marca uma célula como bloqueada pelo sensor.
+   * @return false se a célula já era parede ou já estava marcada.
+   */
+  bool marcarBloqueada(const Celula &c);
+
+  bool bloqueadaSensor(const Celula &c) const;
+  size_t bloqueiosSensor() const { return bloqueios.size(); }
+
+  /**
+   * @brief Linha de visada que respeita também os bloqueios do sensor.
+   */
+  bool linhaLivre(const Celula &a, const Celula &b) const;
+
+  /**
+   * @brief Segmento entre os centros de a e b toca algum bloqueio do sensor.
+   */
+  bool cruzaBloqueio(const Celula &a, const Celula &b) const;
+
+  /**
+   * @brief Executa/continua a busca com orçamento de tempo.
+   * @return true se convergiu (o caminho atual é ótimo).
+   */
+  bool reparar(int orcamento_us);
+
+  /**
+   * @brief Extrai o caminho da posição atual até o objetivo.
+   * @return false se não houver caminho (ou a busca não convergiu).
+   */
+  bool caminho(std::vector<Celula> &saida) const;
+
+  /**
+   * @brief Vértices expandidos desde o último iniciar() (diagnóstico).
+   */
+  size_t expandidos() const { return expandidos_; }
+
+  void limpar();
+
+private:
+  // Custos inteiros (décimos de célula) para que empates de chave sejam exatos
+  struct Chave {
+    int k1, k2;
+    bool operator<(const Chave &o) const {
+      return k1 < o.k1 || (k1 == o.k1 && k2 < o.k2);
+    }
+  };
+  struct No {
+    int g, rhs;
+    Chave chave;
+    bool na_fila;
+  };
+  struct EntradaFila {
+    Chave chave;
+    int idx;
+    bool operator<(const EntradaFila &o) const { return o.chave < chave; }
+  };
+
+  const GradeNavegacao &grade;
+  bool ativo_;
+  Celula inicio_, objetivo_, ultimo_;
+  int km;
+  size_t expandidos_;
+  std::unordered_map<int, No> nos;
+  std::vector<EntradaFila> fila;
+  std::unordered_set<int> bloqueios;
+
+  int indice(const Celula &c) const { return c.y * grade.largura() + c.x; }
+  Celula celula(int idx) const {
+    return Celula{idx % grade.largura(), idx / grade.largura()};
+  }
+  bool livre(int x, int y) const;
+  No &no(int idx);
+  int g(int idx) const;
+  int rhs(int idx) const;
+  Chave calcularChave(int idx) const;
+  void atualizarVertice(int idx);
+  int vizinhos(int idx, int saida[8], int custos[8]) const;
+};
+
+#endif // REPLANEJADOR_DSTAR_H
@@ -0,0 +1,220 @@
+/**
+ * @file reserva_espaco_tempo.h
+ * @brief Reservas espaço-tempo e planejamento sem conflito para a frota.
+ */
+
+#ifndef RESERVA_ESPACO_TEMPO_H
+#define RESERVA_ESPACO_TEMPO_H
+
+#include "planejador_rota.h"
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+const int HORIZONTE_RESERVA_PADRAO = 64; ///< Slots planejados à frente.
+const size_t MAX_AGENTES_CBS = 6; ///< Grupos até este tamanho tentam CBS.
+const size_t MAX_NOS_CBS = 256;   ///< Nós do CBS antes de cair no prioritário.
+
+/**
+ * @struct PedidoCaminho
+ * @brief Um caminhão a planejar: id, célula atual e célula de destino.
+ */
+struct PedidoCaminho {
+  int id;
+  Celula inicio;
+  Celula objetivo;
+};
+
+/**
+ * @struct CaminhoTemporal
+ * @brief Caminho com uma célula por slot de tempo.
+ *
+ * Cada passo (reto, diagonal ou espera) ocupa um slot. Depois da última
+ * célula o caminhão fica parado nela.
+ */
+struct CaminhoTemporal {
+  int id;
+  int t0;                      ///< Slot da primeira célula.
+  std::vector<Celula> celulas; ///< celulas[k] = posição no slot t0 + k.
+  bool completo; ///< Chega ao objetivo dentro do horizonte.
+  int custo;     ///< Slots até o objetivo (estimado se incompleto).
+
+  const Celula &em(int t) const;
+};
+
+/**
+ * @struct Restricao
+ * @brief Proibição imposta pelo CBS a um agente.
+ *
+ * Com destino < 0, proíbe estar em `celula` no slot t; senão, proíbe mover
+ * de `celula` para `destino` entre os slots t e t+1.
+ */
+struct Restricao {
+  int agente;
+  int celula;
+  int destino;
+  int t;
+};
+
+/**
+ * @class TabelaReservas
+ * @brief Ocupação (célula, slot) -> caminhão, compartilhada pela frota.
+ *
+ * Além do vértice, um movimento conflita com a troca de posição de dois
+ * caminhões no mesmo túnel (frente a frente) e com o cruzamento de duas
+ * diagonais no mesmo slot.
+ */
+class TabelaReservas {
+public:
+  explicit TabelaReservas(const GradeNavegacao &grade);
+
+  /**
+   * @brief Reserva o caminho; se completo, mantém o destino até o slot `ate`.
+   */
+  void reservar(const CaminhoTemporal &caminho, int ate);
+  void liberar(int id);
+  void limpar();
+
+  /**
+   * @return Id do caminhão que ocupa (c, t), ou -1 se livre.
+   */
+  int dono(const Celula &c, int t) const;
+
+  bool podeOcupar(int id, const Celula &c, int t) const {
+    int d = dono(c, t);
+    return d < 0 || d == id;
+  }
+
+  /**
+   * @brief O caminhão `id` pode ir de `de` (slot t) para `para` (slot t+1)?
+   */
+  bool podeMover(int id, const Celula &de, const Celula &para, int t) const;
+
+  size_t tamanho() const { return ocupacao.size(); }
+
+private:
+  const GradeNavegacao &grade;
+  std::unordered_map<uint64_t, int> ocupacao;
+  std::unordered_map<int, std::vector<uint64_t>> por_agente;
+
+  uint64_t chave(const Celula &c, int t) const {
+    return ((uint64_t)(uint32_t)t << 32) |
+           (uint32_t)(c.y * grade.largura() + c.x);
+  }
+  bool ocupar(int id, const Celula &c, int t);
+};
+
+/**
+ * @class BuscaEspacoTempo
+ * @brief A* no grid expandido no tempo, limitado a uma janela de slots.
+ *
+ * Como todo passo custa um slot, g é o próprio tempo e cada estado é
+ * visitado uma vez; os buffers cobrem a caixa alcançável na janela e são
+ * reaproveitados (marcas por geração). Se o objetivo não cabe na janela, o
+ * resultado é o melhor prefixo até o fim dela (janela deslizante).
+ */
+class BuscaEspacoTempo {
+public:
+  BuscaEspacoTempo(const GradeNavegacao &grade, int horizonte);
+
+  /**
+   * @param restricoes Restrições do CBS (só as do agente são consideradas).
+   * @return false se o caminhão não tiver nem como esperar onde está.
+   */
+  bool planejar(const PedidoCaminho &pedido, int t0,
+                const TabelaReservas &tabela,
+                const std::vector<Restricao> &restricoes,
+                CaminhoTemporal &saida);
+
+  int horizonte() const { return horizonte_; }
+  size_t expandidos() const { return expandidos_; }
+
+private:
+  struct EntradaAberta {
+    int f;
+    int h;
+    int no;
+    // Heap de mínimo em f; no empate, prefere o mais perto do objetivo
+    bool operator<(const EntradaAberta &o) const {
+      return f > o.f || (f == o.f && h > o.h);
+    }
+  };
+
+  const GradeNavegacao &grade;
+  int horizonte_;
+  int lado; ///< Lado da caixa alcançável (2 * horizonte + 1).
+  std::vector<int> pai;
+  std::vector<uint32_t> marca;
+  uint32_t geracao;
+  std::vector<EntradaAberta> aberta;
+  std::vector<const Restricao *> minhas;
+  size_t expandidos_;
+
+  bool violaVertice(int celula, int t) const;
+  bool violaAresta(int de, int para, int t) const;
+};
+
+/**
+ * @class PlanejadorMultiCaminhao
+ * @brief Planejamento sem conflitos para grupos de caminhões.
+ *
+ * Grupos pequenos (até MAX_AGENTES_CBS) são resolvidos com Conflict-Based
+ * Search (Sharon et al., 2015) contra as reservas do resto da frota; grupos
+ * maiores, ou um CBS que não converge em MAX_NOS_CBS nós, são planejados em
+ * ordem de prioridade, cada caminho reservando a tabela para os seguintes.
+ */
+class PlanejadorMultiCaminhao {
+public:
+  PlanejadorMultiCaminhao(const GradeNavegacao &grade,
+                          int horizonte = HORIZONTE_RESERVA_PADRAO);
+
+  TabelaReservas &getTabela() { return tabela; }
+  int horizonte() const { return busca.horizonte(); }
+
+  /**
+   * @brief Planeja e reserva os caminhos do grupo a partir do slot t0.
+   *
+   * Os pedidos vêm em ordem de prioridade. Reservas anteriores dos mesmos ids
+   * são liberadas; as dos demais caminhões são respeitadas.
+   * @return false se algum caminhão ficou sem caminho (os outros são
+   * reservados mesmo assim).
+   */
+  bool planejar(const std::vector<PedidoCaminho> &pedidos, int t0,
+                std::vector<CaminhoTemporal> &saida);
+
+  size_t nosCBS() const { return nos_cbs; } ///< Nós do último CBS.
+
+private:
+  struct Conflito {
+    int a, b;      ///< Índices no grupo.
+    int t;         ///< Slot de partida do movimento em conflito.
+    bool vertice;  ///< Senão, troca ou cruzamento de diagonais.
+  };
+
+  const GradeNavegacao &grade;
+  TabelaReservas tabela;
+  BuscaEspacoTempo busca;
+  size_t nos_cbs;
+
+  bool planejarCBS(const std::vector<PedidoCaminho> &pedidos, int t0,
+                   std::vector<CaminhoTemporal> &saida);
+  bool planejarPrioritario(const std::vector<PedidoCaminho> &pedidos, int t0,
+                           std::vector<CaminhoTemporal> &saida);
+  bool primeiroConflito(const std::vector<CaminhoTemporal> &caminhos, int t0,
+                        Conflito &c) const;
+  int indice(const Celula &c) const { return c.y * grade.largura() + c.x; }
+};
+
+/**
+ * @brief Converte um caminho temporal em waypoints para o caminhão.
+ *
+ * Esperas viram redução de velocidade no trecho seguinte, para que o
+ * caminhão chegue a cada célula no slot reservado.
+ * @param duracao_slot Duração de um slot em segundos.
+ */
+void caminhoParaRota(const CaminhoTemporal &caminho,
+                     const GradeNavegacao &grade, float duracao_slot,
+                     std::deque<Point> &rota);
+
+#endif // RESERVA_ESPACO_TEMPO_H
@@ -7,7 +7,9 @@
 #define SIMULACAO_MINA_H
 
 #include "dados.h"
+#include "interfaces/i_mapa_ocupacao.h"
 #include <cmath>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <vector>
@@ -25,6 +27,8 @@ private:
   std::vector<CaminhaoFisico> frota; ///< Lista de caminhões na simulação.
   const std::vector<std::vector<char>>
       &mapa; ///< Referência ao grid do mapa (read-only).
+  std::unique_ptr<IMapaOcupacao>
+      ocupacao; ///< Backend de consulta (grid ou quadtree, escolhido pelo mapa).
   mutable std::mutex
       mtx_simulacao; ///< Mutex para proteger o estado da simulação.
   float dt;          ///< Passo de tempo da simulação (delta time).
@@ -67,6 +71,17 @@ public:
    */
   CaminhaoFisico getEstadoReal(int id_caminhao);
 
+  /**
+   * @brief Coloca um caminhão parado em uma pose (cenários de teste e
+   * sintonia).
+   */
+  void posicionarCaminhao(int id_caminhao, float x, float y, float angulo);
+
+  /**
+   * @brief Backend de ocupação em uso (para diagnóstico).
+   */
+  const IMapaOcupacao &getMapaOcupacao() const { return *ocupacao; }
+
 private:
   /**
    * @brief Aplica o modelo cinemático de bicicleta para atualizar posição e
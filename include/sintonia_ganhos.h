@@ -0,0 +1,80 @@
+/**
+ * @file sintonia_ganhos.h
+ * @brief Avaliação de ganhos de controle em malha fechada com SimulacaoMina.
+ *
+ * Cada cenário é uma rota planejada num mapa gerado. A avaliação roda a mesma
+ * cadeia da aplicação (sensor com ruído, EMA e quantização; referencia_perfil
+ * e calcular_controle_lote; modelo de bicicleta) sem threads nem relógio, tão
+ * rápido quanto a CPU permite. Avaliações independentes não compartilham
+ * estado mutável e podem rodar em paralelo.
+ */
+
+#ifndef SINTONIA_GANHOS_H
+#define SINTONIA_GANHOS_H
+
+#include "controle_lote.h"
+#include "dados.h"
+#include <memory>
+#include <vector>
+
+class PerfilVelocidade;
+
+const float DT_SINTONIA = 0.1f;           ///< Passo de simulação e controle (s).
+const float DISTANCIA_DISPARO_CAS = 3.0f; ///< Distância crítica do CAS (m).
+const float RAIO_CHEGADA = 5.0f;          ///< Tolerância no destino (m).
+
+/**
+ * @struct CenarioSintonia
+ * @brief Rota de teste: mapa, pose inicial e perfil de velocidade.
+ */
+struct CenarioSintonia {
+  std::shared_ptr<const std::vector<std::vector<char>>> mapa;
+  float x0, y0, angulo0; ///< Pose inicial (m, graus).
+  float x1, y1;          ///< Destino (m).
+  std::shared_ptr<const PerfilVelocidade> perfil;
+  float tempo_nominal; ///< Tempo de percurso previsto pelo perfil (s).
+  unsigned semente;    ///< Semente do ruído dos sensores.
+};
+
+/**
+ * @struct MetricasGanhos
+ * @brief Desempenho de um conjunto de ganhos, somado sobre os cenários.
+ */
+struct MetricasGanhos {
+  float erro_medio;     ///< Distância média à curva planejada (m).
+  float tempo_relativo; ///< Tempo até o destino / tempo nominal (média).
+  int disparos_cas;     ///< Aproximações abaixo de DISTANCIA_DISPARO_CAS.
+  int colisoes;         ///< Colisões com a parede no simulador.
+  int nao_chegou;       ///< Cenários encerrados por tempo esgotado.
+  int cenarios;
+
+  MetricasGanhos()
+      : erro_medio(0.0f), tempo_relativo(0.0f), disparos_cas(0), colisoes(0),
+        nao_chegou(0), cenarios(0) {}
+
+  /// Disparos do CAS, colisões e rotas não concluídas.
+  int incidentes() const { return disparos_cas + colisoes + nao_chegou; }
+};
+
+/**
+ * @brief Monta um cenário a partir de uma rota já planejada.
+ * @return false se o perfil ficar vazio.
+ */
+bool montar_cenario(std::shared_ptr<const std::vector<std::vector<char>>> mapa,
+                    float x0, float y0, float x1, float y1,
+                    const Rota &rota, unsigned semente,
+                    CenarioSintonia &cenario);
+
+/**
+ * @brief Percorre um cenário com os ganhos dados.
+ */
+MetricasGanhos avaliar_ganhos(const CenarioSintonia &cenario,
+                              const GanhosControle &ganhos);
+
+/**
+ * @brief Percorre todos os cenários; erro e tempo são médias por cenário.
+ */
+MetricasGanhos avaliar_ganhos(const std::vector<CenarioSintonia> &cenarios,
+                              const GanhosControle &ganhos);
+
+#endif // SINTONIA_GANHOS_H
@@ -4,6 +4,7 @@
 #include "eventos_sistema.h"
 #include "gerenciador_dados.h"
 #include "interfaces/i_veiculo_driver.h"
+#include <chrono>
 
 /**
  * @brief Tarefa de Segurança Crítica: Sistema de Prevenção de Colisão (CAS).
@@ -16,8 +17,10 @@
  * @param eventos Sistema de eventos para sinalizar falha.
  * @param driver Interface do driver de veículo para envio direto de comando de
  * parada (Bypass).
+ * @param periodo Período do ciclo (ConfigTarefas::cas).
  */
-void task_collision_avoidance(GerenciadorDados &dados, EventosSistema &eventos,
-                              IVeiculoDriver &driver);
+void task_collision_avoidance(
+    GerenciadorDados &dados, EventosSistema &eventos, IVeiculoDriver &driver,
+    std::chrono::steady_clock::duration periodo = std::chrono::milliseconds(50));
 
 #endif // TASK_COLLISION_AVOIDANCE_H
@@ -6,11 +6,22 @@
 #ifndef TASK_CONTROLE_NAVEGACAO_H
 #define TASK_CONTROLE_NAVEGACAO_H
 
+#include "controle_lote.h"
 #include "gerenciador_dados.h"
 #include "eventos_sistema.h"
+#include <chrono>
 
 class IVeiculoDriver;
 
+/**
+ * @enum ModoNavegacao
+ * @brief Lei de controle usada no modo automático.
+ */
+enum ModoNavegacao {
+  NAV_PURE_PURSUIT, ///< Malha IP de velocidade + pure pursuit na direção.
+  NAV_MPC           ///< Primitivas de movimento avaliadas a cada ciclo.
+};
+
 /**
  * @brief Tarefa responsável pelo controle de navegação do veículo.
  *
@@ -21,7 +32,20 @@ class IVeiculoDriver;
  *
  * @param dados Referência para o gerenciador de dados.
  * @param eventos Referência para o sistema de eventos (para parada de emergência).
+ * @param modo Lei de controle do modo automático. O MPC respeita os limites de
+ * atuação do simulador; sem perfil de rota publicado, volta ao pure pursuit.
+ * @param periodo Período nominal (ConfigTarefas::navegacao); o dt das malhas
+ * é o período medido de cada ciclo.
+ * @param encadeado Em vez do temporizador, roda um ciclo a cada amostra
+ * publicada pelo sensor (timeout de 2 períodos) e acorda a atuação ao
+ * publicar o comando; periodo deve ser então o do sensor.
+ * @param ganhos Ganhos da malha IP e do pure pursuit (ganhos.conf, gerado
+ * pela ferramenta de sintonia).
  */
-void task_controle_navegacao(GerenciadorDados& dados, EventosSistema& eventos);
+void task_controle_navegacao(GerenciadorDados& dados, EventosSistema& eventos,
+                             ModoNavegacao modo = NAV_PURE_PURSUIT,
+                             std::chrono::steady_clock::duration periodo = std::chrono::milliseconds(100),
+                             bool encadeado = false,
+                             const GanhosControle& ganhos = GanhosControle());
 
 #endif // TASK_CONTROLE_NAVEGACAO_H
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #include "gerenciador_dados.h"
 #include "eventos_sistema.h"
+#include <chrono>
 
 /**
  * @brief Tarefa responsável pela lógica de comando central e tomada de decisão.
@@ -18,7 +19,9 @@
  *
  * @param gerenciadorDados Referência para o gerenciador de dados compartilhado.
  * @param eventos Referência para o sistema de eventos e falhas.
+ * @param periodo Período do ciclo (ConfigTarefas::comando).
  */
-void task_logica_comando(GerenciadorDados& gerenciadorDados, EventosSistema& eventos);
+void task_logica_comando(GerenciadorDados& gerenciadorDados, EventosSistema& eventos,
+                         std::chrono::steady_clock::duration periodo = std::chrono::milliseconds(100));
 
 #endif // TASK_LOGICA_COMANDO_H
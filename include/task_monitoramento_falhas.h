@@ -8,6 +8,7 @@
 
 #include "gerenciador_dados.h"
 #include "eventos_sistema.h"
+#include <chrono>
 
 class ISensorDriver;
 
@@ -21,7 +22,9 @@ class ISensorDriver;
  * @param gerenciadorDados Referência para o banco de dados central.
  * @param eventos Referência para o sistema de eventos.
  * @param driver Referência para o driver de sensores (leitura direta).
+ * @param periodo Período do ciclo (ConfigTarefas::monitoramento).
  */
-void task_monitoramento_falhas(GerenciadorDados& gerenciadorDados, EventosSistema& eventos, ISensorDriver& driver);
+void task_monitoramento_falhas(GerenciadorDados& gerenciadorDados, EventosSistema& eventos, ISensorDriver& driver,
+                               std::chrono::steady_clock::duration periodo = std::chrono::milliseconds(200));
 
 #endif // TASK_MONITORAMENTO_FALHAS_H
\ No newline at end of file
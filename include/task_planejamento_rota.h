@@ -3,6 +3,7 @@
 
 #include "drivers/mqtt_driver.h"
 #include "gerenciador_dados.h"
+#include <chrono>
 
 /**
  * @brief Tarefa de Planejamento de Rota ("O General").
@@ -12,7 +13,10 @@
  *
  * @param dados Gerenciador de dados compartilhado.
  * @param mqtt Driver MQTT para receber missões futuras (Fase 2).
+ * @param periodo Período do ciclo (ConfigTarefas::planejamento).
  */
-void task_planejamento_rota(GerenciadorDados &dados, MqttDriver &mqtt);
+void task_planejamento_rota(
+    GerenciadorDados &dados, MqttDriver &mqtt,
+    std::chrono::steady_clock::duration periodo = std::chrono::milliseconds(100));
 
 #endif // TASK_PLANEJAMENTO_ROTA_H
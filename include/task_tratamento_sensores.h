@@ -8,6 +8,7 @@
 
 #include "gerenciador_dados.h"
 #include "interfaces/i_sensor_driver.h"
+#include <chrono>
 #include <vector>
 
 class SimulacaoMina;
@@ -22,8 +23,11 @@ class SimulacaoMina;
  * @param gerenciadorDados Referência para o objeto GerenciadorDados onde os dados serão escritos.
  * @param simulacao Referência para a simulação física de onde a "verdade" é lida.
  * @param id_caminhao ID do caminhão cujos sensores estão sendo lidos.
+ * @param periodo Período de amostragem (ConfigTarefas::sensores); o filtro
+ * EMA é ajustado para manter a mesma constante de tempo.
  */
-void task_tratamento_sensores(GerenciadorDados& gerenciadorDados, ISensorDriver& driver, int id_caminhao);
+void task_tratamento_sensores(GerenciadorDados& gerenciadorDados, ISensorDriver& driver, int id_caminhao,
+                              std::chrono::steady_clock::duration periodo = std::chrono::milliseconds(100));
 
 /**
  * @brief Calcula o próximo valor da Média Móvel Exponencial (EMA).
@@ -37,6 +41,11 @@ void task_tratamento_sensores(GerenciadorDados& gerenciadorDados, ISensorDriver&
  */
 float calcular_media_movel_exponencial(float valor_atual, float media_anterior);
 
+/**
+ * @brief EMA com fator de suavização explícito (0 < k <= 1).
+ */
+float calcular_media_movel_exponencial(float valor_atual, float media_anterior, float k);
+
 
 
 #endif // TASK_TRATAMENTO_SENSORES_H
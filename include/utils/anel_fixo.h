@@ -0,0 +1,107 @@
+/**
+ * @file anel_fixo.h
+ * @brief Fila circular de capacidade fixa para uma única thread.
+ *
+ * Os itens são alocados uma vez, na construção; inserir e retirar nas duas
+ * pontas só movem índices. A interface é a parte de std::deque usada pelas
+ * filas de waypoints, para que o anel a substitua sem mudar quem percorre a
+ * rota. Com o anel cheio, a inserção é recusada.
+ */
+
+#ifndef ANEL_FIXO_H
+#define ANEL_FIXO_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename T, size_t N> class AnelFixo {
+  static_assert(N >= 2 && (N & (N - 1)) == 0,
+                "capacidade do anel deve ser potência de 2");
+
+public:
+  class const_iterator {
+  public:
+    const_iterator(const AnelFixo *anel, size_t i) : anel_(anel), i_(i) {}
+    const T &operator*() const { return (*anel_)[i_]; }
+    const T *operator->() const { return &(*anel_)[i_]; }
+    const_iterator &operator++() {
+      ++i_;
+      return *this;
+    }
+    bool operator==(const const_iterator &o) const { return i_ == o.i_; }
+    bool operator!=(const const_iterator &o) const { return i_ != o.i_; }
+
+  private:
+    const AnelFixo *anel_;
+    size_t i_;
+  };
+
+  AnelFixo() : inicio_(0), tamanho_(0), itens_(N) {}
+
+  size_t size() const { return tamanho_; }
+  bool empty() const { return tamanho_ == 0; }
+  bool full() const { return tamanho_ == N; }
+  static size_t capacity() { return N; }
+
+  T &operator[](size_t i) { return itens_[(inicio_ + i) & (N - 1)]; }
+  const T &operator[](size_t i) const {
+    return itens_[(inicio_ + i) & (N - 1)];
+  }
+  T &front() { return itens_[inicio_]; }
+  const T &front() const { return itens_[inicio_]; }
+  T &back() { return (*this)[tamanho_ - 1]; }
+  const T &back() const { return (*this)[tamanho_ - 1]; }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, tamanho_); }
+
+  /// @return false se cheio (item não inserido).
+  bool push_back(const T &item) {
+    if (full())
+      return false;
+    itens_[(inicio_ + tamanho_) & (N - 1)] = item;
+    ++tamanho_;
+    return true;
+  }
+
+  /// @return false se cheio (item não inserido).
+  bool push_front(const T &item) {
+    if (full())
+      return false;
+    inicio_ = (inicio_ - 1) & (N - 1);
+    itens_[inicio_] = item;
+    ++tamanho_;
+    return true;
+  }
+
+  void pop_front() {
+    inicio_ = (inicio_ + 1) & (N - 1);
+    --tamanho_;
+  }
+
+  /// Remove os n primeiros itens (n <= size()).
+  void pop_front(size_t n) {
+    inicio_ = (inicio_ + n) & (N - 1);
+    tamanho_ -= n;
+  }
+
+  void clear() {
+    inicio_ = 0;
+    tamanho_ = 0;
+  }
+
+  /// Troca o conteúdo sem copiar itens.
+  void swap(AnelFixo &o) {
+    std::swap(inicio_, o.inicio_);
+    std::swap(tamanho_, o.tamanho_);
+    itens_.swap(o.itens_);
+  }
+
+private:
+  size_t inicio_;
+  size_t tamanho_;
+  std::vector<T> itens_; // Alocados uma vez, na construção
+};
+
+#endif // ANEL_FIXO_H
@@ -0,0 +1,108 @@
+/**
+ * @file anel_spsc.h
+ * @brief Fila circular sem espera para um produtor e um consumidor.
+ *
+ * Cada lado escreve só o próprio índice (cabeça: produtor; cauda:
+ * consumidor) e guarda uma cópia local do índice do outro lado, relida
+ * apenas quando a fila parece cheia (produtor) ou vazia (consumidor). Os
+ * índices ficam em linhas de cache separadas, então empilhar e retirar não
+ * disputam a mesma linha a cada operação. Nenhuma operação bloqueia nem faz
+ * chamada de sistema; esperar por itens fica a cargo de quem usa a fila.
+ *
+ * Os itens podem vir de fora: vários anéis dividem então um único buffer
+ * contíguo, um trecho de N itens por anel.
+ */
+
+#ifndef ANEL_SPSC_H
+#define ANEL_SPSC_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+const size_t LINHA_CACHE = 64; ///< Bytes; separa os índices dos dois lados.
+
+template <typename T, size_t N> class AnelSPSC {
+  static_assert(N >= 2 && (N & (N - 1)) == 0,
+                "capacidade do anel deve ser potência de 2");
+
+public:
+  AnelSPSC()
+      : cabeca_(0), cauda_vista_(0), cauda_(0), cabeca_vista_(0),
+        proprios_(N), itens_(proprios_.data()) {}
+
+  /// Usa os N itens a partir de `itens`, que devem viver mais que o anel.
+  explicit AnelSPSC(T *itens)
+      : cabeca_(0), cauda_vista_(0), cauda_(0), cabeca_vista_(0),
+        itens_(itens) {}
+
+  /// PRODUTOR: insere no fim. @return false se cheia (item não inserido).
+  bool empilhar(const T &item) {
+    size_t cabeca = cabeca_.load(std::memory_order_relaxed);
+    if (cabeca - cauda_vista_ == N) {
+      cauda_vista_ = cauda_.load(std::memory_order_acquire);
+      if (cabeca - cauda_vista_ == N)
+        return false;
+    }
+    itens_[cabeca & (N - 1)] = item;
+    cabeca_.store(cabeca + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// CONSUMIDOR: retira do início. @return false se vazia.
+  bool retirar(T &item) {
+    size_t cauda = cauda_.load(std::memory_order_relaxed);
+    if (cauda == cabeca_vista_) {
+      cabeca_vista_ = cabeca_.load(std::memory_order_acquire);
+      if (cauda == cabeca_vista_)
+        return false;
+    }
+    item = itens_[cauda & (N - 1)];
+    cauda_.store(cauda + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief CONSUMIDOR: retira até `maximo` itens de uma vez (uma única
+   * publicação da cauda).
+   * @return Quantidade copiada para destino.
+   */
+  size_t retirarLote(T *destino, size_t maximo) {
+    size_t cauda = cauda_.load(std::memory_order_relaxed);
+    cabeca_vista_ = cabeca_.load(std::memory_order_acquire);
+    size_t n = std::min(maximo, cabeca_vista_ - cauda);
+    // Até dois trechos contíguos: antes e depois da volta do anel
+    size_t inicio = cauda & (N - 1);
+    size_t primeiro = std::min(n, N - inicio);
+    std::copy(itens_ + inicio, itens_ + inicio + primeiro, destino);
+    std::copy(itens_, itens_ + (n - primeiro), destino + primeiro);
+    cauda_.store(cauda + n, std::memory_order_release);
+    return n;
+  }
+
+  /// Itens na fila (aproximado se chamado fora dos dois lados).
+  size_t tamanho() const {
+    return cabeca_.load(std::memory_order_acquire) -
+           cauda_.load(std::memory_order_acquire);
+  }
+
+  bool vazia() const { return tamanho() == 0; }
+  static size_t capacidade() { return N; }
+
+private:
+  // Lado do produtor
+  std::atomic<size_t> cabeca_;
+  size_t cauda_vista_;
+  char separa_produtor_[LINHA_CACHE];
+
+  // Lado do consumidor
+  std::atomic<size_t> cauda_;
+  size_t cabeca_vista_;
+  char separa_consumidor_[LINHA_CACHE];
+
+  std::vector<T> proprios_; // Vazio se os itens vêm de fora
+  T *itens_;                // Alocados à parte, longe dos índices
+};
+
+#endif // ANEL_SPSC_H
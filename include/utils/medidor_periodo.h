@@ -0,0 +1,125 @@
+/**
+ * @file medidor_periodo.h
+ * @brief Agendamento periódico com medição do período real e do jitter, e
+ * medição de latência de ponta a ponta.
+ */
+
+#ifndef MEDIDOR_PERIODO_H
+#define MEDIDOR_PERIODO_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Relógio monotônico em microssegundos, base dos carimbos das
+ * amostras. No Linux o steady_clock é o CLOCK_MONOTONIC, o mesmo em todos os
+ * processos da máquina (simulador e controle).
+ */
+inline int64_t relogio_monotonico_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @struct EstatisticasPeriodo
+ * @brief Resumo dos ciclos desde o último relatório (tempos em ms).
+ */
+struct EstatisticasPeriodo {
+  uint64_t ciclos;      ///< Períodos medidos.
+  double medio;         ///< Período médio.
+  double desvio;        ///< Desvio padrão do período (jitter).
+  double minimo;        ///< Menor período.
+  double maximo;        ///< Maior período.
+  double atraso_max;    ///< Maior atraso do despertar em relação ao previsto.
+  uint64_t estouros;    ///< Ciclos que passaram do próprio prazo.
+};
+
+/**
+ * @class MedidorPeriodo
+ * @brief Relógio de uma tarefa periódica: agenda o próximo despertar e mede o
+ * período realmente obtido.
+ *
+ * Os despertares são múltiplos do período a partir do início (sem deriva);
+ * se um ciclo estoura o prazo, o agendamento é realinhado ao instante atual
+ * em vez de disparar ciclos atrasados em rajada. Com nome, imprime o resumo a
+ * cada 10 s e reinicia as estatísticas. Usado por uma única
+ * thread (a da tarefa).
+ */
+class MedidorPeriodo {
+public:
+  explicit MedidorPeriodo(const std::string &nome = "");
+
+  /**
+   * @brief Marca o início de um ciclo (chamar logo ao acordar).
+   */
+  void acordou();
+
+  /**
+   * @brief Marca o início de um ciclo disparado por evento, sem proximo().
+   *
+   * O atraso conta do instante do evento (p.ex. a publicação da amostra) e
+   * o ciclo estoura se acordar mais de `prazo` depois dele.
+   */
+  void acordou(std::chrono::steady_clock::time_point evento,
+               std::chrono::steady_clock::duration prazo);
+
+  /**
+   * @brief Próximo instante de despertar para o período dado.
+   */
+  std::chrono::steady_clock::time_point
+  proximo(std::chrono::steady_clock::duration periodo);
+
+  /**
+   * @brief Duração (s) do último ciclo medido; 0 antes do segundo ciclo.
+   */
+  double ultimoPeriodo() const { return ultimo_periodo; }
+
+  EstatisticasPeriodo estatisticas() const;
+  void reiniciar();
+
+private:
+  std::string nome;
+  std::chrono::steady_clock::time_point previsto;
+  std::chrono::steady_clock::time_point anterior;
+  std::chrono::steady_clock::time_point ultimo_relatorio;
+  bool tem_anterior;
+  double ultimo_periodo;
+
+  uint64_t ciclos;
+  double soma, soma2, minimo, maximo, atraso_max;
+  uint64_t estouros;
+};
+
+/**
+ * @class MedidorLatencia
+ * @brief Latência entre dois pontos da cadeia de tarefas (p.ex. amostra do
+ * sensor -> comando enviado ao atuador).
+ *
+ * Acumula média, mínimo e máximo; com nome, imprime o resumo a cada 10 s e
+ * reinicia. Usado por uma única thread (a que observa o fim da cadeia).
+ */
+class MedidorLatencia {
+public:
+  explicit MedidorLatencia(const std::string &nome = "");
+
+  /**
+   * @brief Registra uma latência medida do instante de origem até agora.
+   */
+  void registrar(std::chrono::steady_clock::time_point origem);
+
+  uint64_t amostras() const { return n; }
+  double media() const { return n ? soma / n : 0.0; } ///< ms
+  double minimo() const { return min_ms; }            ///< ms
+  double maximo() const { return max_ms; }            ///< ms
+  void reiniciar();
+
+private:
+  std::string nome;
+  std::chrono::steady_clock::time_point ultimo_relatorio;
+  uint64_t n;
+  double soma, min_ms, max_ms;
+};
+
+#endif // MEDIDOR_PERIODO_H
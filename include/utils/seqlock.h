@@ -0,0 +1,84 @@
+/**
+ * @file seqlock.h
+ * @brief Célula de último valor publicada por seqlock.
+ *
+ * Leitores não bloqueiam o escritor nem uns aos outros: o leitor copia o
+ * valor e confere o contador de versão; se mudou durante a cópia (ou era
+ * ímpar, escrita em curso), tenta de novo. O valor é guardado em palavras
+ * atômicas acessadas com ordem relaxada, então a cópia concorrente não é
+ * corrida de dados. Escritores simultâneos se excluem tornando a versão
+ * ímpar por compare-and-swap, sem mutex.
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock exige tipo copiável por memcpy");
+
+public:
+  explicit SeqLock(const T &inicial = T()) : versao_(0) {
+    escrever_palavras(inicial);
+  }
+
+  /// Publica um valor novo (seguro com vários escritores).
+  void escrever(const T &valor) {
+    uint64_t v = versao_.load(std::memory_order_relaxed);
+    for (;;) {
+      if (v & 1) {
+        std::this_thread::yield(); // Outro escritor no meio da cópia
+        v = versao_.load(std::memory_order_relaxed);
+      } else if (versao_.compare_exchange_weak(v, v + 1,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    escrever_palavras(valor);
+    versao_.store(v + 2, std::memory_order_release);
+  }
+
+  /// Cópia consistente do último valor publicado (sem bloquear).
+  T ler() const {
+    uint64_t palavras[PALAVRAS];
+    for (;;) {
+      uint64_t v1 = versao_.load(std::memory_order_acquire);
+      if (v1 & 1) {
+        // Escrita em curso: se o escritor foi preemptado, girar só atrasa
+        std::this_thread::yield();
+        continue;
+      }
+      for (size_t i = 0; i < PALAVRAS; ++i)
+        palavras[i] = valor_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (versao_.load(std::memory_order_relaxed) == v1)
+        break;
+    }
+    T valor;
+    std::memcpy(&valor, palavras, sizeof(T));
+    return valor;
+  }
+
+private:
+  static const size_t PALAVRAS = (sizeof(T) + 7) / 8;
+
+  void escrever_palavras(const T &valor) {
+    uint64_t palavras[PALAVRAS] = {};
+    std::memcpy(palavras, &valor, sizeof(T));
+    for (size_t i = 0; i < PALAVRAS; ++i)
+      valor_[i].store(palavras[i], std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> versao_; ///< Ímpar durante a escrita.
+  std::atomic<uint64_t> valor_[PALAVRAS];
+};
+
+#endif // SEQLOCK_H
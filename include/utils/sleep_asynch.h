@@ -6,8 +6,10 @@
 #ifndef SLEEP_ASYNCH_H
 #define SLEEP_ASYNCH_H
 
+#include "utils/medidor_periodo.h"
 #include <chrono>
 #include <functional>
+#include <string>
 #include <boost/asio.hpp>
 
 /**
@@ -22,8 +24,9 @@ public:
     /**
      * @brief Construtor.
      * @param io Referência para o contexto de I/O do Boost.Asio.
+     * @param nome Nome da tarefa nos relatórios de jitter (vazio = sem relatório).
      */
-    explicit SleepAsynch(boost::asio::io_context& io);
+    explicit SleepAsynch(boost::asio::io_context& io, const std::string& nome = "");
 
     /**
      * @brief Tipo para o callback a ser executado após o tempo de espera.
@@ -34,14 +37,19 @@ public:
     /**
      * @brief Inicia uma espera assíncrona.
      * 
-     * @param period Duração do tempo de espera (em milissegundos).
+     * @param period Período da tarefa (aceita frações de milissegundo).
      * @param on_complete Função callback a ser chamada quando o tempo expirar.
      */
-    void wait_next_tick(std::chrono::milliseconds period, Callback on_complete);
+    void wait_next_tick(std::chrono::steady_clock::duration period, Callback on_complete);
+
+    /**
+     * @brief Período medido e jitter dos despertares desta tarefa.
+     */
+    const MedidorPeriodo& medidor() const { return medidor_; }
 
 private:
     boost::asio::steady_timer timer_; ///< Temporizador interno do Boost.Asio.
-    std::chrono::steady_clock::time_point next_wake_time_; ///< Próximo tempo de despertar programado.
+    MedidorPeriodo medidor_; ///< Próximo despertar programado e estatísticas.
 };
 
 #endif // SLEEP_ASYNCH_H
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+ * @file trigonometria.h
+ * @brief Seno, cosseno e arco-tangente rápidos, em graus.
+ *
+ * O simulador e os controladores trabalham em graus e chamam essas funções
+ * em todo ciclo, para cada caminhão. São duas famílias, uma por lado do
+ * laço:
+ * - planta (simulador, sensores, CAS e modelo de bicicleta): sen_graus /
+ *   cos_graus, tabela gerada em tempo de compilação (constexpr) com passo
+ *   de 1 grau e interpolação linear, erro absoluto < 4e-5. Nos ângulos
+ *   inteiros (comandos de direção) o seno é exato até o arredondamento em
+ *   float. Em código escalar é a opção mais barata;
+ * - controle (núcleo em lote, MPC e sintonia): sen_poli / cos_poli e
+ *   atan_graus / atan2_graus, polinômios sem desvios nem consulta a tabela,
+ *   para que o laço em lote vetorize. Cada "se" vira máscara 0/1
+ *   multiplicada pela correção (o GCC não converte ?: com aritmética nos
+ *   ramos, que poderia gerar exceção de ponto flutuante). Erro do seno
+ *   < 1e-5; do arco-tangente < 1e-4 grau.
+ */
+
+#ifndef TRIGONOMETRIA_H
+#define TRIGONOMETRIA_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+const size_t PONTOS_SENO = 362; ///< 0 a 361 graus (guarda para 360).
+
+template <size_t N> struct TabelaTrig {
+  float v[N];
+};
+
+extern const TabelaTrig<PONTOS_SENO> TABELA_SENO; ///< sen(i graus).
+
+/// Seno de um ângulo em graus (qualquer valor finito).
+inline float sen_graus(float graus) {
+  float g = graus - 360.0f * std::floor(graus * (1.0f / 360.0f));
+  if (!(g >= 0.0f && g <= 360.0f))
+    return g; // NaN ou infinito: propaga como std::sin
+  int i = (int)g;
+  float f = g - (float)i;
+  return TABELA_SENO.v[i] + f * (TABELA_SENO.v[i + 1] - TABELA_SENO.v[i]);
+}
+
+/// Cosseno de um ângulo em graus.
+inline float cos_graus(float graus) { return sen_graus(graus + 90.0f); }
+
+namespace trig_detalhe {
+
+const float GRAUS_POR_RAD = 57.2957795f;
+const float RAD_POR_GRAU = 0.0174532925f;
+const float PI_F = 3.14159265f;
+
+inline float mascara(bool c) { return c ? 1.0f : 0.0f; }
+
+// floor sem chamada de biblioteca para |x| < PISO_DESLOCAMENTO: o
+// deslocamento torna o argumento positivo e o truncamento vira piso
+const int PISO_DESLOCAMENTO = 64;
+inline float piso(float x) {
+  return (float)((int)(x + (float)PISO_DESLOCAMENTO) - PISO_DESLOCAMENTO);
+}
+
+// atan(z) em graus para 0 <= z <= 1
+inline float atan_unitario(float z) {
+  // Acima de tan(22,5°): atan(z) = 45° + atan((z - 1) / (z + 1))
+  float alto = mascara(z > 0.41421356f);
+  float w = z + alto * ((z - 1.0f) / (z + 1.0f) - z);
+  float w2 = w * w;
+  float p = w * (1.0f +
+                 w2 * (-3.3333333e-1f +
+                       w2 * (2.0e-1f +
+                             w2 * (-1.4285714e-1f +
+                                   w2 * (1.1111111e-1f +
+                                         w2 * -9.0909091e-2f)))));
+  return p * GRAUS_POR_RAD + alto * 45.0f;
+}
+
+} // namespace trig_detalhe
+
+/// Ângulo em graus levado a [-180, 180), sem desvios (|graus| < 64 voltas).
+inline float envolver_180(float graus) {
+  return graus -
+         360.0f * trig_detalhe::piso((graus + 180.0f) * (1.0f / 360.0f));
+}
+
+/// Seno por polinômio, sem desvios (|graus| < 64 voltas).
+inline float sen_poli(float graus) {
+  const float PI_F = trig_detalhe::PI_F;
+  float x = envolver_180(graus) * trig_detalhe::RAD_POR_GRAU;
+  // Reflete para [-pi/2, pi/2]: sen(pi - x) = sen(x)
+  x += trig_detalhe::mascara(x > 0.5f * PI_F) * (PI_F - 2.0f * x);
+  x += trig_detalhe::mascara(x < -0.5f * PI_F) * (-PI_F - 2.0f * x);
+  float x2 = x * x;
+  return x * (1.0f +
+              x2 * (-1.6666667e-1f +
+                    x2 * (8.3333310e-3f +
+                          x2 * (-1.9840874e-4f + x2 * 2.7525562e-6f))));
+}
+
+/// Cosseno por polinômio, sem desvios (|graus| < 64 voltas).
+inline float cos_poli(float graus) { return sen_poli(graus + 90.0f); }
+
+/// Arco-tangente em graus, em [-90, 90], sem desvios.
+inline float atan_graus(float t) {
+  float a = std::fabs(t);
+  // 1/0 = inf: min = 0
+  float r = trig_detalhe::atan_unitario(std::min(a, 1.0f / a));
+  r += trig_detalhe::mascara(a > 1.0f) * (90.0f - 2.0f * r);
+  return r - trig_detalhe::mascara(t < 0.0f) * 2.0f * r;
+}
+
+/// Ângulo de (x, y) em graus, em [-180, 180], como std::atan2(y, x).
+inline float atan2_graus(float y, float x) {
+  float ax = std::fabs(x), ay = std::fabs(y);
+  float maior = std::max(std::max(ax, ay), 1e-30f); // (0, 0) dá 0
+  float r = trig_detalhe::atan_unitario(std::min(ax, ay) / maior);
+  r += trig_detalhe::mascara(ay > ax) * (90.0f - 2.0f * r);
+  r += trig_detalhe::mascara(x < 0.0f) * (180.0f - 2.0f * r);
+  return r - trig_detalhe::mascara(y < 0.0f) * 2.0f * r;
+}
+
+/// Ângulo em graus levado a [0, 360).
+inline float normalizar_graus(float graus) {
+  return graus - 360.0f * std::floor(graus * (1.0f / 360.0f));
+}
+
+/**
+ * @brief Média móvel exponencial de um ângulo em graus, sobre o círculo.
+ *
+ * O passo segue a menor diferença entre a leitura e a média: na volta
+ * 359 -> 0 a média anda +1 grau em vez de atravessar 180.
+ * @return Nova média em [0, 360).
+ */
+inline float media_movel_angulo(float valor, float media, float k) {
+  float d = valor - media;
+  d -= 360.0f * std::floor((d + 180.0f) * (1.0f / 360.0f));
+  return normalizar_graus(media + d * k);
+}
+
+#endif // TRIGONOMETRIA_H
@@ -0,0 +1,63 @@
+#include "cache_caminhos.h"
+#include <algorithm>
+
+CacheCaminhos::CacheCaminhos(size_t capacidade)
+    : capacidade(std::max<size_t>(1, capacidade)), versao_atual(0),
+      acertos_(0), falhas_(0), economizado_us(0.0) {}
+
+void CacheCaminhos::atualizarVersao(uint32_t versao) {
+  if (versao == versao_atual)
+    return;
+  entradas.clear(); // Mapa mudou: nenhum caminho guardado é confiável
+  uso.clear();
+  versao_atual = versao;
+}
+
+const std::vector<Celula> *CacheCaminhos::buscar(const Celula &inicio,
+                                                 const Celula &objetivo,
+                                                 uint32_t versao) {
+  atualizarVersao(versao);
+  auto it = entradas.find(chave(inicio, objetivo));
+  if (it == entradas.end()) {
+    ++falhas_;
+    return nullptr;
+  }
+  uso.splice(uso.begin(), uso, it->second.pos_uso);
+  ++acertos_;
+  economizado_us += it->second.custo_us;
+  return &it->second.caminho;
+}
+
+const std::vector<Celula> &
+CacheCaminhos::guardar(const Celula &inicio, const Celula &objetivo,
+                       uint32_t versao, std::vector<Celula> &caminho,
+                       double custo_us) {
+  atualizarVersao(versao);
+  uint64_t k = chave(inicio, objetivo);
+  auto it = entradas.find(k);
+  if (it != entradas.end()) {
+    uso.splice(uso.begin(), uso, it->second.pos_uso);
+  } else {
+    // O vetor da entrada descartada volta para quem chamou como buffer
+    std::vector<Celula> antigo;
+    if (entradas.size() >= capacidade) {
+      auto velha = entradas.find(uso.back());
+      antigo.swap(velha->second.caminho);
+      entradas.erase(velha);
+      uso.pop_back();
+    }
+    uso.push_front(k);
+    it = entradas
+             .insert(std::make_pair(
+                 k, Entrada{std::move(antigo), 0.0, uso.begin()}))
+             .first;
+  }
+  it->second.caminho.swap(caminho);
+  it->second.custo_us = custo_us;
+  return it->second.caminho;
+}
+
+void CacheCaminhos::limpar() {
+  entradas.clear();
+  uso.clear();
+}
@@ -0,0 +1,260 @@
+#include "campo_fluxo.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace {
+
+const float SQRT2 = 1.41421356f;
+const float INALCANCAVEL = std::numeric_limits<float>::infinity();
+
+// Direção do próximo passo: de (x,y) para (x+DX[d], y+DY[d]). Pares
+// opostos diferem só no bit 0 (d ^ 1); diagonais a partir de 4.
+const int DX[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+const int DY[8] = {0, 0, 1, -1, 1, -1, -1, 1};
+
+} // namespace
+
+// --- CampoFluxo ---
+
+const unsigned char CampoFluxo::SEM_DIRECAO;
+
+CampoFluxo::CampoFluxo(const GradeNavegacao &grade, const Celula &destino)
+    : w(grade.largura()), h(grade.altura()), destino_(destino),
+      custos((size_t)w * h, INALCANCAVEL),
+      direcao((size_t)w * h, SEM_DIRECAO), bx0(destino.x), by0(destino.y),
+      bx1(destino.x), by1(destino.y) {
+  if (!grade.livre(destino.x, destino.y))
+    return;
+
+  // Dijkstra a partir do destino; como o grid é simétrico, o custo de volta
+  // é o custo de ida e o passo de cada célula aponta para o seu pai.
+  typedef std::pair<float, int> Item;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item>> fila;
+  size_t i0 = (size_t)destino.y * w + destino.x;
+  custos[i0] = 0.0f;
+  fila.push(Item(0.0f, i0));
+  while (!fila.empty()) {
+    Item it = fila.top();
+    fila.pop();
+    int i = it.second;
+    if (it.first > custos[i])
+      continue;
+    int x = i % w, y = i / w;
+    bx0 = std::min(bx0, x);
+    by0 = std::min(by0, y);
+    bx1 = std::max(bx1, x);
+    by1 = std::max(by1, y);
+    for (int d = 0; d < 8; ++d) {
+      int nx = x + DX[d], ny = y + DY[d];
+      if (!grade.livre(nx, ny))
+        continue;
+      if (d >= 4 && (!grade.livre(nx, y) || !grade.livre(x, ny)))
+        continue; // Sem cortar quinas
+      size_t j = (size_t)ny * w + nx;
+      float c = it.first + (d >= 4 ? SQRT2 : 1.0f);
+      if (c < custos[j]) {
+        custos[j] = c;
+        direcao[j] = d ^ 1; // Direção oposta: de j volta para i
+        fila.push(Item(c, j));
+      }
+    }
+  }
+}
+
+bool CampoFluxo::alcancada(int x, int y) const {
+  return x >= 0 && y >= 0 && x < w && y < h &&
+         custos[(size_t)y * w + x] != INALCANCAVEL;
+}
+
+float CampoFluxo::custo(int x, int y) const {
+  return alcancada(x, y) ? custos[(size_t)y * w + x] : -1.0f;
+}
+
+bool CampoFluxo::proximo(const Celula &c, Celula &prox) const {
+  if (c.x < 0 || c.y < 0 || c.x >= w || c.y >= h)
+    return false;
+  unsigned char d = direcao[(size_t)c.y * w + c.x];
+  if (d == SEM_DIRECAO)
+    return false;
+  prox = Celula{c.x + DX[d], c.y + DY[d]};
+  return true;
+}
+
+bool CampoFluxo::afetadoPor(int x, int y) const {
+  if (x < bx0 - 1 || x > bx1 + 1 || y < by0 - 1 || y > by1 + 1)
+    return false;
+  for (int dy = -1; dy <= 1; ++dy)
+    for (int dx = -1; dx <= 1; ++dx)
+      if (alcancada(x + dx, y + dy))
+        return true;
+  return false;
+}
+
+// --- CacheCamposFluxo ---
+
+// Fila entre o planejador e a thread de geração. A thread guarda um
+// shared_ptr e sobrevive ao cache até terminar o campo em andamento.
+struct TrabalhoCampos {
+  struct Pedido {
+    int chave;
+    Celula destino;
+    std::shared_ptr<const GradeNavegacao> grade;
+    uint64_t geracao;
+  };
+  struct Pronto {
+    int chave;
+    uint64_t geracao;
+    std::shared_ptr<const CampoFluxo> campo;
+  };
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<Pedido> fila;
+  std::vector<Pronto> prontos;
+  uint64_t geracao = 0; // Muda a cada mapa: descarta o que foi pedido antes
+  bool encerrar = false;
+};
+
+namespace {
+
+void gerarCampos(std::shared_ptr<TrabalhoCampos> t) {
+  std::unique_lock<std::mutex> lock(t->mtx);
+  for (;;) {
+    t->cv.wait(lock, [&t]() { return t->encerrar || !t->fila.empty(); });
+    if (t->encerrar)
+      return;
+    TrabalhoCampos::Pedido p = t->fila.front();
+    t->fila.pop_front();
+    lock.unlock();
+    std::shared_ptr<const CampoFluxo> campo(
+        new CampoFluxo(*p.grade, p.destino));
+    lock.lock();
+    if (p.geracao == t->geracao)
+      t->prontos.push_back(TrabalhoCampos::Pronto{p.chave, p.geracao, campo});
+  }
+}
+
+} // namespace
+
+CacheCamposFluxo::CacheCamposFluxo(size_t limite_bytes)
+    : limite_bytes(limite_bytes), bytes_usados(0), gerados(0) {}
+
+CacheCamposFluxo::~CacheCamposFluxo() {
+  if (!trabalho)
+    return;
+  std::lock_guard<std::mutex> lock(trabalho->mtx);
+  trabalho->encerrar = true;
+  trabalho->cv.notify_one();
+}
+
+void CacheCamposFluxo::setGrade(std::shared_ptr<const GradeNavegacao> g) {
+  grade = std::move(g);
+}
+
+void CacheCamposFluxo::recolherProntos() {
+  std::vector<TrabalhoCampos::Pronto> prontos;
+  {
+    std::lock_guard<std::mutex> lock(trabalho->mtx);
+    prontos.swap(trabalho->prontos);
+  }
+  for (TrabalhoCampos::Pronto &p : prontos) {
+    encomendados.erase(p.chave);
+    size_t b = p.campo->bytes();
+    while (bytes_usados + b > limite_bytes && !uso.empty())
+      remover(campos.find(uso.back()));
+    uso.push_front(p.chave);
+    campos[p.chave] = Entrada{std::move(p.campo), uso.begin()};
+    bytes_usados += b;
+    ++gerados;
+  }
+}
+
+void CacheCamposFluxo::remover(std::unordered_map<int, Entrada>::iterator it) {
+  bytes_usados -= it->second.campo->bytes();
+  uso.erase(it->second.pos_uso);
+  campos.erase(it);
+}
+
+std::shared_ptr<const CampoFluxo>
+CacheCamposFluxo::pedir(const Celula &destino) {
+  if (trabalho)
+    recolherProntos();
+  int k = chave(destino);
+  auto it = campos.find(k);
+  if (it != campos.end()) {
+    uso.splice(uso.begin(), uso, it->second.pos_uso);
+    return it->second.campo;
+  }
+  if (++pedidos[k] < PEDIDOS_PARA_CAMPO || !grade ||
+      encomendados.count(k))
+    return std::shared_ptr<const CampoFluxo>();
+
+  // Campo que nem sozinho cabe no limite: fica só com a busca ponto a ponto
+  size_t celulas = (size_t)grade->largura() * grade->altura();
+  if (celulas * (sizeof(float) + 1) > limite_bytes)
+    return std::shared_ptr<const CampoFluxo>();
+
+  if (!trabalho) {
+    trabalho = std::make_shared<TrabalhoCampos>();
+    std::thread(gerarCampos, trabalho).detach();
+  }
+  std::lock_guard<std::mutex> lock(trabalho->mtx);
+  trabalho->fila.push_back(
+      TrabalhoCampos::Pedido{k, destino, grade, trabalho->geracao});
+  trabalho->cv.notify_one();
+  encomendados.insert(k);
+  return std::shared_ptr<const CampoFluxo>();
+}
+
+std::shared_ptr<const CampoFluxo>
+CacheCamposFluxo::buscar(const Celula &destino) const {
+  auto it = campos.find(chave(destino));
+  if (it == campos.end())
+    return std::shared_ptr<const CampoFluxo>();
+  return it->second.campo;
+}
+
+void CacheCamposFluxo::descartarEncomendas() {
+  encomendados.clear();
+  if (!trabalho)
+    return;
+  // Campos pedidos ou em geração sobre o mapa antigo não entram no cache
+  std::lock_guard<std::mutex> lock(trabalho->mtx);
+  ++trabalho->geracao;
+  trabalho->fila.clear();
+  trabalho->prontos.clear();
+}
+
+void CacheCamposFluxo::invalidar(const std::vector<Celula> &alteradas) {
+  descartarEncomendas();
+  for (auto it = campos.begin(); it != campos.end();) {
+    bool afetado = false;
+    for (const Celula &c : alteradas) {
+      if (it->second.campo->afetadoPor(c.x, c.y)) {
+        afetado = true;
+        break;
+      }
+    }
+    if (afetado) {
+      bytes_usados -= it->second.campo->bytes();
+      uso.erase(it->second.pos_uso);
+      it = campos.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void CacheCamposFluxo::limpar() {
+  descartarEncomendas();
+  campos.clear();
+  uso.clear();
+  pedidos.clear();
+  bytes_usados = 0;
+}
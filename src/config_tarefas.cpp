@@ -0,0 +1,60 @@
+#include "config_tarefas.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+std::chrono::steady_clock::duration periodo_tarefa(float hz) {
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / hz));
+}
+
+ConfigTarefas carregar_config_tarefas(const std::string &arquivo) {
+  ConfigTarefas config;
+  std::ifstream f(arquivo);
+  if (!f)
+    return config;
+
+  std::string linha;
+  int numero = 0;
+  while (std::getline(f, linha)) {
+    ++numero;
+    linha = linha.substr(0, linha.find('#'));
+    std::replace(linha.begin(), linha.end(), '=', ' ');
+    std::istringstream in(linha);
+    std::string chave;
+    float hz;
+    if (!(in >> chave))
+      continue;
+    if (!(in >> hz)) {
+      std::cerr << "[Config] " << arquivo << ":" << numero
+                << ": taxa invalida para '" << chave << "'" << std::endl;
+      continue;
+    }
+    if (chave == "encadeado") {
+      config.encadeado = hz != 0.0f;
+      continue;
+    }
+
+    float *alvo = chave == "sensores"        ? &config.sensores
+                  : chave == "comando"       ? &config.comando
+                  : chave == "navegacao"     ? &config.navegacao
+                  : chave == "monitoramento" ? &config.monitoramento
+                  : chave == "cas"           ? &config.cas
+                  : chave == "planejamento"  ? &config.planejamento
+                  : chave == "atuacao"       ? &config.atuacao
+                                             : nullptr;
+    if (!alvo) {
+      std::cerr << "[Config] " << arquivo << ":" << numero
+                << ": tarefa desconhecida '" << chave << "'" << std::endl;
+      continue;
+    }
+    float limitada = std::max(TAXA_MINIMA_HZ, std::min(TAXA_MAXIMA_HZ, hz));
+    if (limitada != hz)
+      std::cerr << "[Config] " << chave << " = " << hz << " Hz fora de ["
+                << TAXA_MINIMA_HZ << ", " << TAXA_MAXIMA_HZ << "]; usando "
+                << limitada << std::endl;
+    *alvo = limitada;
+  }
+  return config;
+}
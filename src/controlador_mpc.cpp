@@ -0,0 +1,188 @@
+#include "controlador_mpc.h"
+#include "utils/trigonometria.h"
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Comandos das primitivas. A direção vai ao atuador em graus inteiros, então
+// as taxas de giro são múltiplos de 1 grau por passo
+const float ACELERACOES[] = {-100, -60, -30, -15, 0, 15, 30, 60, 100};
+const float GIROS[] = {-50, -40, -30, -20, -10, 0, 10, 20, 30, 40, 50};
+
+// Pesos do custo
+const float W_LATERAL = 1.0f;   // Erro lateral² (m²)
+const float W_RUMO = 5.0f;      // 1 - cos(erro de rumo)
+const float W_VELOCIDADE = 0.5f; // Erro de velocidade² ((m/s)²)
+const float W_FOLGA = 2.0f;     // Falta de folga² (m²)
+const float W_SUAVIDADE = 0.5f; // Variação de aceleração² (fração de 100 %)
+
+// Antecipação da referência de velocidade (s e m)
+const float ANTECIPACAO_MPC_S = 0.5f;
+const float ANTECIPACAO_MPC_MIN = 2.0f;
+
+} // namespace
+
+// --- MapaFolga ---
+
+MapaFolga::MapaFolga(const std::vector<std::vector<char>> &mapa,
+                     float tamanho_celula)
+    : w(mapa.empty() ? 0 : (int)mapa[0].size()), h((int)mapa.size()),
+      tamanho_celula(tamanho_celula), parede((size_t)w * h, 0) {
+  for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w && x < (int)mapa[y].size(); ++x)
+      parede[(size_t)y * w + x] = mapa[y][x] == '1';
+}
+
+float MapaFolga::folga(float x, float y) const {
+  int cx = (int)std::floor(x / tamanho_celula);
+  int cy = (int)std::floor(y / tamanho_celula);
+  if (ehParede(cx, cy))
+    return 0.0f;
+
+  // Distância do ponto ao quadrado de cada parede vizinha
+  float melhor2 = tamanho_celula * tamanho_celula;
+  for (int dy = -1; dy <= 1; ++dy) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      if (!ehParede(cx + dx, cy + dy))
+        continue;
+      float x0 = (cx + dx) * tamanho_celula, y0 = (cy + dy) * tamanho_celula;
+      float ex = std::max(0.0f, std::max(x0 - x, x - x0 - tamanho_celula));
+      float ey = std::max(0.0f, std::max(y0 - y, y - y0 - tamanho_celula));
+      melhor2 = std::min(melhor2, ex * ex + ey * ey);
+    }
+  }
+  return std::sqrt(melhor2);
+}
+
+// --- BibliotecaPrimitivas ---
+
+const BibliotecaPrimitivas &BibliotecaPrimitivas::instancia() {
+  // Gerada uma vez, na primeira consulta (inicialização estática segura)
+  static const BibliotecaPrimitivas biblioteca;
+  return biblioteca;
+}
+
+BibliotecaPrimitivas::BibliotecaPrimitivas() {
+  n_faixas = (int)std::round(VELOCIDADE_MAXIMA_VEICULO / PASSO_VEL_PRIMITIVA) +
+             1;
+  for (float a : ACELERACOES) {
+    for (float g : GIROS) {
+      acel.push_back(a);
+      giros.push_back(g);
+    }
+  }
+
+  tabela.resize((size_t)n_faixas * acel.size() * HORIZONTE_MPC);
+  for (int f = 0; f < n_faixas; ++f) {
+    for (size_t p = 0; p < acel.size(); ++p) {
+      EstadoCinematico e{0.0f, 0.0f, 0.0f, f * PASSO_VEL_PRIMITIVA};
+      EstadoCinematico *saida =
+          &tabela[((size_t)f * acel.size() + p) * HORIZONTE_MPC];
+      for (int k = 0; k < HORIZONTE_MPC; ++k) {
+        avancar_bicicleta(e, acel[p], e.angulo + giros[p] * DT_PRIMITIVA,
+                          DT_PRIMITIVA);
+        saida[k] = e;
+      }
+    }
+  }
+}
+
+int BibliotecaPrimitivas::faixa(float velocidade) const {
+  int f = (int)std::round(velocidade / PASSO_VEL_PRIMITIVA);
+  return std::max(0, std::min(n_faixas - 1, f));
+}
+
+// --- ControladorMPC ---
+
+ControladorMPC::ControladorMPC()
+    : biblioteca(BibliotecaPrimitivas::instancia()), acel_anterior(0.0f),
+      ultimo_tempo_us(0.0f), n_avaliadas(0) {}
+
+bool ControladorMPC::calcular(float x, float y, float angulo,
+                              float velocidade, const PerfilVelocidade &perfil,
+                              size_t &dica, const MapaFolga *folga,
+                              int &aceleracao, int &direcao) {
+  auto inicio = std::chrono::steady_clock::now();
+  auto limite = inicio + std::chrono::microseconds(ORCAMENTO_MPC_US);
+  if (perfil.vazio())
+    return false;
+
+  perfil.localizar(x, y, dica);
+  float c = cos_poli(angulo), s = sen_poli(angulo);
+  int f = biblioteca.faixa(velocidade);
+
+  int melhor = -1;
+  float melhor_custo = std::numeric_limits<float>::max();
+  n_avaliadas = 0;
+  for (int p = 0; p < biblioteca.porFaixa(); ++p) {
+    if ((p & 15) == 15 && std::chrono::steady_clock::now() > limite)
+      break; // Fica com a melhor até aqui
+    ++n_avaliadas;
+
+    float da = (biblioteca.aceleracao(p) - acel_anterior) / 100.0f;
+    float custo = W_SUAVIDADE * da * da;
+    size_t dica_s = dica, dica_p = dica, dica_t = dica, dica_v = dica;
+    const EstadoCinematico *est = biblioteca.estados(f, p);
+    bool colide = false;
+    for (int k = 0; k < HORIZONTE_MPC && custo < melhor_custo; ++k) {
+      float wx = x + c * est[k].x - s * est[k].y;
+      float wy = y + s * est[k].x + c * est[k].y;
+
+      float sk = perfil.localizar(wx, wy, dica_s);
+      float px, py, tx, ty;
+      perfil.pontoEm(sk, dica_p, px, py);
+      perfil.pontoEm(sk + PASSO_PERFIL, dica_t, tx, ty);
+      float ex = wx - px, ey = wy - py;
+      custo += W_LATERAL * (ex * ex + ey * ey);
+
+      if (tx != px || ty != py) {
+        float rumo = atan2_graus(ty - py, tx - px);
+        custo += W_RUMO * (1.0f - cos_poli(angulo + est[k].angulo - rumo));
+      }
+
+      // Referência antecipada, como na navegação: o perfil parte da
+      // velocidade atual e, parado, o veículo nunca sairia do lugar
+      float ev = est[k].velocidade -
+                 perfil.velocidadeEm(
+                     sk + std::max(ANTECIPACAO_MPC_MIN,
+                                   est[k].velocidade * ANTECIPACAO_MPC_S),
+                     dica_v);
+      custo += W_VELOCIDADE * ev * ev;
+
+      if (folga) {
+        float d = folga->folga(wx, wy);
+        if (d < FOLGA_COLISAO) {
+          colide = true;
+          break;
+        }
+        if (d < FOLGA_SEGURA)
+          custo += W_FOLGA * (FOLGA_SEGURA - d) * (FOLGA_SEGURA - d);
+      }
+    }
+    if (!colide && custo < melhor_custo) {
+      melhor_custo = custo;
+      melhor = p;
+    }
+  }
+
+  if (melhor < 0) {
+    // Toda primitiva encosta na parede: freia mantendo o rumo
+    aceleracao = -100;
+    direcao = (int)angulo;
+  } else {
+    float cmd = angulo + biblioteca.giro(melhor) * DT_PRIMITIVA;
+    while (cmd >= 360.0f)
+      cmd -= 360.0f;
+    while (cmd < 0.0f)
+      cmd += 360.0f;
+    aceleracao = (int)biblioteca.aceleracao(melhor);
+    direcao = (int)std::round(cmd) % 360;
+  }
+  acel_anterior = (float)aceleracao;
+  ultimo_tempo_us = std::chrono::duration<float, std::micro>(
+                        std::chrono::steady_clock::now() - inicio)
+                        .count();
+  return n_avaliadas > 0;
+}
@@ -0,0 +1,135 @@
+#include "controle_lote.h"
+#include "perfil_velocidade.h"
+#include "utils/trigonometria.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Campos de GanhosControle pelo nome usado no arquivo
+struct CampoGanho {
+  const char *nome;
+  float GanhosControle::*campo;
+};
+
+const CampoGanho CAMPOS_GANHO[] = {
+    {"kp_vel", &GanhosControle::kp_vel},
+    {"ki_vel", &GanhosControle::ki_vel},
+    {"limite_integral", &GanhosControle::limite_integral},
+    {"entre_eixos", &GanhosControle::entre_eixos},
+    {"k_antecipacao", &GanhosControle::k_antecipacao},
+    {"antecipacao_min", &GanhosControle::antecipacao_min},
+    {"antecipacao_vel_s", &GanhosControle::antecipacao_vel_s},
+    {"antecipacao_vel_min", &GanhosControle::antecipacao_vel_min},
+};
+
+} // namespace
+
+GanhosControle carregar_ganhos_controle(const std::string &arquivo) {
+  GanhosControle g;
+  std::ifstream f(arquivo);
+  if (!f)
+    return g;
+
+  std::string linha;
+  int numero = 0;
+  while (std::getline(f, linha)) {
+    ++numero;
+    linha = linha.substr(0, linha.find('#'));
+    std::replace(linha.begin(), linha.end(), '=', ' ');
+    std::istringstream in(linha);
+    std::string chave;
+    float valor;
+    if (!(in >> chave))
+      continue;
+    bool conhecida = false;
+    for (const CampoGanho &c : CAMPOS_GANHO) {
+      if (chave == c.nome && (in >> valor)) {
+        g.*c.campo = valor;
+        conhecida = true;
+      }
+    }
+    if (!conhecida)
+      std::cerr << "[Ganhos] " << arquivo << ":" << numero
+                << ": linha ignorada '" << chave << "'" << std::endl;
+  }
+  return g;
+}
+
+bool salvar_ganhos_controle(const std::string &arquivo,
+                            const GanhosControle &g,
+                            const std::string &cabecalho) {
+  std::ofstream f(arquivo);
+  if (!f)
+    return false;
+  std::istringstream linhas(cabecalho);
+  std::string linha;
+  while (std::getline(linhas, linha))
+    f << "# " << linha << "\n";
+  for (const CampoGanho &c : CAMPOS_GANHO)
+    f << c.nome << " = " << g.*c.campo << "\n";
+  return (bool)f;
+}
+
+float referencia_perfil(const PerfilVelocidade &perfil, float x, float y,
+                        float v, const GanhosControle &g, DicasPerfil &dicas,
+                        float &v_ref, float &alvo_x, float &alvo_y) {
+  float s = perfil.localizar(x, y, dicas.perfil);
+  float antecipacao =
+      std::max(g.antecipacao_vel_min, v * g.antecipacao_vel_s);
+  v_ref = perfil.velocidadeEm(s + antecipacao, dicas.velocidade);
+  // Ponto sobre a rota inteira (curva suavizada): passa pelos cantos sem
+  // cortá-los e sem salto na troca de waypoint
+  perfil.pontoEm(s + distancia_antecipacao(v, g), dicas.antecipacao, alvo_x,
+                 alvo_y);
+  return s;
+}
+
+void LoteControle::redimensionar(size_t n) {
+  x.resize(n);
+  y.resize(n);
+  angulo.resize(n);
+  velocidade.resize(n);
+  v_ref.resize(n);
+  alvo_x.resize(n);
+  alvo_y.resize(n);
+  integral_vel.resize(n, 0.0f);
+  aceleracao.resize(n);
+  direcao.resize(n);
+}
+
+void calcular_controle_lote(LoteControle &lote, float dt,
+                            const GanhosControle &g) {
+  const size_t n = lote.tamanho();
+  const float *x = lote.x.data(), *y = lote.y.data();
+  const float *ang = lote.angulo.data(), *v = lote.velocidade.data();
+  const float *vr = lote.v_ref.data();
+  const float *ax = lote.alvo_x.data(), *ay = lote.alvo_y.data();
+  float *integral = lote.integral_vel.data();
+  int *acel = lote.aceleracao.data(), *dir = lote.direcao.data();
+
+  // Ganhos em variáveis locais: lidos uma vez, não a cada seleção
+  const float limite = g.limite_integral, kp = g.kp_vel, ki = g.ki_vel;
+  const float dois_l = 2.0f * g.entre_eixos;
+  const float ld_min = g.antecipacao_min, k_ant = g.k_antecipacao;
+
+  // Saturações por min/max e ramos por seleção: o laço vetoriza
+  for (size_t i = 0; i < n; ++i) {
+    // Velocidade (IP)
+    float in = integral[i] + (vr[i] - v[i]) * dt;
+    in = std::min(limite, std::max(-limite, in));
+    integral[i] = in;
+    float u = -kp * v[i] + ki * in;
+    acel[i] = (int)std::min(100.0f, std::max(-100.0f, u));
+
+    // Direção (pure pursuit). Ld não é reduzido perto do alvo: manter a
+    // distância amortece o ganho e evita oscilação no fim da rota
+    float ld = std::max(ld_min, v[i] * k_ant);
+    float alpha = atan2_graus(ay[i] - y[i], ax[i] - x[i]) - ang[i];
+    float giro = atan_graus(dois_l * sen_poli(alpha) / ld);
+    // Comando em [0, 360)
+    dir[i] = (int)(envolver_180(ang[i] + giro - 180.0f) + 180.0f);
+  }
+}
@@ -0,0 +1,417 @@
+#include "despachante_frota.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float INF = 1e30f;
+const float EPS_CUSTO = 1e-3f;
+const int RAIO_BUSCA_LIVRE = 4; ///< Células para achar vizinho livre.
+const int RESERVA_ATE_SITIO = std::numeric_limits<int>::max();
+const int SEM_RESERVA = -1;
+
+// Segue o campo a partir de `inicio` e guarda só os cantos que a linha de
+// visada não consegue pular
+bool rotaDoCampo(const GradeNavegacao &grade, const CampoFluxo &campo,
+                 const Celula &inicio, std::deque<Point> &rota) {
+  if (campo.custo(inicio.x, inicio.y) < 0)
+    return false;
+
+  std::vector<Celula> cantos(1, inicio);
+  size_t limite = (size_t)grade.largura() * grade.altura();
+  Celula c = inicio, prox;
+  int dx = 0, dy = 0;
+  for (size_t n = 0; campo.proximo(c, prox) && n <= limite; ++n) {
+    int ndx = prox.x - c.x, ndy = prox.y - c.y;
+    if (n > 0 && (ndx != dx || ndy != dy))
+      cantos.push_back(c);
+    dx = ndx;
+    dy = ndy;
+    c = prox;
+  }
+  const Celula &destino = campo.destino();
+  if (c.x != destino.x || c.y != destino.y)
+    return false;
+  cantos.push_back(destino);
+
+  size_t ancora = 0;
+  for (size_t k = 1; k + 1 < cantos.size(); ++k) {
+    if (!grade.linhaLivre(cantos[ancora], cantos[k + 1])) {
+      rota.push_back(grade.paraMundo(cantos[k], VELOCIDADE_DESPACHO));
+      ancora = k;
+    }
+  }
+  rota.push_back(grade.paraMundo(destino, VELOCIDADE_DESPACHO));
+  return true;
+}
+
+} // namespace
+
+DespachanteFrota::DespachanteFrota(const GradeNavegacao &grade)
+    : grade(grade), agora_(0.0), ultima_reotimizacao(0.0), multi(grade),
+      duracao_slot(grade.tamanhoCelula() / VELOCIDADE_MEDIA_FROTA) {}
+
+int DespachanteFrota::adicionarSitio(float x, float y, TipoSitio tipo,
+                                     int vagas, float tempo_servico) {
+  Celula c = grade.paraCelula(x, y);
+  if (!grade.celulaLivreProxima(c, RAIO_BUSCA_LIVRE))
+    return -1;
+  sitios_.push_back(Sitio{c, tipo, vagas, tempo_servico});
+  campos.push_back(std::make_shared<CampoFluxo>(grade, c));
+  carga.push_back(0);
+  livre_servico.push_back(0.0);
+
+  // A matriz muda de largura: todas as linhas são refeitas sob demanda
+  custos.assign(frota.size() * sitios_.size(), INF);
+  for (Caminhao &t : frota)
+    t.linha_valida = false;
+  return (int)sitios_.size() - 1;
+}
+
+void DespachanteFrota::mapaAlterado(const std::vector<Celula> &alteradas) {
+  bool mudou = false;
+  for (size_t s = 0; s < sitios_.size(); ++s) {
+    Celula &c = sitios_[s].celula;
+    bool afetado = !grade.livre(c.x, c.y);
+    for (size_t k = 0; k < alteradas.size() && !afetado; ++k)
+      afetado = campos[s]->afetadoPor(alteradas[k].x, alteradas[k].y);
+    if (!afetado)
+      continue;
+    grade.celulaLivreProxima(c, RAIO_BUSCA_LIVRE);
+    campos[s] = std::make_shared<CampoFluxo>(grade, c);
+    mudou = true;
+  }
+  if (mudou)
+    for (Caminhao &t : frota)
+      t.linha_valida = false;
+
+  // Reservas feitas sobre o mapa antigo: as rotas em curso são refeitas no
+  // próximo passo
+  if (!alteradas.empty()) {
+    multi.getTabela().limpar();
+    for (Caminhao &t : frota)
+      t.fim_reserva = SEM_RESERVA;
+  }
+}
+
+void DespachanteFrota::atualizarCaminhao(int id, float x, float y,
+                                         bool disponivel) {
+  auto it = indice_id.find(id);
+  size_t i;
+  if (it == indice_id.end()) {
+    i = frota.size();
+    indice_id[id] = i;
+    frota.push_back(Caminhao{id, x, y, Celula{-1, -1}, false, LIVRE, -1, 0.0,
+                             false, SEM_RESERVA});
+    custos.resize(frota.size() * sitios_.size(), INF);
+  } else {
+    i = it->second;
+  }
+
+  Caminhao &t = frota[i];
+  t.x = x;
+  t.y = y;
+  Celula c = grade.paraCelula(x, y);
+  grade.celulaLivreProxima(c, RAIO_BUSCA_LIVRE);
+  if (c.x != t.celula.x || c.y != t.celula.y) {
+    t.celula = c;
+    t.linha_valida = false;
+  }
+
+  if (!disponivel && t.estado != PARADO) {
+    // Em serviço o caminhão continua ocupando a vaga até terminar
+    if (t.estado == A_CAMINHO) {
+      desatribuir(i);
+      multi.getTabela().liberar(id);
+    }
+    if (t.estado != EM_SERVICO)
+      t.estado = PARADO;
+  } else if (disponivel && t.estado == PARADO) {
+    t.estado = LIVRE;
+  }
+}
+
+void DespachanteFrota::removerCaminhao(int id) {
+  auto it = indice_id.find(id);
+  if (it == indice_id.end())
+    return;
+  size_t i = it->second;
+  if (frota[i].sitio >= 0)
+    desatribuir(i);
+  multi.getTabela().liberar(id);
+  indice_id.erase(it);
+
+  // Troca com o último para manter frota e matriz compactas
+  size_t ultimo = frota.size() - 1;
+  if (i != ultimo) {
+    frota[i] = frota[ultimo];
+    indice_id[frota[i].id] = i;
+    std::copy(custos.begin() + ultimo * sitios_.size(),
+              custos.begin() + (ultimo + 1) * sitios_.size(),
+              custos.begin() + i * sitios_.size());
+  }
+  frota.pop_back();
+  custos.resize(frota.size() * sitios_.size());
+}
+
+int DespachanteFrota::sitioAtribuido(int id) const {
+  auto it = indice_id.find(id);
+  return it == indice_id.end() ? -1 : frota[it->second].sitio;
+}
+
+float DespachanteFrota::custoViagem(int id, int sitio) const {
+  auto it = indice_id.find(id);
+  if (it == indice_id.end() || sitio < 0 || sitio >= (int)sitios_.size())
+    return -1.0f;
+  const Celula &c = frota[it->second].celula;
+  float celulas = campos[sitio]->custo(c.x, c.y);
+  return celulas < 0 ? -1.0f
+                     : celulas * grade.tamanhoCelula() / VELOCIDADE_MEDIA_FROTA;
+}
+
+void DespachanteFrota::atualizarLinha(size_t i) {
+  Caminhao &t = frota[i];
+  float *linha = &custos[i * sitios_.size()];
+  float escala = grade.tamanhoCelula() / VELOCIDADE_MEDIA_FROTA;
+  for (size_t s = 0; s < sitios_.size(); ++s) {
+    float celulas = campos[s]->custo(t.celula.x, t.celula.y);
+    linha[s] = celulas < 0 ? INF : celulas * escala;
+  }
+  t.linha_valida = true;
+}
+
+float DespachanteFrota::custo(size_t i, int s) {
+  if (!frota[i].linha_valida)
+    atualizarLinha(i);
+  return custos[i * sitios_.size() + s];
+}
+
+float DespachanteFrota::marginal(int s) const {
+  return carga[s] * sitios_[s].tempo_servico;
+}
+
+void DespachanteFrota::atribuir(size_t i, int s) {
+  frota[i].sitio = s;
+  frota[i].estado = A_CAMINHO;
+  ++carga[s];
+}
+
+void DespachanteFrota::desatribuir(size_t i) {
+  --carga[frota[i].sitio];
+  frota[i].sitio = -1;
+  frota[i].estado = LIVRE;
+}
+
+void DespachanteFrota::parar(size_t i, std::vector<Despacho> &saida) {
+  Caminhao &t = frota[i];
+  if (t.sitio >= 0)
+    desatribuir(i);
+  multi.getTabela().liberar(t.id);
+  t.fim_reserva = SEM_RESERVA;
+  saida.push_back(Despacho{t.id, -1, std::deque<Point>()});
+}
+
+bool DespachanteFrota::inserir(size_t i, TipoSitio tipo,
+                               std::vector<size_t> &movidos) {
+  int n = (int)sitios_.size();
+
+  // Aresta a->b do grafo residual: o caminhão a caminho de a que menos perde
+  // indo para b
+  transf.assign((size_t)n * n, INF);
+  transf_arg.assign((size_t)n * n, -1);
+  for (size_t j = 0; j < frota.size(); ++j) {
+    if (frota[j].estado != A_CAMINHO || sitios_[frota[j].sitio].tipo != tipo)
+      continue;
+    int a = frota[j].sitio;
+    float ca = custo(j, a);
+    for (int b = 0; b < n; ++b) {
+      if (b == a || sitios_[b].tipo != tipo)
+        continue;
+      float cb = custo(j, b);
+      if (cb >= INF)
+        continue;
+      float &atual = transf[(size_t)a * n + b];
+      if (cb - ca < atual) {
+        atual = cb - ca;
+        transf_arg[(size_t)a * n + b] = (int)j;
+      }
+    }
+  }
+
+  // Bellman-Ford sobre os sítios (há arestas negativas)
+  dist.assign(n, INF);
+  pred.assign(n, -1);
+  for (int s = 0; s < n; ++s)
+    if (sitios_[s].tipo == tipo)
+      dist[s] = custo(i, s);
+  bool mudou = true;
+  for (int rodada = 0; rodada < n && mudou; ++rodada) {
+    mudou = false;
+    for (int a = 0; a < n; ++a) {
+      if (dist[a] >= INF)
+        continue;
+      for (int b = 0; b < n; ++b) {
+        float t = transf[(size_t)a * n + b];
+        if (t < INF && dist[a] + t < dist[b] - EPS_CUSTO) {
+          dist[b] = dist[a] + t;
+          pred[b] = a;
+          mudou = true;
+        }
+      }
+    }
+  }
+  if (mudou) {
+    // Ciclo negativo (atribuição atual subótima): fica só a aresta direta
+    for (int s = 0; s < n; ++s) {
+      pred[s] = -1;
+      dist[s] = sitios_[s].tipo == tipo ? custo(i, s) : INF;
+    }
+  }
+
+  int fim = -1;
+  float melhor = INF;
+  for (int s = 0; s < n; ++s) {
+    if (dist[s] >= INF || carga[s] >= sitios_[s].vagas)
+      continue;
+    if (dist[s] + marginal(s) < melhor) {
+      melhor = dist[s] + marginal(s);
+      fim = s;
+    }
+  }
+  if (fim < 0)
+    return false;
+
+  // Percorre o caminho de trás para a frente: cada sítio intermediário cede
+  // um caminhão e recebe outro, só o último ganha uma vaga ocupada
+  int b = fim;
+  for (int passos = 0; pred[b] >= 0 && passos < n; ++passos) {
+    int a = pred[b];
+    size_t j = (size_t)transf_arg[(size_t)a * n + b];
+    desatribuir(j);
+    atribuir(j, b);
+    movidos.push_back(j);
+    b = a;
+  }
+  atribuir(i, b);
+  movidos.push_back(i);
+  return true;
+}
+
+void DespachanteFrota::emitir(const std::vector<size_t> &indices,
+                              std::vector<Despacho> &saida) {
+  if (indices.empty())
+    return;
+  // Na ordem do vetor (índice na frota, sem prioridade): cada caminho
+  // respeita as reservas dos anteriores e as dos caminhões que não estão
+  // sendo replanejados
+  int t0 = slotAtual();
+  pedidos.clear();
+  for (size_t i : indices)
+    pedidos.push_back(PedidoCaminho{frota[i].id, frota[i].celula,
+                                    sitios_[frota[i].sitio].celula});
+  multi.planejar(pedidos, t0, caminhos);
+
+  for (size_t k = 0; k < indices.size(); ++k) {
+    Caminhao &t = frota[indices[k]];
+    const CaminhoTemporal &c = caminhos[k];
+    Despacho d;
+    d.id = t.id;
+    d.sitio = t.sitio;
+    caminhoParaRota(c, grade, duracao_slot, d.rota);
+    if (c.completo) {
+      if (d.rota.empty()) // Já está no sítio
+        d.rota.push_back(grade.paraMundo(c.celulas.back(), 0.0f));
+      t.fim_reserva = RESERVA_ATE_SITIO;
+    } else {
+      // Além da janela reservada, segue o campo do sítio. Sem caminho pelo
+      // campo, a janela reservada não leva a lugar nenhum: para
+      if (!rotaDoCampo(grade, *campos[t.sitio], c.celulas.back(), d.rota)) {
+        parar(indices[k], saida);
+        continue;
+      }
+      t.fim_reserva = c.t0 + (int)c.celulas.size() - 1;
+    }
+    saida.push_back(d);
+  }
+}
+
+void DespachanteFrota::passo(double agora, std::vector<Despacho> &saida) {
+  agora_ = agora;
+  for (Caminhao &t : frota) {
+    if (t.estado == A_CAMINHO) {
+      Point p = grade.paraMundo(sitios_[t.sitio].celula, 0.0f);
+      float dx = p.x - t.x, dy = p.y - t.y;
+      if (dx * dx + dy * dy > RAIO_CHEGADA_SITIO * RAIO_CHEGADA_SITIO)
+        continue;
+      // Entra na fila do sítio; a vaga só é liberada ao fim do serviço
+      double &livre = livre_servico[t.sitio];
+      t.fim_servico =
+          std::max(agora, livre) + sitios_[t.sitio].tempo_servico;
+      livre = t.fim_servico;
+      t.estado = EM_SERVICO;
+    } else if (t.estado == EM_SERVICO && agora >= t.fim_servico) {
+      t.cheio = sitios_[t.sitio].tipo == SITIO_CARGA;
+      --carga[t.sitio];
+      t.sitio = -1;
+      t.estado = LIVRE;
+    }
+  }
+
+  if (agora - ultima_reotimizacao >= PERIODO_REOTIMIZACAO) {
+    reotimizar(saida);
+    return;
+  }
+
+  std::vector<size_t> movidos;
+  for (size_t i = 0; i < frota.size(); ++i)
+    if (frota[i].estado == LIVRE)
+      inserir(i, frota[i].cheio ? SITIO_BASCULAMENTO : SITIO_CARGA, movidos);
+
+  // Janela reservada no fim: replaneja a partir da posição atual
+  int limite = slotAtual() + multi.horizonte() / 2;
+  for (size_t i = 0; i < frota.size(); ++i)
+    if (frota[i].estado == A_CAMINHO && frota[i].fim_reserva < limite)
+      movidos.push_back(i);
+
+  // Um caminhão desviado mais de uma vez recebe só a última rota
+  std::sort(movidos.begin(), movidos.end());
+  movidos.erase(std::unique(movidos.begin(), movidos.end()), movidos.end());
+  emitir(movidos, saida);
+}
+
+void DespachanteFrota::reotimizar(std::vector<Despacho> &saida) {
+  ultima_reotimizacao = agora_;
+  std::vector<int> anterior(frota.size(), -1);
+  for (size_t i = 0; i < frota.size(); ++i) {
+    if (frota[i].estado != A_CAMINHO)
+      continue;
+    anterior[i] = frota[i].sitio;
+    desatribuir(i);
+  }
+
+  std::vector<size_t> movidos;
+  for (size_t i = 0; i < frota.size(); ++i)
+    if (frota[i].estado == LIVRE)
+      inserir(i, frota[i].cheio ? SITIO_BASCULAMENTO : SITIO_CARGA, movidos);
+
+  // Quem estava a caminho e não entrou em nenhum sítio volta ao anterior,
+  // com a rota e as reservas que já tinha, se ele ainda tem vaga e é
+  // alcançável; senão para e solta as reservas
+  for (size_t i = 0; i < frota.size(); ++i) {
+    int s = anterior[i];
+    if (s < 0 || frota[i].estado != LIVRE)
+      continue;
+    if (carga[s] < sitios_[s].vagas && custo(i, s) < INF)
+      atribuir(i, s);
+    else
+      parar(i, saida);
+  }
+
+  // Só quem mudou de destino recebe rota nova
+  movidos.clear();
+  for (size_t i = 0; i < frota.size(); ++i)
+    if (frota[i].estado == A_CAMINHO && frota[i].sitio != anterior[i])
+      movidos.push_back(i);
+  emitir(movidos, saida);
+}
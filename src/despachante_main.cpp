@@ -0,0 +1,247 @@
+#include "despachante_frota.h"
+#include "frota_dados.h"
+#include "grafo_tuneis.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mosquitto.h>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+using json = nlohmann::json;
+
+// Serviço de despacho: acompanha a frota por MQTT e publica em caminhao/rota
+// a rota de cada caminhão até o próximo ponto de carga ou basculamento.
+
+const int PERIODO_DESPACHO_MS = 500;
+const size_t MAX_SITIOS_AUTOMATICOS = 50;
+const size_t MAX_CAMINHOES_DESPACHO = 256;
+
+struct mosquitto *mosq = nullptr;
+
+// Entradas recebidas na thread do mosquitto, consumidas pelo laço principal.
+// As amostras dos sensores vão para a frota sem mutex: a thread do mosquitto
+// é o único produtor, e o laço lê a frota inteira numa passada.
+FrotaDados frota(MAX_CAMINHOES_DESPACHO);
+std::mutex entrada_mtx;
+std::map<int, bool> disponibilidade;
+std::vector<std::vector<char>> mapa_recebido;
+bool mapa_novo = false;
+
+void on_connect(struct mosquitto *m, void *obj, int rc) {
+  if (rc == 0) {
+    mosquitto_subscribe(m, NULL, "caminhao/mapa", 0);
+    mosquitto_subscribe(m, NULL, "caminhao/sensores", 0);
+    mosquitto_subscribe(m, NULL, "caminhao/estado_sistema", 0);
+  } else {
+    std::cerr << "[Despachante] Falha na conexao MQTT: " << rc << std::endl;
+  }
+}
+
+void on_message(struct mosquitto *m, void *obj,
+                const struct mosquitto_message *msg) {
+  std::string topic(static_cast<char *>(msg->topic));
+  std::string payload(static_cast<char *>(msg->payload), msg->payloadlen);
+
+  try {
+    auto j = json::parse(payload);
+    if (topic == "caminhao/sensores") {
+      if (!j.contains("id") || !j.contains("x") || !j.contains("y"))
+        return;
+      int slot = frota.registrar(j["id"]);
+      if (slot < 0)
+        return; // Frota cheia
+      DadosSensores d = frota.lerUltimoEstado(slot);
+      d.id = j["id"];
+      d.i_posicao_x = j["x"];
+      d.i_posicao_y = j["y"];
+      frota.setDados(slot, d);
+    } else if (topic == "caminhao/estado_sistema") {
+      if (!j.contains("id"))
+        return;
+      bool manual = j.contains("manual") && (bool)j["manual"];
+      bool fault = j.contains("fault") && (bool)j["fault"];
+      std::lock_guard<std::mutex> lock(entrada_mtx);
+      disponibilidade[j["id"]] = !manual && !fault;
+    } else if (topic == "caminhao/mapa") {
+      if (!j.contains("map") || !j["map"].is_array())
+        return;
+      // Mesmo formato aceito pelo MqttDriver: linhas de números ou strings
+      std::vector<std::vector<char>> mapa;
+      for (const auto &linha : j["map"]) {
+        std::vector<char> l;
+        if (linha.is_string()) {
+          std::string s = linha;
+          l.assign(s.begin(), s.end());
+        } else {
+          for (const auto &c : linha)
+            l.push_back(c.is_string() ? c.get<std::string>()[0]
+                                      : static_cast<char>(c.get<int>()));
+        }
+        mapa.push_back(l);
+      }
+      std::lock_guard<std::mutex> lock(entrada_mtx);
+      mapa_recebido.swap(mapa);
+      mapa_novo = true;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "[Despachante] Erro JSON em " << topic << ": " << e.what()
+              << std::endl;
+  }
+}
+
+// Sítios do arquivo de configuração: {"sitios": [{"x", "y", "tipo",
+// "vagas", "servico"}]}, posições em metros
+bool carregarSitios(const std::string &arquivo, DespachanteFrota &despachante) {
+  std::ifstream f(arquivo);
+  if (!f)
+    return false;
+  try {
+    json j = json::parse(f);
+    for (const auto &s : j["sitios"]) {
+      TipoSitio tipo = s.value("tipo", std::string("carga")) == "carga"
+                           ? SITIO_CARGA
+                           : SITIO_BASCULAMENTO;
+      if (despachante.adicionarSitio(s["x"], s["y"], tipo,
+                                     s.value("vagas", VAGAS_SITIO_PADRAO),
+                                     s.value("servico", TEMPO_SERVICO_PADRAO)) <
+          0)
+        std::cerr << "[Despachante] Sitio fora da area livre ignorado"
+                  << std::endl;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "[Despachante] Erro em " << arquivo << ": " << e.what()
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Sem configuração: as salas do grafo de túneis se alternam entre carga e
+// basculamento
+void sitiosDasSalas(const std::vector<std::vector<char>> &mapa,
+                    const GradeNavegacao &grade,
+                    DespachanteFrota &despachante) {
+  GrafoTuneis grafo = extrair_grafo_esqueleto(mapa);
+  size_t n = 0;
+  for (const NoGrafo &no : grafo.nos()) {
+    if (no.tipo != NO_SALA || n >= MAX_SITIOS_AUTOMATICOS)
+      continue;
+    Point p = grade.paraMundo(Celula{no.x, no.y}, 0.0f);
+    if (despachante.adicionarSitio(
+            p.x, p.y, n % 2 == 0 ? SITIO_CARGA : SITIO_BASCULAMENTO) >= 0)
+      ++n;
+  }
+}
+
+void publicarRota(const Despacho &d) {
+  json j;
+  j["id"] = d.id;
+  j["route"] = json::array();
+  for (const Point &p : d.rota)
+    j["route"].push_back({{"x", p.x}, {"y", p.y}, {"speed", p.speed}});
+  std::string payload = j.dump();
+  mosquitto_publish(mosq, NULL, "caminhao/rota", payload.length(),
+                    payload.c_str(), 0, false);
+}
+
+int main(int argc, char **argv) {
+  std::string arquivo_sitios = argc > 1 ? argv[1] : "";
+
+  mosquitto_lib_init();
+  mosq = mosquitto_new("ATR_Despachante", true, nullptr);
+  mosquitto_connect_callback_set(mosq, on_connect);
+  mosquitto_message_callback_set(mosq, on_message);
+
+  int rc = mosquitto_connect(mosq, "127.0.0.1", 1883, 60);
+  if (rc != MOSQ_ERR_SUCCESS) {
+    std::cerr << "[Despachante] Nao foi possivel conectar ao Mosquitto. Erro: "
+              << rc << " (" << mosquitto_strerror(rc) << ")" << std::endl;
+    return 1;
+  }
+  mosquitto_loop_start(mosq);
+
+  GradeNavegacao grade;
+  std::unique_ptr<DespachanteFrota> despachante;
+  std::vector<std::vector<char>> mapa;
+  std::vector<uint64_t> seq_vista(MAX_CAMINHOES_DESPACHO, 0);
+  std::map<int, bool> disp_local;
+  std::vector<Despacho> despachos;
+  auto inicio = std::chrono::steady_clock::now();
+
+  while (true) {
+    auto start_time = std::chrono::steady_clock::now();
+    bool mapa_chegou = false;
+    {
+      std::lock_guard<std::mutex> lock(entrada_mtx);
+      if (mapa_novo) {
+        mapa.swap(mapa_recebido);
+        mapa_novo = false;
+        mapa_chegou = true;
+      }
+      disp_local = disponibilidade;
+    }
+
+    if (mapa_chegou) {
+      GradeNavegacao nova(mapa);
+      if (despachante && nova.largura() == grade.largura() &&
+          nova.altura() == grade.altura()) {
+        // Mesmo mapa com alterações: só os campos afetados são refeitos
+        std::vector<Celula> alteradas;
+        for (int y = 0; y < grade.altura(); ++y)
+          for (int x = 0; x < grade.largura(); ++x)
+            if (nova.livre(x, y) != grade.livre(x, y))
+              alteradas.push_back(Celula{x, y});
+        grade = nova;
+        despachante->mapaAlterado(alteradas);
+      } else {
+        grade = nova;
+        despachante.reset(new DespachanteFrota(grade));
+        std::fill(seq_vista.begin(), seq_vista.end(), 0); // Frota toda de novo
+        if (arquivo_sitios.empty() ||
+            !carregarSitios(arquivo_sitios, *despachante))
+          sitiosDasSalas(mapa, grade, *despachante);
+        std::cout << "[Despachante] Mapa " << grade.largura() << "x"
+                  << grade.altura() << ", " << despachante->sitios().size()
+                  << " sitios" << std::endl;
+      }
+    }
+
+    if (despachante) {
+      // Só os caminhões com amostra nova desde o último passo
+      frota.paraCada([&](size_t s, const DadosSensores &d, uint64_t seq) {
+        if (seq == seq_vista[s])
+          return;
+        seq_vista[s] = seq;
+        auto disp = disp_local.find(d.id);
+        despachante->atualizarCaminhao(d.id, d.i_posicao_x, d.i_posicao_y,
+                                       disp == disp_local.end() ||
+                                           disp->second);
+      });
+      double agora = std::chrono::duration<double>(start_time - inicio).count();
+      despachos.clear();
+      despachante->passo(agora, despachos);
+      for (const Despacho &d : despachos)
+        publicarRota(d);
+      if (!despachos.empty()) {
+        auto dt = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_time);
+        std::cout << "[Despachante] " << despachos.size() << " rotas para "
+                  << despachante->caminhoes() << " caminhoes em " << dt.count()
+                  << " ms" << std::endl;
+      }
+    }
+
+    std::this_thread::sleep_until(
+        start_time + std::chrono::milliseconds(PERIODO_DESPACHO_MS));
+  }
+
+  mosquitto_loop_stop(mosq, true);
+  mosquitto_destroy(mosq);
+  mosquitto_lib_cleanup();
+  return 0;
+}
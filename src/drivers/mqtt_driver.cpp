@@ -1,13 +1,15 @@
 #include "drivers/mqtt_driver.h"
+#include "utils/medidor_periodo.h"
 #include <cstring>
 #include <iostream>
 
 MqttDriver::MqttDriver(const std::string &broker_ip, int port, int truck_id)
-    : broker_ip(broker_ip), port(port), truck_id(truck_id), conectado(false) {
+    : broker_ip(broker_ip), port(port), truck_id(truck_id),
+      mensagens_perdidas(0), conectado(false) {
 
-  // Inicializa dados com zeros
   // Inicializa dados com zeros, mas LiDAR com distância segura
-  ultimos_dados = {0, 0, 0, 0, 0, 0, false, false, 100};
+  ultimos_dados = {0, 0, 0, 0, 0, 0, false, false, 100, 0, 0,
+                   CarimboAmostra{0, 0, 0}};
 
   mosquitto_lib_init();
   std::string client_id = "ATR_Control_System_" + std::to_string(truck_id);
@@ -58,6 +60,12 @@ void MqttDriver::on_connect(struct mosquitto *mosq, void *obj, int rc) {
       // std::cout << "[MqttDriver] Subscribe OK em caminhao/rota" << std::endl;
     }
 
+    sub_rc = mosquitto_subscribe(mosq, NULL, "caminhao/mapa", 0);
+    if (sub_rc != MOSQ_ERR_SUCCESS) {
+      std::cerr << "[MqttDriver] Erro no subscribe mapa: " << sub_rc
+                << std::endl;
+    }
+
   } else {
     std::cerr << "[MqttDriver] Falha na conexao: " << rc << std::endl;
   }
@@ -76,10 +84,13 @@ void MqttDriver::on_message(struct mosquitto *mosq, void *obj,
   } else if (topic == "caminhao/rota") {
     // std::cout << "[MqttDriver] Nova rota recebida!" << std::endl;
     driver->handle_route_message(payload);
+  } else if (topic == "caminhao/mapa") {
+    driver->handle_map_message(payload);
   }
 }
 
 void MqttDriver::handle_sensor_message(const std::string &payload) {
+  int64_t recepcao = relogio_monotonico_us();
   try {
     auto j = json::parse(payload);
     std::lock_guard<std::mutex> lock(dados_mtx);
@@ -109,6 +120,19 @@ void MqttDriver::handle_sensor_message(const std::string &payload) {
     if (j.contains("falha_hidraulica"))
       ultimos_dados.i_falha_hidraulica = j["falha_hidraulica"];
 
+    // Carimbo: sequência e instante de origem vêm do simulador; um salto
+    // na sequência é mensagem perdida (recomeço do simulador não conta)
+    CarimboAmostra &carimbo = ultimos_dados.carimbo;
+    if (j.contains("seq")) {
+      uint64_t seq = j["seq"];
+      if (carimbo.seq != 0 && seq > carimbo.seq + 1)
+        mensagens_perdidas += seq - carimbo.seq - 1;
+      carimbo.seq = seq;
+    }
+    if (j.contains("t_us"))
+      carimbo.t_origem_us = j["t_us"];
+    carimbo.t_recepcao_us = recepcao;
+
     // std::cout << "[MqttDriver] Recebido: x=" << ultimos_dados.i_posicao_x
     //           << " y=" << ultimos_dados.i_posicao_y
     //           << " lidar=" << ultimos_dados.i_lidar_distancia << std::endl;
@@ -119,6 +143,11 @@ void MqttDriver::handle_sensor_message(const std::string &payload) {
 }
 
 CaminhaoFisico MqttDriver::readSensorData(int id) {
+  CarimboAmostra carimbo;
+  return readSensorData(id, carimbo);
+}
+
+CaminhaoFisico MqttDriver::readSensorData(int id, CarimboAmostra &carimbo) {
   std::lock_guard<std::mutex> lock(dados_mtx);
   // Converte DadosSensores (struct interna) para CaminhaoFisico (interface)
   // Na verdade, DadosSensores e CaminhaoFisico são parecidos, mas
@@ -132,6 +161,7 @@ CaminhaoFisico MqttDriver::readSensorData(int id) {
   c.i_lidar_distancia = ultimos_dados.i_lidar_distancia;
   c.i_falha_eletrica = ultimos_dados.i_falha_eletrica;
   c.i_falha_hidraulica = ultimos_dados.i_falha_hidraulica;
+  carimbo = ultimos_dados.carimbo; // Mesma mensagem dos valores acima
   return c;
 }
 
@@ -182,16 +212,80 @@ void MqttDriver::handle_route_message(const std::string &payload) {
                 << std::endl;
     }
 
-    std::lock_guard<std::mutex> lock(route_mtx);
-    last_route_json = payload;
+    // Decodifica aqui, uma vez, direto no buffer de escrita
+    MissaoDecodificada &m = missoes[missao_escrita];
+    m.pontos.clear();
+    if (j.contains("route") && j["route"].is_array()) {
+      const json &r = j["route"];
+      m.tem_destino = false;
+      m.pontos.reserve(r.size());
+      for (const auto &p : r) {
+        float speed = p.contains("speed") ? (float)p["speed"] : 20.0f;
+        m.pontos.push_back({(float)p["x"], (float)p["y"], speed});
+      }
+    } else if (j.contains("goal")) {
+      m.tem_destino = true;
+      m.destino = {(float)j["goal"]["x"], (float)j["goal"]["y"],
+                   j.contains("speed") ? (float)j["speed"] : 20.0f};
+    } else {
+      return;
+    }
+
+    // Publica: o buffer escrito vira o do meio e o antigo meio (lido ou
+    // não) passa a ser o próximo buffer de escrita
+    missao_escrita =
+        missao_meio.exchange(missao_escrita | MISSAO_NOVA,
+                             std::memory_order_acq_rel) &
+        ~MISSAO_NOVA;
   } catch (const std::exception &e) {
     std::cerr << "[MqttDriver] Erro ao parsear rota: " << e.what() << std::endl;
   }
 }
 
-std::string MqttDriver::checkNewRoute() {
-  std::lock_guard<std::mutex> lock(route_mtx);
-  std::string route = last_route_json;
-  last_route_json = ""; // Clear after reading
-  return route;
+const MissaoDecodificada *MqttDriver::checkNewMission() {
+  if (!(missao_meio.load(std::memory_order_acquire) & MISSAO_NOVA))
+    return nullptr;
+  missao_leitura =
+      missao_meio.exchange(missao_leitura, std::memory_order_acq_rel) &
+      ~MISSAO_NOVA;
+  return &missoes[missao_leitura];
+}
+
+void MqttDriver::handle_map_message(const std::string &payload) {
+  try {
+    auto j = json::parse(payload);
+    if (!j.contains("map") || !j["map"].is_array())
+      return;
+
+    // O simulador serializa std::vector<char>, então cada célula chega como
+    // número ('0' = 48); aceita também strings de uma linha por vez.
+    std::vector<std::vector<char>> mapa;
+    for (const auto &linha : j["map"]) {
+      std::vector<char> l;
+      if (linha.is_string()) {
+        std::string s = linha;
+        l.assign(s.begin(), s.end());
+      } else {
+        for (const auto &c : linha)
+          l.push_back(c.is_string() ? c.get<std::string>()[0]
+                                    : static_cast<char>(c.get<int>()));
+      }
+      mapa.push_back(l);
+    }
+
+    std::lock_guard<std::mutex> lock(map_mtx);
+    ultimo_mapa.swap(mapa);
+    mapa_novo = true;
+  } catch (const std::exception &e) {
+    std::cerr << "[MqttDriver] Erro ao parsear mapa: " << e.what() << std::endl;
+  }
+}
+
+bool MqttDriver::checkNewMap(std::vector<std::vector<char>> &mapa) {
+  std::lock_guard<std::mutex> lock(map_mtx);
+  if (!mapa_novo)
+    return false;
+  mapa = ultimo_mapa;
+  mapa_novo = false;
+  return true;
 }
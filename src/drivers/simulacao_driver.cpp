@@ -1,4 +1,5 @@
 #include "drivers/simulacao_driver.h"
+#include "utils/medidor_periodo.h"
 
 // Construtor já está definido inline no header, não precisa repetir aqui
 
@@ -6,6 +7,13 @@ CaminhaoFisico SimulacaoDriver::readSensorData(int id_caminhao) {
     return simulacao.getEstadoReal(id_caminhao);
 }
 
+CaminhaoFisico SimulacaoDriver::readSensorData(int id_caminhao,
+                                               CarimboAmostra &carimbo) {
+    CaminhaoFisico c = simulacao.getEstadoReal(id_caminhao);
+    carimbo = CarimboAmostra{c.seq, c.t_amostra_us, relogio_monotonico_us()};
+    return c;
+}
+
 void SimulacaoDriver::setAtuadores(int aceleracao, int direcao) {
     // Repassa para a simulação física (Assumindo ID 0 por enquanto)
     simulacao.setComandoAtuador(0, aceleracao, direcao);
@@ -0,0 +1,123 @@
+#include "frota_dados.h"
+#include <algorithm>
+#include <new>
+
+namespace {
+
+std::chrono::steady_clock::rep ticks(std::chrono::steady_clock::time_point t) {
+  return t.time_since_epoch().count();
+}
+
+} // namespace
+
+FrotaDados::FrotaDados(size_t capacidade)
+    : capacidade_(capacidade), ocupados(0),
+      itens_historico(capacidade * CAPACIDADE_HISTORICO_FROTA),
+      ids_(capacidade, -1) {
+  // Alocação única: os slots ficam lado a lado, cada um com o seu trecho do
+  // buffer de históricos
+  slots = static_cast<Slot *>(::operator new(sizeof(Slot) * capacidade));
+  for (size_t i = 0; i < capacidade; ++i)
+    new (&slots[i]) Slot(&itens_historico[i * CAPACIDADE_HISTORICO_FROTA]);
+  indice_id.reserve(capacidade);
+}
+
+FrotaDados::FrotaDados(const std::vector<int> &ids) : FrotaDados(ids.size()) {
+  for (int id : ids)
+    registrar(id);
+}
+
+FrotaDados::~FrotaDados() {
+  for (size_t i = 0; i < capacidade_; ++i)
+    slots[i].~Slot();
+  ::operator delete(slots);
+}
+
+int FrotaDados::registrar(int id) {
+  int s = slot(id);
+  if (s >= 0)
+    return s;
+  size_t n = ocupados.load(std::memory_order_relaxed);
+  if (n == capacidade_)
+    return -1;
+  ids_[n] = id;
+  indice_id[id] = n;
+  ocupados.store(n + 1, std::memory_order_release);
+  return (int)n;
+}
+
+void FrotaDados::setDados(size_t slot, const DadosSensores &dados) {
+  Slot &s = slots[slot];
+  if (!s.historico.empilhar(dados))
+    s.descartados.fetch_add(1, std::memory_order_relaxed);
+  ++s.seq;
+  s.ultimo.escrever(AmostraPublicada{
+      dados, s.seq, ticks(std::chrono::steady_clock::now())});
+}
+
+bool FrotaDados::setDados(const DadosSensores &dados) {
+  int i = slot(dados.id);
+  if (i < 0)
+    return false;
+  setDados((size_t)i, dados);
+  return true;
+}
+
+DadosSensores FrotaDados::lerUltimoEstado(size_t slot) const {
+  return slots[slot].ultimo.ler().dados;
+}
+
+DadosSensores FrotaDados::lerUltimoEstado(
+    size_t slot, uint64_t &seq,
+    std::chrono::steady_clock::time_point &instante) const {
+  AmostraPublicada a = slots[slot].ultimo.ler();
+  seq = a.seq;
+  instante = std::chrono::steady_clock::time_point(
+      std::chrono::steady_clock::duration(a.instante));
+  return a.dados;
+}
+
+void FrotaDados::setComandosAtuador(size_t slot,
+                                    const ComandosAtuador &comandos) {
+  slots[slot].comandos.escrever(comandos);
+}
+
+ComandosAtuador FrotaDados::getComandosAtuador(size_t slot) const {
+  return slots[slot].comandos.ler();
+}
+
+void FrotaDados::lerFrota(std::vector<DadosSensores> &saida) const {
+  size_t n = tamanho();
+  saida.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    saida[i] = slots[i].ultimo.ler().dados;
+}
+
+size_t FrotaDados::consumirLote(std::vector<DadosSensores> &saida,
+                                size_t maximo_por_caminhao) {
+  saida.clear();
+  maximo_por_caminhao =
+      std::min(maximo_por_caminhao, CAPACIDADE_HISTORICO_FROTA);
+  size_t n = 0, slots_ocupados = tamanho();
+  for (size_t i = 0; i < slots_ocupados; ++i) {
+    // Só cresce o vetor para slots com amostras pendentes
+    size_t pendentes = slots[i].historico.tamanho();
+    if (pendentes == 0)
+      continue;
+    saida.resize(n + std::min(pendentes, maximo_por_caminhao));
+    n += slots[i].historico.retirarLote(saida.data() + n, saida.size() - n);
+  }
+  saida.resize(n);
+  return n;
+}
+
+uint64_t FrotaDados::getDescartadosHistorico(size_t slot) const {
+  return slots[slot].descartados.load(std::memory_order_relaxed);
+}
+
+uint64_t FrotaDados::getDescartadosHistorico() const {
+  uint64_t total = 0, n = tamanho();
+  for (size_t i = 0; i < n; ++i)
+    total += slots[i].descartados.load(std::memory_order_relaxed);
+  return total;
+}
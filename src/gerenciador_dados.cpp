@@ -1,101 +1,284 @@
 #include "gerenciador_dados.h"
 #include <iostream>
+#include <limits>
 
-GerenciadorDados::GerenciadorDados() : bufferHistorico(TAMANHO_BUFFER) {
-  // Inicializa o snapshot zerado para evitar leitura de lixo antes do primeiro
-  // sensor
-  // Inicializa o snapshot zerado para evitar leitura de lixo antes do primeiro
+namespace {
+
+std::chrono::steady_clock::rep ticks(std::chrono::steady_clock::time_point t) {
+  return t.time_since_epoch().count();
+}
+
+std::chrono::steady_clock::time_point
+instante(std::chrono::steady_clock::rep t) {
+  return std::chrono::steady_clock::time_point(
+      std::chrono::steady_clock::duration(t));
+}
+
+} // namespace
+
+GerenciadorDados::GerenciadorDados()
+    : descartadosHistorico(0), limiarColetor(0), seqEstado(0),
+      esperandoEstado(0),
+      // Sem defeito, Modo Automático Ligado
+      estadoVeiculo(EstadoVeiculo{false, true}), seqComandos(0),
+      perfilNavegacao(nullptr), bloqueio{0, 0}, bloqueioPendente(false),
+      replanejamentoAtivo(false),
+      limiteVelocidade(std::numeric_limits<float>::infinity()),
+      manobraRecuo(false) {
+  // As células SeqLock nascem zeradas: sem leitura de lixo antes do primeiro
   // sensor
-  ultimoEstado = {0};
-  estadoVeiculo = {false, true}; // Sem defeito, Modo Automático Ligado
 }
 
 void GerenciadorDados::setDados(const DadosSensores &dados) {
-  std::lock_guard<std::mutex> lock(mtx);
-
   // 1. Alimenta o Stream (Histórico)
-  // O circular_buffer cuida de sobrescrever o antigo se estiver cheio
-  bufferHistorico.push_back(dados);
+  if (!bufferHistorico.empilhar(dados))
+    descartadosHistorico.fetch_add(1, std::memory_order_relaxed);
 
-  // 2. Atualiza o Snapshot (Tempo Real)
-  ultimoEstado = dados;
+  // Notifica o coletor só se ele dorme e o lote pedido já está completo. A
+  // barreira ordena a publicação do item antes da leitura do limiar (par com
+  // aguardarHistorico): ou o coletor vê o item, ou o produtor vê o limiar
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  size_t limiar = limiarColetor.load(std::memory_order_relaxed);
+  if (limiar != 0 && bufferHistorico.tamanho() >= limiar) {
+    std::lock_guard<std::mutex> lock(mtx_historico);
+    cv_dados.notify_one();
+  }
 
-  // Notifica quem estiver esperando por dados novos no histórico (Logger)
-  cv_dados.notify_one();
-}
+  // 2. Atualiza o Snapshot (Tempo Real). Produtor único: a sequência sobe
+  // depois da amostra, e quem a vê mudar lê a amostra nova
+  uint64_t seq = seqEstado.load(std::memory_order_relaxed) + 1;
+  ultimoEstado.escrever(AmostraPublicada{
+      dados, seq, ticks(std::chrono::steady_clock::now())});
+  seqEstado.store(seq, std::memory_order_seq_cst);
 
-DadosSensores GerenciadorDados::consumirDados() {
-  std::unique_lock<std::mutex> lock(mtx);
+  // ... e acorda a navegação encadeada, se ela dorme. Mesmo par do limiar do
+  // coletor: ou ela vê a sequência nova, ou o produtor a vê esperando
+  if (esperandoEstado.load(std::memory_order_seq_cst) != 0) {
+    std::lock_guard<std::mutex> lock(mtx_estado);
+    cv_estado.notify_all();
+  }
+}
 
-  // Bloqueia se não houver histórico para consumir
-  cv_dados.wait(lock, [this] { return !bufferHistorico.empty(); });
+size_t GerenciadorDados::consumirLote(
+    std::vector<DadosSensores> &saida, size_t maximo,
+    std::chrono::steady_clock::duration timeout, size_t minimo) {
+  saida.clear();
+  if (maximo == 0)
+    return 0;
+  minimo = std::max<size_t>(1, std::min(minimo, std::min(maximo,
+                                                        CAPACIDADE_HISTORICO)));
+  if (bufferHistorico.tamanho() < minimo)
+    aguardarHistorico(minimo, std::chrono::steady_clock::now() + timeout);
 
-  DadosSensores dados = bufferHistorico.front();
-  bufferHistorico.pop_front(); // Remove da fila!
+  saida.resize(maximo);
+  saida.resize(bufferHistorico.retirarLote(saida.data(), maximo));
+  return saida.size();
+}
 
-  return dados;
+bool GerenciadorDados::aguardarHistorico(
+    size_t minimo, std::chrono::steady_clock::time_point limite) {
+  // Anuncia o limiar e confere a fila de novo antes de dormir
+  std::unique_lock<std::mutex> lock(mtx_historico);
+  limiarColetor.store(minimo, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto pronto = [&] { return bufferHistorico.tamanho() >= minimo; };
+  bool ok;
+  if (limite == std::chrono::steady_clock::time_point::max()) {
+    cv_dados.wait(lock, pronto);
+    ok = true;
+  } else {
+    ok = cv_dados.wait_until(lock, limite, pronto);
+  }
+  limiarColetor.store(0, std::memory_order_relaxed);
+  return ok;
 }
 
 DadosSensores GerenciadorDados::lerUltimoEstado() const {
-  std::lock_guard<std::mutex> lock(mtx);
-  // Apenas lê a variável. Rápido e não interfere no buffer.
-  return ultimoEstado;
+  // Sem mutex: cópia validada pelo contador de versão do seqlock
+  return ultimoEstado.ler().dados;
+}
+
+DadosSensores GerenciadorDados::lerUltimoEstado(
+    uint64_t &seq, std::chrono::steady_clock::time_point &instante) const {
+  AmostraPublicada a = ultimoEstado.ler();
+  seq = a.seq;
+  instante = ::instante(a.instante);
+  return a.dados;
+}
+
+uint64_t GerenciadorDados::aguardarNovoEstado(
+    uint64_t seq, std::chrono::steady_clock::duration timeout) {
+  if (seqEstado.load() != seq)
+    return seqEstado.load();
+  esperandoEstado.fetch_add(1, std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> lock(mtx_estado);
+    cv_estado.wait_for(lock, timeout, [&] { return seqEstado.load() != seq; });
+  }
+  esperandoEstado.fetch_sub(1, std::memory_order_relaxed);
+  return seqEstado.load();
 }
 
-// --- Métodos Boilerplate (Mantidos) ---
+// --- Células de valor (SeqLock: leitura sem mutex) ---
+
+void GerenciadorDados::setEstatisticasSensores(const EstatisticasSensores &e) {
+  estatisticasSensores.escrever(e);
+}
+
+EstatisticasSensores GerenciadorDados::getEstatisticasSensores() const {
+  return estatisticasSensores.ler();
+}
 
 void GerenciadorDados::setEstadoVeiculo(const EstadoVeiculo &estado) {
-  std::lock_guard<std::mutex> lock(mtx);
-  estadoVeiculo = estado;
+  estadoVeiculo.escrever(estado);
 }
 
 EstadoVeiculo GerenciadorDados::getEstadoVeiculo() const {
-  std::lock_guard<std::mutex> lock(mtx);
-  return estadoVeiculo;
+  return estadoVeiculo.ler();
 }
 
 void GerenciadorDados::setComandosOperador(const ComandosOperador &comandos) {
-  std::lock_guard<std::mutex> lock(mtx);
-  comandosOperador = comandos;
+  comandosOperador.escrever(comandos);
 }
 
 ComandosOperador GerenciadorDados::getComandosOperador() const {
-  std::lock_guard<std::mutex> lock(mtx);
-  return comandosOperador;
+  return comandosOperador.ler();
 }
 
 void GerenciadorDados::atualizarEstadoVeiculo(const EstadoVeiculo &estado) {
-  std::lock_guard<std::mutex> lock(mtx);
-  estadoVeiculo = estado;
+  estadoVeiculo.escrever(estado);
 }
 
 void GerenciadorDados::atualizarComandosOperador(
     const ComandosOperador &comandos) {
-  std::lock_guard<std::mutex> lock(mtx);
-  comandosOperador = comandos;
+  comandosOperador.escrever(comandos);
 }
 
 void GerenciadorDados::setComandosAtuador(const ComandosAtuador &comandos) {
-  std::lock_guard<std::mutex> lock(mtx);
-  comandosAtuador = comandos;
+  publicarComandos(comandos, false, 0);
 }
 
 ComandosAtuador GerenciadorDados::getComandosAtuador() const {
-  std::lock_guard<std::mutex> lock(mtx);
-  return comandosAtuador;
+  return comandosAtuador.ler().comandos;
+}
+
+void GerenciadorDados::setComandosAtuador(
+    const ComandosAtuador &comandos,
+    std::chrono::steady_clock::time_point instante_amostra) {
+  publicarComandos(comandos, true, ticks(instante_amostra));
+}
+
+void GerenciadorDados::publicarComandos(
+    const ComandosAtuador &comandos, bool com_amostra,
+    std::chrono::steady_clock::rep instante_amostra) {
+  {
+    // Navegação e lógica de comando escrevem; o mutex mantém a sequência
+    // coerente com a espera da atuação
+    std::lock_guard<std::mutex> lock(mtx_comandos);
+    ++seqComandos;
+    comandosAtuador.escrever(
+        ComandosPublicados{comandos, seqComandos, com_amostra,
+                           instante_amostra});
+  }
+  cv_comandos.notify_all();
+}
+
+ComandosAtuador GerenciadorDados::getComandosAtuador(
+    uint64_t &seq, bool &com_amostra,
+    std::chrono::steady_clock::time_point &instante_amostra) const {
+  ComandosPublicados c = comandosAtuador.ler();
+  seq = c.seq;
+  com_amostra = c.com_amostra;
+  instante_amostra = instante(c.instante_amostra);
+  return c.comandos;
+}
+
+uint64_t GerenciadorDados::aguardarComandosAtuador(
+    uint64_t seq, std::chrono::steady_clock::duration timeout) {
+  std::unique_lock<std::mutex> lock(mtx_comandos);
+  cv_comandos.wait_for(lock, timeout, [&] { return seqComandos != seq; });
+  return seqComandos;
 }
 
 void GerenciadorDados::setObjetivo(const ObjetivoNavegacao &obj) {
-  std::lock_guard<std::mutex> lock(mtx);
-  objetivoAtual = obj;
+  objetivoAtual.escrever(obj);
 }
 
 ObjetivoNavegacao GerenciadorDados::getObjetivo() const {
-  std::lock_guard<std::mutex> lock(mtx);
-  return objetivoAtual;
+  return objetivoAtual.ler();
+}
+
+// --- Publicações do planejador ---
+
+void GerenciadorDados::setPerfilVelocidade(
+    std::shared_ptr<const PerfilVelocidade> perfil) {
+  std::lock_guard<std::mutex> lock(mtx_publicacoes);
+  perfilVelocidade = perfil;
+}
+
+std::shared_ptr<const PerfilVelocidade>
+GerenciadorDados::usarPerfilVelocidade() {
+  std::lock_guard<std::mutex> lock(mtx_publicacoes);
+  perfilNavegacao = perfilVelocidade.get();
+  return perfilVelocidade;
+}
+
+const PerfilVelocidade *GerenciadorDados::perfilEmUso() const {
+  std::lock_guard<std::mutex> lock(mtx_publicacoes);
+  return perfilNavegacao;
+}
+
+void GerenciadorDados::setMapaFolga(std::shared_ptr<const MapaFolga> folga) {
+  std::lock_guard<std::mutex> lock(mtx_publicacoes);
+  mapaFolga = folga;
+}
+
+std::shared_ptr<const MapaFolga> GerenciadorDados::getMapaFolga() const {
+  std::lock_guard<std::mutex> lock(mtx_publicacoes);
+  return mapaFolga;
+}
+
+// --- Desvio e recuo ---
+
+void GerenciadorDados::reportarBloqueio(const BloqueioDetectado &b) {
+  std::lock_guard<std::mutex> lock(mtx_bloqueio);
+  bloqueio = b;
+  bloqueioPendente = true;
+}
+
+bool GerenciadorDados::consumirBloqueio(BloqueioDetectado &b) {
+  std::lock_guard<std::mutex> lock(mtx_bloqueio);
+  if (!bloqueioPendente)
+    return false;
+  b = bloqueio;
+  bloqueioPendente = false;
+  return true;
+}
+
+void GerenciadorDados::setReplanejamentoAtivo(bool ativo) {
+  replanejamentoAtivo.store(ativo);
+}
+
+bool GerenciadorDados::getReplanejamentoAtivo() const {
+  return replanejamentoAtivo.load();
+}
+
+void GerenciadorDados::setLimiteVelocidade(float v) {
+  limiteVelocidade.store(v);
 }
 
+float GerenciadorDados::getLimiteVelocidade() const {
+  return limiteVelocidade.load();
+}
+
+void GerenciadorDados::setManobraRecuo(bool ativa) { manobraRecuo.store(ativa); }
+
+bool GerenciadorDados::getManobraRecuo() const { return manobraRecuo.load(); }
+
 int GerenciadorDados::getContadorDados() const {
-  std::lock_guard<std::mutex> lock(mtx);
-  return bufferHistorico.size();
-}
\ No newline at end of file
+  return (int)bufferHistorico.tamanho();
+}
+
+uint64_t GerenciadorDados::getDescartadosHistorico() const {
+  return descartadosHistorico.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,253 @@
+#include "grafo_tuneis.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+int GrafoTuneis::adicionarNo(int x, int y, TipoNo tipo) {
+  nos_.push_back({x, y, tipo});
+  adjacencia.emplace_back();
+  return nos_.size() - 1;
+}
+
+void GrafoTuneis::adicionarAresta(int a, int b, float comprimento) {
+  arestas_.push_back({a, b, comprimento});
+  adjacencia[a].push_back(arestas_.size() - 1);
+  adjacencia[b].push_back(arestas_.size() - 1);
+}
+
+int GrafoTuneis::noMaisProximo(int x, int y) const {
+  int melhor = -1;
+  long melhor_d2 = std::numeric_limits<long>::max();
+  for (size_t i = 0; i < nos_.size(); ++i) {
+    long dx = nos_[i].x - x;
+    long dy = nos_[i].y - y;
+    long d2 = dx * dx + dy * dy;
+    if (d2 < melhor_d2) {
+      melhor_d2 = d2;
+      melhor = i;
+    }
+  }
+  return melhor;
+}
+
+void GrafoTuneis::limpar() {
+  nos_.clear();
+  arestas_.clear();
+  adjacencia.clear();
+}
+
+// --- Esqueletonização ---
+
+namespace {
+
+// Vizinhança de Zhang-Suen em ordem p2..p9 (N, NE, L, SE, S, SO, O, NO)
+const int VIZ_X[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+const int VIZ_Y[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+struct Imagem {
+  int w, h;
+  std::vector<unsigned char> px;
+
+  unsigned char get(int x, int y) const {
+    if (x < 0 || y < 0 || x >= w || y >= h)
+      return 0;
+    return px[(size_t)y * w + x];
+  }
+  void vizinhos(int x, int y, unsigned char p[8]) const {
+    for (int k = 0; k < 8; ++k)
+      p[k] = get(x + VIZ_X[k], y + VIZ_Y[k]);
+  }
+};
+
+// Número de transições 0->1 percorrendo p2..p9,p2
+int cruzamentos(const unsigned char p[8]) {
+  int a = 0;
+  for (int k = 0; k < 8; ++k)
+    if (!p[k] && p[(k + 1) % 8])
+      ++a;
+  return a;
+}
+
+void afinar_zhang_suen(Imagem &img) {
+  std::vector<size_t> remover;
+  bool mudou = true;
+  while (mudou) {
+    mudou = false;
+    for (int passo = 0; passo < 2; ++passo) {
+      remover.clear();
+      for (int y = 0; y < img.h; ++y) {
+        for (int x = 0; x < img.w; ++x) {
+          if (!img.px[(size_t)y * img.w + x])
+            continue;
+          unsigned char p[8];
+          img.vizinhos(x, y, p);
+          int b = 0;
+          for (int k = 0; k < 8; ++k)
+            b += p[k];
+          if (b < 2 || b > 6 || cruzamentos(p) != 1)
+            continue;
+          // p[0]=p2(N) p[2]=p4(L) p[4]=p6(S) p[6]=p8(O)
+          if (passo == 0 &&
+              ((p[0] && p[2] && p[4]) || (p[2] && p[4] && p[6])))
+            continue;
+          if (passo == 1 &&
+              ((p[0] && p[2] && p[6]) || (p[0] && p[4] && p[6])))
+            continue;
+          remover.push_back((size_t)y * img.w + x);
+        }
+      }
+      for (size_t i : remover)
+        img.px[i] = 0;
+      if (!remover.empty())
+        mudou = true;
+    }
+  }
+}
+
+} // namespace
+
+GrafoTuneis extrair_grafo_esqueleto(const std::vector<std::vector<char>> &mapa,
+                                    int folga_sala) {
+  GrafoTuneis grafo;
+  if (mapa.empty() || mapa[0].empty())
+    return grafo;
+
+  Imagem img;
+  img.h = mapa.size();
+  img.w = mapa[0].size();
+  img.px.assign((size_t)img.w * img.h, 0);
+  for (int y = 0; y < img.h; ++y)
+    for (int x = 0; x < img.w && x < (int)mapa[y].size(); ++x)
+      img.px[(size_t)y * img.w + x] = mapa[y][x] != '1';
+
+  // 1. Folga até a parede (distância de Chebyshev, BFS a partir das paredes)
+  const int SEM_FOLGA = std::numeric_limits<int>::max();
+  std::vector<int> folga(img.px.size(), SEM_FOLGA);
+  std::deque<size_t> fila;
+  for (size_t i = 0; i < img.px.size(); ++i) {
+    int x = i % img.w, y = i / img.w;
+    bool borda = x == 0 || y == 0 || x == img.w - 1 || y == img.h - 1;
+    if (!img.px[i] || borda) {
+      folga[i] = img.px[i] ? 1 : 0;
+      fila.push_back(i);
+    }
+  }
+  while (!fila.empty()) {
+    size_t i = fila.front();
+    fila.pop_front();
+    int x = i % img.w, y = i / img.w;
+    for (int k = 0; k < 8; ++k) {
+      int nx = x + VIZ_X[k], ny = y + VIZ_Y[k];
+      if (nx < 0 || ny < 0 || nx >= img.w || ny >= img.h)
+        continue;
+      size_t j = (size_t)ny * img.w + nx;
+      if (folga[j] > folga[i] + 1) {
+        folga[j] = folga[i] + 1;
+        fila.push_back(j);
+      }
+    }
+  }
+
+  // 2. Esqueleto de 1 célula
+  afinar_zhang_suen(img);
+
+  // 3. Pixels de nó: extremidades (<= 1 cruzamento) e bifurcações (>= 3)
+  std::vector<unsigned char> e_no(img.px.size(), 0);
+  std::vector<unsigned char> e_extremidade(img.px.size(), 0);
+  for (int y = 0; y < img.h; ++y) {
+    for (int x = 0; x < img.w; ++x) {
+      size_t i = (size_t)y * img.w + x;
+      if (!img.px[i])
+        continue;
+      unsigned char p[8];
+      img.vizinhos(x, y, p);
+      int a = cruzamentos(p);
+      if (a <= 1) {
+        e_no[i] = 1;
+        e_extremidade[i] = 1;
+      } else if (a >= 3) {
+        e_no[i] = 1;
+      }
+    }
+  }
+
+  // 4. Agrupa pixels de nó adjacentes em um único nó do grafo
+  std::vector<int> grupo(img.px.size(), -1);
+  for (size_t semente = 0; semente < img.px.size(); ++semente) {
+    if (!e_no[semente] || grupo[semente] >= 0)
+      continue;
+    size_t repr = semente;
+    bool so_extremidade = true;
+    int id_provisorio = grafo.nos().size();
+    grupo[semente] = id_provisorio;
+    fila.assign(1, semente);
+    while (!fila.empty()) {
+      size_t i = fila.front();
+      fila.pop_front();
+      if (folga[i] > folga[repr])
+        repr = i;
+      if (!e_extremidade[i])
+        so_extremidade = false;
+      int x = i % img.w, y = i / img.w;
+      for (int k = 0; k < 8; ++k) {
+        int nx = x + VIZ_X[k], ny = y + VIZ_Y[k];
+        if (nx < 0 || ny < 0 || nx >= img.w || ny >= img.h)
+          continue;
+        size_t j = (size_t)ny * img.w + nx;
+        if (e_no[j] && grupo[j] < 0) {
+          grupo[j] = id_provisorio;
+          fila.push_back(j);
+        }
+      }
+    }
+    TipoNo tipo = folga[repr] >= folga_sala
+                      ? NO_SALA
+                      : (so_extremidade ? NO_EXTREMIDADE : NO_JUNCAO);
+    grafo.adicionarNo(repr % img.w, repr / img.w, tipo);
+  }
+
+  // 5. Cada componente conexa do esqueleto restante vira uma aresta entre os
+  // nós que ela toca.
+  std::vector<int> trecho(img.px.size(), -1);
+  int proximo_trecho = 0;
+  for (size_t semente = 0; semente < img.px.size(); ++semente) {
+    if (!img.px[semente] || e_no[semente] || trecho[semente] >= 0)
+      continue;
+    int id = proximo_trecho++;
+    std::vector<int> tocados;
+    float comprimento = 1.0f; // Ligação até o primeiro nó
+    trecho[semente] = id;
+    fila.assign(1, semente);
+    while (!fila.empty()) {
+      size_t i = fila.front();
+      fila.pop_front();
+      int x = i % img.w, y = i / img.w;
+      bool ortogonal = false;
+      for (int k = 0; k < 8; ++k) {
+        int nx = x + VIZ_X[k], ny = y + VIZ_Y[k];
+        if (nx < 0 || ny < 0 || nx >= img.w || ny >= img.h)
+          continue;
+        size_t j = (size_t)ny * img.w + nx;
+        if (!img.px[j])
+          continue;
+        if (k % 2 == 0)
+          ortogonal = true;
+        if (e_no[j]) {
+          if (std::find(tocados.begin(), tocados.end(), grupo[j]) ==
+              tocados.end())
+            tocados.push_back(grupo[j]);
+        } else if (trecho[j] < 0) {
+          trecho[j] = id;
+          fila.push_back(j);
+        }
+      }
+      // Passo diagonal conta sqrt(2); aproximação boa para linhas de 1 pixel
+      comprimento += ortogonal ? 1.0f : (float)M_SQRT2;
+    }
+    for (size_t k = 1; k < tocados.size(); ++k)
+      grafo.adicionarAresta(tocados[k - 1], tocados[k], comprimento);
+  }
+
+  return grafo;
+}
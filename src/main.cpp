@@ -5,10 +5,12 @@
 #include <thread>
 
 // Includes do Sistema
+#include "config_tarefas.h"
 #include "drivers/mqtt_driver.h" // Driver MQTT
 #include "eventos_sistema.h"
 #include "gerenciador_dados.h"
 #include "interface_caminhao.h" // Cockpit Integrado
+#include "utils/medidor_periodo.h"
 #include "utils/sleep_asynch.h"
 
 // Includes das Tasks
@@ -33,8 +35,12 @@ int main(int argc, char *argv[]) {
       std::cerr << "Invalid Truck ID argument. Defaulting to 0." << std::endl;
     }
   }
+  // Lei de controle: "mpc" como segundo argumento ativa o controle preditivo
+  ModoNavegacao modo_navegacao = NAV_PURE_PURSUIT;
+  if (argc > 2 && std::string(argv[2]) == "mpc")
+    modo_navegacao = NAV_MPC;
   std::cout << "[Main] Starting Controller for Truck ID: " << truck_id
-            << std::endl;
+            << (modo_navegacao == NAV_MPC ? " (MPC)" : "") << std::endl;
 
   // Redireciona logs para arquivo (NECESSARIO PARA COCKPIT EMBARCADO)
   std::ofstream logfile("controlador.log");
@@ -46,6 +52,11 @@ int main(int argc, char *argv[]) {
   // --- 1. SETUP INICIAL ---
   boost::asio::io_context io;
 
+  // Taxas das tarefas (Hz); arquivo ausente mantém os valores padrão
+  ConfigTarefas config = carregar_config_tarefas("tarefas.conf");
+  // Ganhos da navegação (bin/sintonia); arquivo ausente mantém os padrões
+  GanhosControle ganhos = carregar_ganhos_controle("ganhos.conf");
+
   // --- 2. INSTANCIAÇÃO DOS OBJETOS ---
   // 1. Instancia Objetos Compartilhados
   GerenciadorDados gerenciadorDados;
@@ -68,15 +79,20 @@ int main(int argc, char *argv[]) {
 
   // Thread 1: Tratamento de Sensores (Lê do MQTT)
   std::thread t1(task_tratamento_sensores, std::ref(gerenciadorDados),
-                 std::ref(mqtt_driver), 0);
+                 std::ref(mqtt_driver), truck_id,
+                 periodo_tarefa(config.sensores));
 
   // Thread 2: Lógica de Comando
   std::thread t2(task_logica_comando, std::ref(gerenciadorDados),
-                 std::ref(eventos));
+                 std::ref(eventos), periodo_tarefa(config.comando));
 
-  // Thread 3: Controle de Navegação
-  std::thread t_navegacao(task_controle_navegacao, std::ref(gerenciadorDados),
-                          std::ref(eventos));
+  // Thread 3: Controle de Navegação. Encadeada, roda a cada amostra do
+  // sensor (período nominal = o do sensor) e acorda a atuação
+  std::thread t_navegacao(
+      task_controle_navegacao, std::ref(gerenciadorDados), std::ref(eventos),
+      modo_navegacao,
+      periodo_tarefa(config.encadeado ? config.sensores : config.navegacao),
+      config.encadeado, ganhos);
 
   std::thread t_coletor(task_coletor_dados, std::ref(gerenciadorDados),
                         std::ref(eventos), truck_id);
@@ -84,31 +100,57 @@ int main(int argc, char *argv[]) {
   // 4. Aguardar as threads (embora elas rodem indefinidamente)o de Falhas (Atua
   // via MQTT se precisar parar)
   std::thread t3(task_monitoramento_falhas, std::ref(gerenciadorDados),
-                 std::ref(eventos), std::ref(mqtt_driver));
+                 std::ref(eventos), std::ref(mqtt_driver),
+                 periodo_tarefa(config.monitoramento));
 
   // Thread 5: Collision Avoidance System (CAS) - Alta Prioridade
   std::thread t_cas(task_collision_avoidance, std::ref(gerenciadorDados),
-                    std::ref(eventos), std::ref(mqtt_driver));
+                    std::ref(eventos), std::ref(mqtt_driver),
+                    periodo_tarefa(config.cas));
 
   // Thread 6: Planejamento de Rota (O General)
   std::thread t_rota(task_planejamento_rota, std::ref(gerenciadorDados),
-                     std::ref(mqtt_driver));
+                     std::ref(mqtt_driver),
+                     periodo_tarefa(config.planejamento));
 
   // Thread 5: Loop de Atuação (Envia comandos de controle para o MQTT)
   // Precisamos de uma task que pegue o comando do GerenciadorDados e envie para
   // o Driver Antes isso era feito no loop de simulação. Agora precisamos de um
   // loop dedicado de atuação.
-  std::thread t_atuacao([&gerenciadorDados, &mqtt_driver, &eventos]() {
+  auto periodo_atuacao = periodo_tarefa(config.atuacao);
+  bool encadeado = config.encadeado;
+  std::thread t_atuacao([&gerenciadorDados, &mqtt_driver, &eventos,
+                         periodo_atuacao, encadeado]() {
+    MedidorPeriodo relogio("ATUACAO");
+    MedidorLatencia latencia("SENSOR->ATUADOR");
+    uint64_t seq_enviado = 0;
     while (true) {
-      ComandosAtuador cmd = gerenciadorDados.getComandosAtuador();
+      relogio.acordou();
+      uint64_t seq;
+      bool com_amostra;
+      std::chrono::steady_clock::time_point instante_amostra;
+      ComandosAtuador cmd = gerenciadorDados.getComandosAtuador(
+          seq, com_amostra, instante_amostra);
       mqtt_driver.setAtuadores(cmd.aceleracao, cmd.direcao);
+      if (seq != seq_enviado) {
+        // Latência da amostra que originou o comando até o envio; comandos
+        // de falha e recuo não têm amostra e ficam fora da estatística
+        if (com_amostra)
+          latencia.registrar(instante_amostra);
+        seq_enviado = seq;
+      }
 
       // Sincroniza estado do sistema com o simulador/interface
       EstadoVeiculo estado = gerenciadorDados.getEstadoVeiculo();
       bool isFault = eventos.verificar_estado_falha();
       mqtt_driver.publishSystemState(estado.e_automatico == false, isFault);
 
-      std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 10Hz
+      if (encadeado)
+        // Envia assim que a navegação publica; no timeout, reenvia o último
+        // comando e o estado
+        gerenciadorDados.aguardarComandosAtuador(seq_enviado, periodo_atuacao);
+      else
+        std::this_thread::sleep_until(relogio.proximo(periodo_atuacao));
     }
   });
 
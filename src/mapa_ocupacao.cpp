@@ -0,0 +1,250 @@
+#include "mapa_ocupacao.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float INFINITO = std::numeric_limits<float>::infinity();
+
+// Pequeno avanço para que o ponto amostrado caia dentro da próxima célula
+// após cruzar uma fronteira.
+const float EPS_RAIO = 1e-4f;
+
+bool celula_parede(const std::vector<std::vector<char>> &mapa, int x, int y) {
+  if (y < 0 || y >= (int)mapa.size() || x < 0 || x >= (int)mapa[y].size())
+    return true;
+  return mapa[y][x] == '1';
+}
+
+} // namespace
+
+// --- MapaGrade ---
+
+MapaGrade::MapaGrade(const std::vector<std::vector<char>> &mapa)
+    : w(mapa.empty() ? 0 : mapa[0].size()), h(mapa.size()) {
+  celulas.resize((size_t)w * h);
+  for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w; ++x)
+      celulas[(size_t)y * w + x] = celula_parede(mapa, x, y) ? 1 : 0;
+}
+
+bool MapaGrade::ocupado(int gx, int gy) const {
+  if (gx < 0 || gx >= w || gy < 0 || gy >= h)
+    return true;
+  return celulas[(size_t)gy * w + gx] != 0;
+}
+
+bool MapaGrade::regiao_livre(int x0, int y0, int x1, int y1) const {
+  if (x0 > x1)
+    std::swap(x0, x1);
+  if (y0 > y1)
+    std::swap(y0, y1);
+  if (x0 < 0 || y0 < 0 || x1 >= w || y1 >= h)
+    return false;
+  for (int y = y0; y <= y1; ++y)
+    for (int x = x0; x <= x1; ++x)
+      if (celulas[(size_t)y * w + x])
+        return false;
+  return true;
+}
+
+float MapaGrade::raycast(float ox, float oy, float dx, float dy,
+                         float dist_max) const {
+  // DDA (Amanatides & Woo): avança exatamente uma fronteira de célula por vez.
+  int gx = static_cast<int>(std::floor(ox));
+  int gy = static_cast<int>(std::floor(oy));
+  if (ocupado(gx, gy))
+    return 0.0f;
+
+  int passo_x = dx > 0 ? 1 : -1;
+  int passo_y = dy > 0 ? 1 : -1;
+  float delta_x = dx != 0 ? 1.0f / std::abs(dx) : INFINITO;
+  float delta_y = dy != 0 ? 1.0f / std::abs(dy) : INFINITO;
+  float t_max_x =
+      dx != 0 ? (dx > 0 ? gx + 1 - ox : ox - gx) * delta_x : INFINITO;
+  float t_max_y =
+      dy != 0 ? (dy > 0 ? gy + 1 - oy : oy - gy) * delta_y : INFINITO;
+
+  while (true) {
+    float t = std::min(t_max_x, t_max_y);
+    if (t >= dist_max)
+      return dist_max;
+    if (t_max_x < t_max_y) {
+      gx += passo_x;
+      t_max_x += delta_x;
+    } else {
+      gy += passo_y;
+      t_max_y += delta_y;
+    }
+    if (ocupado(gx, gy))
+      return t;
+  }
+}
+
+// --- MapaQuadtree ---
+
+MapaQuadtree::MapaQuadtree(const std::vector<std::vector<char>> &mapa)
+    : w(mapa.empty() ? 0 : mapa[0].size()), h(mapa.size()), lado_raiz(1) {
+  while (lado_raiz < w || lado_raiz < h)
+    lado_raiz *= 2;
+  nos.push_back(No{OCUPADO, -1});
+  construir(mapa, 0, 0, 0, lado_raiz);
+}
+
+void MapaQuadtree::construir(const std::vector<std::vector<char>> &mapa,
+                             int idx, int x0, int y0, int lado) {
+  // Bloco inteiramente no preenchimento além do mapa: parede uniforme
+  if (x0 >= w || y0 >= h) {
+    nos[idx] = No{OCUPADO, -1};
+    return;
+  }
+  if (lado == 1) {
+    nos[idx] = No{(unsigned char)(celula_parede(mapa, x0, y0) ? OCUPADO : LIVRE),
+                  -1};
+    return;
+  }
+
+  // Filhos contíguos; cada subárvore é anexada depois dos 4 slots
+  int primeiro = nos.size();
+  nos.resize(primeiro + 4);
+  int m = lado / 2;
+  for (int q = 0; q < 4; ++q)
+    construir(mapa, primeiro + q, x0 + (q & 1 ? m : 0), y0 + (q & 2 ? m : 0),
+              m);
+
+  // Colapsa se os 4 filhos forem folhas com o mesmo estado. Nesse caso as
+  // subárvores dos filhos já foram descartadas e os 4 slots são os últimos.
+  bool uniforme = true;
+  for (int q = 0; q < 4; ++q) {
+    const No &f = nos[primeiro + q];
+    if (f.filhos >= 0 || f.estado != nos[primeiro].estado) {
+      uniforme = false;
+      break;
+    }
+  }
+  if (uniforme) {
+    unsigned char estado = nos[primeiro].estado;
+    nos.resize(primeiro);
+    nos[idx] = No{estado, -1};
+  } else {
+    nos[idx] = No{MISTO, primeiro};
+  }
+}
+
+unsigned char MapaQuadtree::folha(int gx, int gy, int &bx, int &by,
+                                  int &lado) const {
+  int idx = 0;
+  bx = 0;
+  by = 0;
+  lado = lado_raiz;
+  while (nos[idx].filhos >= 0) {
+    int m = lado / 2;
+    int q = 0;
+    if (gx >= bx + m) {
+      q |= 1;
+      bx += m;
+    }
+    if (gy >= by + m) {
+      q |= 2;
+      by += m;
+    }
+    idx = nos[idx].filhos + q;
+    lado = m;
+  }
+  return nos[idx].estado;
+}
+
+bool MapaQuadtree::ocupado(int gx, int gy) const {
+  if (gx < 0 || gx >= w || gy < 0 || gy >= h)
+    return true;
+  int bx, by, lado;
+  return folha(gx, gy, bx, by, lado) != LIVRE;
+}
+
+bool MapaQuadtree::regiao_livre_no(int idx, int nx, int ny, int lado, int x0,
+                                   int y0, int x1, int y1) const {
+  if (nx > x1 || ny > y1 || nx + lado <= x0 || ny + lado <= y0)
+    return true; // Sem interseção com a consulta
+  const No &no = nos[idx];
+  if (no.filhos < 0)
+    return no.estado == LIVRE; // Bloco inteiro resolvido de uma vez
+  int m = lado / 2;
+  for (int q = 0; q < 4; ++q) {
+    if (!regiao_livre_no(no.filhos + q, nx + (q & 1 ? m : 0),
+                         ny + (q & 2 ? m : 0), m, x0, y0, x1, y1))
+      return false;
+  }
+  return true;
+}
+
+bool MapaQuadtree::regiao_livre(int x0, int y0, int x1, int y1) const {
+  if (x0 > x1)
+    std::swap(x0, x1);
+  if (y0 > y1)
+    std::swap(y0, y1);
+  if (x0 < 0 || y0 < 0 || x1 >= w || y1 >= h)
+    return false;
+  return regiao_livre_no(0, 0, 0, lado_raiz, x0, y0, x1, y1);
+}
+
+float MapaQuadtree::raycast(float ox, float oy, float dx, float dy,
+                            float dist_max) const {
+  float t = 0.0f;
+  while (t < dist_max) {
+    int gx = static_cast<int>(std::floor(ox + dx * t));
+    int gy = static_cast<int>(std::floor(oy + dy * t));
+    if (gx < 0 || gx >= w || gy < 0 || gy >= h)
+      return t; // Borda do mundo
+
+    int bx, by, lado;
+    if (folha(gx, gy, bx, by, lado) != LIVRE)
+      return t;
+
+    // Folha livre: salta direto para a saída da caixa
+    float tx = dx > 0 ? (bx + lado - ox) / dx
+                      : (dx < 0 ? (bx - ox) / dx : INFINITO);
+    float ty = dy > 0 ? (by + lado - oy) / dy
+                      : (dy < 0 ? (by - oy) / dy : INFINITO);
+    float t_saida = std::max(t, std::min(tx, ty));
+
+    // Saída exatamente por um canto: como no DDA, o raio não atravessa a
+    // fresta diagonal entre duas paredes que se tocam no vértice.
+    if (std::abs(tx - ty) < EPS_RAIO) {
+      int cx = static_cast<int>(std::floor(ox + dx * (t_saida + EPS_RAIO)));
+      int cy = static_cast<int>(std::floor(oy + dy * (t_saida + EPS_RAIO)));
+      int sx = dx > 0 ? 1 : -1;
+      int sy = dy > 0 ? 1 : -1;
+      if (ocupado(cx - sx, cy) || ocupado(cx, cy - sy))
+        return t_saida;
+    }
+    t = t_saida + EPS_RAIO;
+  }
+  return dist_max;
+}
+
+// --- Seleção de backend ---
+
+std::unique_ptr<IMapaOcupacao>
+criar_mapa_ocupacao(const std::vector<std::vector<char>> &mapa,
+                    float limiar_fronteira) {
+  if (mapa.empty() || mapa[0].empty())
+    return std::unique_ptr<IMapaOcupacao>(new MapaGrade(mapa));
+
+  int h = mapa.size();
+  int w = mapa[0].size();
+  long fronteiras = 0;
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      bool parede = celula_parede(mapa, x, y);
+      if ((x + 1 < w && celula_parede(mapa, x + 1, y) != parede) ||
+          (y + 1 < h && celula_parede(mapa, x, y + 1) != parede))
+        ++fronteiras;
+    }
+  }
+
+  float densidade = (float)fronteiras / ((float)w * h);
+  if (densidade < limiar_fronteira)
+    return std::unique_ptr<IMapaOcupacao>(new MapaQuadtree(mapa));
+  return std::unique_ptr<IMapaOcupacao>(new MapaGrade(mapa));
+}
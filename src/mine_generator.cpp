@@ -1,7 +1,9 @@
 #include "mine_generator.h"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <random>
+#include <utility>
 
 MineGenerator::MineGenerator(int width, int height)
     : width(width), height(height), rng(std::random_device{}()) {
@@ -16,6 +18,9 @@ MineGenerator::MineGenerator(int width, int height)
 
   // Inicializa tudo como parede ('1')
   minefield.resize(this->height, std::vector<char>(this->width, '1'));
+
+  // Uma entrada por célula ímpar (nós do labirinto)
+  arvoreLabirinto.resize(((this->width - 1) / 2) * ((this->height - 1) / 2));
 }
 
 void MineGenerator::generate() {
@@ -39,6 +44,9 @@ void MineGenerator::generate() {
   // Start no centro da sala 15x15 (8,8)
   minefield[8][8] = 'A';
   minefield[lastY][lastX] = 'B';
+
+  // 6. Emite o grafo topológico com o que já se sabe da escavação
+  construirGrafo();
 }
 
 void MineGenerator::createStartRoom() {
@@ -49,6 +57,9 @@ void MineGenerator::createStartRoom() {
       minefield[y][x] = '0';
     }
   }
+  int larguraSala = std::min(15, width - 2);
+  int alturaSala = std::min(15, height - 2);
+  salas.insert(salas.begin(), Sala{1, 1, larguraSala, alturaSala});
 }
 
 void MineGenerator::addRooms(int numRooms) {
@@ -58,6 +69,8 @@ void MineGenerator::addRooms(int numRooms) {
   for (int i = 0; i < numRooms; ++i) {
     int rx = distX(rng);
     int ry = distY(rng);
+    salas.push_back(Sala{rx, ry, std::min(10, width - 1 - rx),
+                         std::min(10, height - 1 - ry)});
 
     // Cria uma sala 10x10 (antes era 5x5)
     for (int y = ry; y < ry + 10; ++y) {
@@ -123,6 +136,12 @@ void MineGenerator::recursiveBacktracker(int x, int y) {
       // A parede está na metade do caminho (dir[0]/2, dir[1]/2)
       minefield[y + dir[1] / 2][x + dir[0] / 2] = '0';
 
+      // Registra a ligação na árvore do labirinto
+      int a = indiceLabirinto(x, y);
+      int b = indiceLabirinto(nx, ny);
+      arvoreLabirinto[a].push_back(b);
+      arvoreLabirinto[b].push_back(a);
+
       // Chama recursivamente para a próxima célula
       recursiveBacktracker(nx, ny);
     }
@@ -159,3 +178,114 @@ void MineGenerator::print() {
 const std::vector<std::vector<char>> &MineGenerator::getMinefield() const {
   return minefield;
 }
+
+const GrafoTuneis &MineGenerator::getGrafo() const { return grafo; }
+
+int MineGenerator::indiceLabirinto(int x, int y) const {
+  return ((y - 1) / 2) * ((width - 1) / 2) + (x - 1) / 2;
+}
+
+void MineGenerator::construirGrafo() {
+  grafo.limpar();
+
+  // Vértices contraídos: cada sala vira um único vértice [0, nSalas) e as
+  // células do labirinto fora de salas ficam em [nSalas, nSalas + nCelulas).
+  int larguraLab = (width - 1) / 2;
+  int nSalas = salas.size();
+  int nCelulas = arvoreLabirinto.size();
+  int nVertices = nSalas + nCelulas;
+
+  std::vector<int> px(nVertices), py(nVertices);
+  for (int s = 0; s < nSalas; ++s) {
+    px[s] = salas[s].x + salas[s].largura / 2;
+    py[s] = salas[s].y + salas[s].altura / 2;
+  }
+
+  std::vector<int> representante(nCelulas);
+  for (int c = 0; c < nCelulas; ++c) {
+    int x = 1 + 2 * (c % larguraLab);
+    int y = 1 + 2 * (c / larguraLab);
+    px[nSalas + c] = x;
+    py[nSalas + c] = y;
+    representante[c] = nSalas + c;
+    for (int s = 0; s < nSalas; ++s) {
+      const Sala &sala = salas[s];
+      if (x >= sala.x && x < sala.x + sala.largura && y >= sala.y &&
+          y < sala.y + sala.altura) {
+        representante[c] = s;
+        break;
+      }
+    }
+  }
+
+  std::vector<std::vector<std::pair<int, float>>> adj(nVertices);
+  auto ligar = [&](int u, int v) {
+    if (u == v)
+      return;
+    for (const auto &e : adj[u])
+      if (e.first == v)
+        return; // Já ligados (várias células da mesma sala)
+    float dx = px[u] - px[v];
+    float dy = py[u] - py[v];
+    float comprimento = std::sqrt(dx * dx + dy * dy);
+    adj[u].push_back(std::make_pair(v, comprimento));
+    adj[v].push_back(std::make_pair(u, comprimento));
+  };
+
+  for (int c = 0; c < nCelulas; ++c)
+    for (int n : arvoreLabirinto[c])
+      if (n > c)
+        ligar(representante[c], representante[n]);
+
+  // Salas sobrepostas ou encostadas formam uma área aberta contínua
+  for (int a = 0; a < nSalas; ++a) {
+    for (int b = a + 1; b < nSalas; ++b) {
+      const Sala &sa = salas[a];
+      const Sala &sb = salas[b];
+      if (sa.x <= sb.x + sb.largura && sb.x <= sa.x + sa.largura &&
+          sa.y <= sb.y + sb.altura && sb.y <= sa.y + sa.altura)
+        ligar(a, b);
+    }
+  }
+
+  // Nós do grafo: salas, junções (grau >= 3), extremidades (grau 1) e o 'B'
+  int verticeFim = representante[indiceLabirinto(lastX, lastY)];
+  std::vector<int> idNo(nVertices, -1);
+  for (int v = 0; v < nVertices; ++v) {
+    int grau = adj[v].size();
+    if (v < nSalas) {
+      idNo[v] = grafo.adicionarNo(px[v], py[v], NO_SALA);
+    } else if (grau >= 3) {
+      idNo[v] = grafo.adicionarNo(px[v], py[v], NO_JUNCAO);
+    } else if (grau == 1 || (grau > 0 && v == verticeFim)) {
+      idNo[v] = grafo.adicionarNo(px[v], py[v], NO_EXTREMIDADE);
+    }
+  }
+
+  // Cada cadeia de vértices de grau 2 vira uma única aresta (segmento)
+  std::vector<char> percorrido(nVertices, 0);
+  for (int u = 0; u < nVertices; ++u) {
+    if (idNo[u] < 0)
+      continue;
+    for (const auto &inicio : adj[u]) {
+      int anterior = u;
+      int atual = inicio.first;
+      float total = inicio.second;
+      if (idNo[atual] >= 0 && atual < u)
+        continue; // Aresta direta já emitida pelo outro lado
+      if (idNo[atual] < 0 && percorrido[atual])
+        continue; // Cadeia já emitida pelo outro lado
+
+      while (idNo[atual] < 0) {
+        percorrido[atual] = 1;
+        const auto &viz = adj[atual];
+        const auto &prox = viz[0].first == anterior ? viz[1] : viz[0];
+        total += prox.second;
+        anterior = atual;
+        atual = prox.first;
+      }
+      if (atual != u)
+        grafo.adicionarAresta(idNo[u], idNo[atual], total);
+    }
+  }
+}
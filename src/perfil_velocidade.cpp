@@ -0,0 +1,237 @@
+#include "perfil_velocidade.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Distância a partir da qual a busca incremental é descartada
+const float DIST_MAX_JANELA = 15.0f;
+
+float distancia(float x0, float y0, float x1, float y1) {
+  return std::sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
+}
+
+} // namespace
+
+PerfilVelocidade::PerfilVelocidade() {
+  amostras_.reserve(AMOSTRAS_RESERVADAS);
+  poligonal_.reserve(CAPACIDADE_ROTA + 1);
+}
+
+void PerfilVelocidade::adicionar(float x, float y, float v_max) {
+  if (!amostras_.empty()) {
+    AmostraPerfil &u = amostras_.back();
+    float ds = distancia(u.x, u.y, x, y);
+    if (ds < 1e-4f) {
+      u.velocidade = std::min(u.velocidade, v_max);
+      return;
+    }
+    amostras_.push_back({x, y, u.s + ds, 0.0f, v_max});
+  } else {
+    amostras_.push_back({x, y, 0.0f, 0.0f, v_max});
+  }
+}
+
+void PerfilVelocidade::amostrarReta(float x0, float y0, float x1, float y1,
+                                    float v_max) {
+  int n = (int)std::ceil(distancia(x0, y0, x1, y1) / PASSO_PERFIL);
+  for (int k = 1; k <= n; ++k) {
+    float t = (float)k / n;
+    adicionar(x0 + (x1 - x0) * t, y0 + (y1 - y0) * t, v_max);
+  }
+}
+
+void PerfilVelocidade::amostrarCanto(float x0, float y0, float cx, float cy,
+                                     float x1, float y1, float v_max) {
+  // B(t) = (1-t)² P0 + 2t(1-t) C + t² P1; curvatura |B' x B''| / |B'|³
+  float comprimento = distancia(x0, y0, cx, cy) + distancia(cx, cy, x1, y1);
+  int n = std::max(2, (int)std::ceil(comprimento / PASSO_PERFIL));
+  float ddx = 2.0f * (x0 - 2.0f * cx + x1);
+  float ddy = 2.0f * (y0 - 2.0f * cy + y1);
+  for (int k = 1; k <= n; ++k) {
+    float t = (float)k / n, u = 1.0f - t;
+    float dx = 2.0f * (u * (cx - x0) + t * (x1 - cx));
+    float dy = 2.0f * (u * (cy - y0) + t * (y1 - cy));
+    float norma = std::sqrt(dx * dx + dy * dy);
+    adicionar(u * u * x0 + 2.0f * t * u * cx + t * t * x1,
+              u * u * y0 + 2.0f * t * u * cy + t * t * y1, v_max);
+    if (norma > 1e-6f)
+      amostras_.back().curvatura =
+          std::abs(dx * ddy - dy * ddx) / (norma * norma * norma);
+  }
+}
+
+void PerfilVelocidade::construir(float x0, float y0, float v0,
+                                 const Rota &rota,
+                                 bool parar_no_fim) {
+  amostras_.clear();
+  if (rota.empty())
+    return;
+
+  // Poligonal: posição atual + waypoints, sem pontos repetidos
+  std::vector<Point> &p = poligonal_;
+  p.assign(1, Point{x0, y0, rota.front().speed});
+  for (const Point &w : rota)
+    if (distancia(p.back().x, p.back().y, w.x, w.y) > 1e-3f)
+      p.push_back(w);
+
+  adicionar(p[0].x, p[0].y, p[0].speed);
+  float ax = p[0].x, ay = p[0].y;
+  for (size_t i = 1; i < p.size(); ++i) {
+    if (i + 1 == p.size()) {
+      amostrarReta(ax, ay, p[i].x, p[i].y, p[i].speed);
+      break;
+    }
+    // Recuo do arco: no máximo metade de cada trecho, para não sobrepor o
+    // canto vizinho
+    float l_in = distancia(p[i - 1].x, p[i - 1].y, p[i].x, p[i].y);
+    float l_out = distancia(p[i].x, p[i].y, p[i + 1].x, p[i + 1].y);
+    float d = std::min(CORTE_CANTO_MAX, 0.5f * std::min(l_in, l_out));
+    float ex = p[i].x - d * (p[i].x - p[i - 1].x) / l_in;
+    float ey = p[i].y - d * (p[i].y - p[i - 1].y) / l_in;
+    float sx = p[i].x + d * (p[i + 1].x - p[i].x) / l_out;
+    float sy = p[i].y + d * (p[i + 1].y - p[i].y) / l_out;
+    amostrarReta(ax, ay, ex, ey, p[i].speed);
+    amostrarCanto(ex, ey, p[i].x, p[i].y, sx, sy,
+                  std::min(p[i].speed, p[i + 1].speed));
+    ax = sx;
+    ay = sy;
+  }
+
+  // Limite por curvatura: aceleração lateral e taxa de giro
+  for (AmostraPerfil &a : amostras_) {
+    if (a.curvatura > 1e-6f)
+      a.velocidade =
+          std::min(a.velocidade,
+                   std::min(std::sqrt(ACEL_LATERAL_MAX / a.curvatura),
+                            TAXA_GIRO_MAX / a.curvatura));
+    a.velocidade = std::max(a.velocidade, 0.0f);
+  }
+
+  // Passada para a frente (aceleração) e para trás (frenagem)
+  size_t n = amostras_.size();
+  amostras_[0].velocidade = std::min(amostras_[0].velocidade,
+                                     std::max(v0, 0.0f));
+  for (size_t i = 1; i < n; ++i) {
+    float ds = amostras_[i].s - amostras_[i - 1].s;
+    float v = amostras_[i - 1].velocidade;
+    amostras_[i].velocidade =
+        std::min(amostras_[i].velocidade,
+                 std::sqrt(v * v + 2.0f * ACEL_MAX_PERFIL * ds));
+  }
+  if (parar_no_fim)
+    amostras_[n - 1].velocidade = 0.0f;
+  for (size_t i = n - 1; i-- > 0;) {
+    float ds = amostras_[i + 1].s - amostras_[i].s;
+    float v = amostras_[i + 1].velocidade;
+    amostras_[i].velocidade =
+        std::min(amostras_[i].velocidade,
+                 std::sqrt(v * v + 2.0f * FRENAGEM_MAX_PERFIL * ds));
+  }
+}
+
+float PerfilVelocidade::velocidadeEm(float s) const {
+  if (amostras_.empty())
+    return 0.0f;
+  if (s <= 0.0f)
+    return amostras_.front().velocidade;
+  if (s >= amostras_.back().s)
+    return amostras_.back().velocidade;
+  auto it = std::upper_bound(
+      amostras_.begin(), amostras_.end(), s,
+      [](float v, const AmostraPerfil &a) { return v < a.s; });
+  const AmostraPerfil &b = *it;
+  const AmostraPerfil &a = *(it - 1);
+  float t = (s - a.s) / (b.s - a.s);
+  return a.velocidade + (b.velocidade - a.velocidade) * t;
+}
+
+size_t PerfilVelocidade::trechoEm(float s, size_t &dica) const {
+  // Trecho [i, i+1] com amostras_[i].s <= s < amostras_[i+1].s
+  size_t n = amostras_.size();
+  size_t i = std::min(dica, n - 2);
+  while (i + 2 < n && amostras_[i + 1].s <= s)
+    ++i;
+  while (i > 0 && amostras_[i].s > s)
+    --i;
+  dica = i;
+  return i;
+}
+
+float PerfilVelocidade::velocidadeEm(float s, size_t &dica) const {
+  if (amostras_.size() < 2)
+    return amostras_.empty() ? 0.0f : amostras_[0].velocidade;
+  const AmostraPerfil &a = amostras_[trechoEm(s, dica)];
+  const AmostraPerfil &b = amostras_[dica + 1];
+  float t = std::max(0.0f, std::min(1.0f, (s - a.s) / (b.s - a.s)));
+  return a.velocidade + (b.velocidade - a.velocidade) * t;
+}
+
+void PerfilVelocidade::pontoEm(float s, size_t &dica, float &x,
+                               float &y) const {
+  if (amostras_.size() < 2) {
+    x = amostras_.empty() ? 0.0f : amostras_[0].x;
+    y = amostras_.empty() ? 0.0f : amostras_[0].y;
+    return;
+  }
+  const AmostraPerfil &a = amostras_[trechoEm(s, dica)];
+  const AmostraPerfil &b = amostras_[dica + 1];
+  float t = std::max(0.0f, std::min(1.0f, (s - a.s) / (b.s - a.s)));
+  x = a.x + (b.x - a.x) * t;
+  y = a.y + (b.y - a.y) * t;
+}
+
+float PerfilVelocidade::localizar(float x, float y, size_t &dica) const {
+  size_t n = amostras_.size();
+  if (n == 0)
+    return 0.0f;
+
+  auto dist2 = [&](size_t i) {
+    float dx = amostras_[i].x - x, dy = amostras_[i].y - y;
+    return dx * dx + dy * dy;
+  };
+
+  // Desce a distância a partir da dica; as amostras são densas (PASSO_PERFIL)
+  // e o veículo anda poucas delas por ciclo
+  size_t i = std::min(dica, n - 1);
+  float d2 = dist2(i);
+  while (i + 1 < n && dist2(i + 1) < d2)
+    d2 = dist2(++i);
+  while (i > 0 && dist2(i - 1) < d2)
+    d2 = dist2(--i);
+  if (d2 > DIST_MAX_JANELA * DIST_MAX_JANELA) {
+    for (size_t k = 0; k < n; ++k) {
+      if (dist2(k) < d2) {
+        d2 = dist2(k);
+        i = k;
+      }
+    }
+  }
+  dica = i;
+
+  // Projeta no trecho [i, i+1], ou em [i-1, i] se o veículo ainda não
+  // passou da amostra
+  size_t a = i, b = i + 1;
+  if (b >= n) {
+    if (i == 0)
+      return 0.0f;
+    a = i - 1;
+    b = i;
+  } else if (i > 0) {
+    float px = x - amostras_[i].x, py = y - amostras_[i].y;
+    if (px * (amostras_[b].x - amostras_[a].x) +
+            py * (amostras_[b].y - amostras_[a].y) <
+        0.0f) {
+      a = i - 1;
+      b = i;
+    }
+  }
+  float sx = amostras_[b].x - amostras_[a].x;
+  float sy = amostras_[b].y - amostras_[a].y;
+  float l2 = sx * sx + sy * sy;
+  float t = l2 > 0.0f
+                ? ((x - amostras_[a].x) * sx + (y - amostras_[a].y) * sy) / l2
+                : 0.0f;
+  t = std::max(0.0f, std::min(1.0f, t));
+  return amostras_[a].s + (amostras_[b].s - amostras_[a].s) * t;
+}
@@ -0,0 +1,425 @@
+#include "planejador_hierarquico.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+const float SQRT2 = 1.41421356f;
+
+// Trechos de fronteira a partir deste comprimento ganham duas entradas
+const int TRECHO_LONGO = 6;
+
+float octil(int x0, int y0, int x1, int y1) {
+  int dx = std::abs(x1 - x0);
+  int dy = std::abs(y1 - y0);
+  return (dx + dy) + (SQRT2 - 2.0f) * std::min(dx, dy);
+}
+
+uint64_t chave(int a, int b) {
+  return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+} // namespace
+
+// --- BuscaLocal ---
+
+BuscaLocal::BuscaLocal(const GradeNavegacao &grade)
+    : grade(grade), rx0(0), ry0(0), rw(0), rh(0), geracao(0) {}
+
+void BuscaLocal::preparar(int x0, int y0, int x1, int y1) {
+  rx0 = std::max(0, x0);
+  ry0 = std::max(0, y0);
+  rw = std::min(grade.largura() - 1, x1) - rx0 + 1;
+  rh = std::min(grade.altura() - 1, y1) - ry0 + 1;
+  size_t n = (size_t)rw * rh;
+  if (g.size() < n) {
+    g.resize(n);
+    pai.resize(n);
+    marca.assign(n, 0);
+    geracao = 0;
+  }
+  if (++geracao == 0) { // Estouro do contador: zera as marcas
+    std::fill(marca.begin(), marca.end(), 0);
+    geracao = 1;
+  }
+  aberta.clear();
+}
+
+float BuscaLocal::buscar(const Celula &origem, const Celula *destino) {
+  if (origem.x < rx0 || origem.y < ry0 || origem.x >= rx0 + rw ||
+      origem.y >= ry0 + rh || !grade.livre(origem.x, origem.y))
+    return -1.0f;
+
+  int i0 = (origem.y - ry0) * rw + (origem.x - rx0);
+  g[i0] = 0.0f;
+  pai[i0] = -1;
+  marca[i0] = geracao;
+  float h0 = destino ? octil(origem.x, origem.y, destino->x, destino->y) : 0;
+  aberta.push_back({h0, i0});
+
+  while (!aberta.empty()) {
+    std::pop_heap(aberta.begin(), aberta.end());
+    Entrada e = aberta.back();
+    aberta.pop_back();
+    int x = rx0 + e.idx % rw;
+    int y = ry0 + e.idx / rw;
+    float gi = g[e.idx];
+    float h = destino ? octil(x, y, destino->x, destino->y) : 0;
+    if (e.f > gi + h + 1e-4f)
+      continue; // Entrada obsoleta
+    if (destino && x == destino->x && y == destino->y)
+      return gi;
+
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        if (dx == 0 && dy == 0)
+          continue;
+        int nx = x + dx, ny = y + dy;
+        if (nx < rx0 || ny < ry0 || nx >= rx0 + rw || ny >= ry0 + rh ||
+            !grade.livre(nx, ny))
+          continue;
+        if (dx != 0 && dy != 0 &&
+            (!grade.livre(x + dx, y) || !grade.livre(x, y + dy)))
+          continue;
+        int j = (ny - ry0) * rw + (nx - rx0);
+        float ng = gi + (dx != 0 && dy != 0 ? SQRT2 : 1.0f);
+        if (marca[j] == geracao && ng >= g[j])
+          continue;
+        marca[j] = geracao;
+        g[j] = ng;
+        pai[j] = e.idx;
+        float hj = destino ? octil(nx, ny, destino->x, destino->y) : 0;
+        aberta.push_back({ng + hj, j});
+        std::push_heap(aberta.begin(), aberta.end());
+      }
+    }
+  }
+  return -1.0f;
+}
+
+void BuscaLocal::custos(const Celula &origem, int x0, int y0, int x1, int y1,
+                        const std::vector<Celula> &alvos,
+                        std::vector<float> &saida) {
+  preparar(x0, y0, x1, y1);
+  buscar(origem, nullptr);
+  saida.clear();
+  for (const Celula &a : alvos) {
+    if (a.x < rx0 || a.y < ry0 || a.x >= rx0 + rw || a.y >= ry0 + rh) {
+      saida.push_back(-1.0f);
+      continue;
+    }
+    int j = (a.y - ry0) * rw + (a.x - rx0);
+    saida.push_back(marca[j] == geracao ? g[j] : -1.0f);
+  }
+}
+
+float BuscaLocal::caminho(const Celula &origem, const Celula &destino, int x0,
+                          int y0, int x1, int y1, std::vector<Celula> &saida) {
+  preparar(x0, y0, x1, y1);
+  float custo = buscar(origem, &destino);
+  saida.clear();
+  if (custo < 0)
+    return custo;
+  for (int i = (destino.y - ry0) * rw + (destino.x - rx0); i >= 0; i = pai[i])
+    saida.push_back(Celula{rx0 + i % rw, ry0 + i / rw});
+  std::reverse(saida.begin(), saida.end());
+  return custo;
+}
+
+// --- PlanejadorHPA ---
+
+PlanejadorHPA::PlanejadorHPA(const GradeNavegacao &grade)
+    : grade(grade), lado(TAMANHO_CLUSTER_PADRAO), clusters_x(0),
+      clusters_y(0), num_arestas(0), local(grade), geracao(0) {}
+
+void PlanejadorHPA::limitesCluster(int c, int &x0, int &y0, int &x1,
+                                   int &y1) const {
+  x0 = (c % clusters_x) * lado;
+  y0 = (c / clusters_x) * lado;
+  x1 = std::min(x0 + lado, grade.largura()) - 1;
+  y1 = std::min(y0 + lado, grade.altura()) - 1;
+}
+
+int PlanejadorHPA::obterNo(const Celula &c) {
+  int idx = c.y * grade.largura() + c.x;
+  auto it = no_da_celula.find(idx);
+  if (it != no_da_celula.end())
+    return it->second;
+  int id = nos.size();
+  int cl = cluster(c.x, c.y);
+  nos.push_back(NoAbstrato{c, cl});
+  adjacencia.emplace_back();
+  nos_cluster[cl].push_back(id);
+  no_da_celula[idx] = id;
+  return id;
+}
+
+void PlanejadorHPA::adicionarAresta(int a, int b, float custo) {
+  adjacencia[a].push_back(Aresta{b, custo});
+  adjacencia[b].push_back(Aresta{a, custo});
+  ++num_arestas;
+}
+
+void PlanejadorHPA::criarEntradas(int ca, int cb, bool horizontal) {
+  int x0, y0, x1, y1;
+  limitesCluster(ca, x0, y0, x1, y1);
+
+  // Percorre a fronteira: em "horizontal" os clusters estão lado a lado e a
+  // fronteira é a coluna x1 | x1+1; caso contrário é a linha y1 | y1+1.
+  int n = horizontal ? y1 - y0 + 1 : x1 - x0 + 1;
+  auto celula_a = [&](int t) {
+    return horizontal ? Celula{x1, y0 + t} : Celula{x0 + t, y1};
+  };
+  auto celula_b = [&](int t) {
+    return horizontal ? Celula{x1 + 1, y0 + t} : Celula{x0 + t, y1 + 1};
+  };
+  auto livre = [&](int t) {
+    Celula a = celula_a(t), b = celula_b(t);
+    return grade.livre(a.x, a.y) && grade.livre(b.x, b.y);
+  };
+  auto ligar = [&](int t) {
+    adicionarAresta(obterNo(celula_a(t)), obterNo(celula_b(t)), 1.0f);
+  };
+
+  int t = 0;
+  while (t < n) {
+    if (!livre(t)) {
+      ++t;
+      continue;
+    }
+    int inicio = t;
+    while (t < n && livre(t))
+      ++t;
+    int fim = t - 1;
+    if (fim - inicio + 1 < TRECHO_LONGO) {
+      ligar((inicio + fim) / 2);
+    } else {
+      ligar(inicio);
+      ligar(fim);
+    }
+  }
+}
+
+void PlanejadorHPA::ligarIntraCluster(int c) {
+  int x0, y0, x1, y1;
+  limitesCluster(c, x0, y0, x1, y1);
+  const std::vector<int> &ids = nos_cluster[c];
+  std::vector<Celula> alvos;
+  std::vector<float> custos;
+  for (size_t i = 0; i + 1 < ids.size(); ++i) {
+    alvos.clear();
+    for (size_t j = i + 1; j < ids.size(); ++j)
+      alvos.push_back(nos[ids[j]].c);
+    local.custos(nos[ids[i]].c, x0, y0, x1, y1, alvos, custos);
+    for (size_t j = i + 1; j < ids.size(); ++j)
+      if (custos[j - i - 1] >= 0)
+        adicionarAresta(ids[i], ids[j], custos[j - i - 1]);
+  }
+}
+
+void PlanejadorHPA::construir(int tamanho_cluster,
+                              const std::atomic<bool> *cancelar) {
+  lado = std::max(4, tamanho_cluster);
+  nos.clear();
+  adjacencia.clear();
+  no_da_celula.clear();
+  cache.clear();
+  num_arestas = 0;
+  if (grade.vazia()) {
+    nos_cluster.clear();
+    return;
+  }
+
+  clusters_x = (grade.largura() + lado - 1) / lado;
+  clusters_y = (grade.altura() + lado - 1) / lado;
+  nos_cluster.assign((size_t)clusters_x * clusters_y, std::vector<int>());
+
+  for (int cy = 0; cy < clusters_y; ++cy) {
+    if (cancelar && cancelar->load(std::memory_order_relaxed))
+      return;
+    for (int cx = 0; cx < clusters_x; ++cx) {
+      int c = cy * clusters_x + cx;
+      if (cx + 1 < clusters_x)
+        criarEntradas(c, c + 1, true);
+      if (cy + 1 < clusters_y)
+        criarEntradas(c, c + clusters_x, false);
+    }
+  }
+  for (size_t c = 0; c < nos_cluster.size(); ++c) {
+    if (cancelar && cancelar->load(std::memory_order_relaxed))
+      return;
+    ligarIntraCluster(c);
+  }
+
+  g.assign(nos.size() + 2, 0.0f);
+  pai.assign(nos.size() + 2, -1);
+  marca.assign(nos.size() + 2, 0);
+  geracao = 0;
+}
+
+int PlanejadorHPA::inserirTemporario(const Celula &c) {
+  auto it = no_da_celula.find(c.y * grade.largura() + c.x);
+  if (it != no_da_celula.end())
+    return it->second; // Já é uma entrada de cluster
+
+  int id = nos.size();
+  int cl = cluster(c.x, c.y);
+  nos.push_back(NoAbstrato{c, cl});
+  adjacencia.emplace_back();
+
+  int x0, y0, x1, y1;
+  limitesCluster(cl, x0, y0, x1, y1);
+  std::vector<Celula> alvos;
+  for (int n : nos_cluster[cl])
+    alvos.push_back(nos[n].c);
+  std::vector<float> custos;
+  local.custos(c, x0, y0, x1, y1, alvos, custos);
+  for (size_t k = 0; k < custos.size(); ++k)
+    if (custos[k] >= 0)
+      adicionarAresta(id, nos_cluster[cl][k], custos[k]);
+  return id;
+}
+
+void PlanejadorHPA::removerTemporarios(size_t n_original) {
+  // As arestas dos nós temporários foram as últimas inseridas em cada lista
+  for (size_t t = n_original; t < nos.size(); ++t) {
+    for (const Aresta &a : adjacencia[t]) {
+      if ((size_t)a.destino >= n_original)
+        continue;
+      std::vector<Aresta> &adj = adjacencia[a.destino];
+      while (!adj.empty() && (size_t)adj.back().destino >= n_original) {
+        adj.pop_back();
+        --num_arestas;
+      }
+    }
+  }
+  // Aresta direta entre início e objetivo temporários
+  if (nos.size() == n_original + 2)
+    for (const Aresta &a : adjacencia[n_original])
+      if ((size_t)a.destino > n_original)
+        --num_arestas;
+  nos.resize(n_original);
+  adjacencia.resize(n_original);
+}
+
+bool PlanejadorHPA::planejar(const Celula &inicio, const Celula &objetivo,
+                             CaminhoAbstrato &caminho) {
+  caminho.limpar();
+  if (!construido() || !grade.livre(inicio.x, inicio.y) ||
+      !grade.livre(objetivo.x, objetivo.y))
+    return false;
+  if (inicio.x == objetivo.x && inicio.y == objetivo.y) {
+    caminho.pontos.push_back(inicio);
+    caminho.nos.push_back(-1);
+    return true;
+  }
+
+  size_t n_original = nos.size();
+  int s = inserirTemporario(inicio);
+  int t = inserirTemporario(objetivo);
+
+  // Mesmo cluster: o caminho direto pode não passar por nenhuma entrada
+  if (s != t && (size_t)s >= n_original && (size_t)t >= n_original &&
+      nos[s].cluster == nos[t].cluster) {
+    int x0, y0, x1, y1;
+    limitesCluster(nos[s].cluster, x0, y0, x1, y1);
+    std::vector<float> custos;
+    local.custos(inicio, x0, y0, x1, y1, std::vector<Celula>(1, objetivo),
+                 custos);
+    if (custos[0] >= 0)
+      adicionarAresta(s, t, custos[0]);
+  }
+
+  if (g.size() < nos.size()) {
+    g.resize(nos.size());
+    pai.resize(nos.size());
+    marca.resize(nos.size(), 0);
+  }
+  if (++geracao == 0) {
+    std::fill(marca.begin(), marca.end(), 0);
+    geracao = 1;
+  }
+
+  const Celula &alvo = nos[t].c;
+  aberta.clear();
+  g[s] = 0.0f;
+  pai[s] = -1;
+  marca[s] = geracao;
+  aberta.push_back({octil(inicio.x, inicio.y, alvo.x, alvo.y), s});
+  bool achou = false;
+  while (!aberta.empty()) {
+    std::pop_heap(aberta.begin(), aberta.end());
+    EntradaAberta e = aberta.back();
+    aberta.pop_back();
+    const Celula &c = nos[e.no].c;
+    if (e.f > g[e.no] + octil(c.x, c.y, alvo.x, alvo.y) + 1e-4f)
+      continue;
+    if (e.no == t) {
+      achou = true;
+      break;
+    }
+    for (const Aresta &a : adjacencia[e.no]) {
+      float ng = g[e.no] + a.custo;
+      if (marca[a.destino] == geracao && ng >= g[a.destino])
+        continue;
+      marca[a.destino] = geracao;
+      g[a.destino] = ng;
+      pai[a.destino] = e.no;
+      const Celula &d = nos[a.destino].c;
+      aberta.push_back({ng + octil(d.x, d.y, alvo.x, alvo.y), a.destino});
+      std::push_heap(aberta.begin(), aberta.end());
+    }
+  }
+
+  if (achou) {
+    for (int n = t; n >= 0; n = pai[n]) {
+      caminho.pontos.push_back(nos[n].c);
+      caminho.nos.push_back((size_t)n < n_original ? n : -1);
+    }
+    std::reverse(caminho.pontos.begin(), caminho.pontos.end());
+    std::reverse(caminho.nos.begin(), caminho.nos.end());
+  }
+  removerTemporarios(n_original);
+  return achou;
+}
+
+bool PlanejadorHPA::refinar(CaminhoAbstrato &caminho, size_t trechos,
+                            std::vector<Celula> &saida) {
+  std::vector<Celula> trecho;
+  for (; trechos > 0 && caminho.pendente(); --trechos, ++caminho.proximo) {
+    size_t i = caminho.proximo;
+    const Celula &a = caminho.pontos[i];
+    const Celula &b = caminho.pontos[i + 1];
+
+    // Aresta entre clusters: células vizinhas na ortogonal
+    if (cluster(a.x, a.y) != cluster(b.x, b.y)) {
+      saida.push_back(b);
+      continue;
+    }
+
+    int na = caminho.nos[i], nb = caminho.nos[i + 1];
+    bool cacheavel = na >= 0 && nb >= 0;
+    if (cacheavel) {
+      auto it = cache.find(chave(na, nb));
+      if (it != cache.end()) {
+        saida.insert(saida.end(), it->second.begin() + 1, it->second.end());
+        continue;
+      }
+      it = cache.find(chave(nb, na));
+      if (it != cache.end()) {
+        saida.insert(saida.end(), it->second.rbegin() + 1, it->second.rend());
+        continue;
+      }
+    }
+
+    int x0, y0, x1, y1;
+    limitesCluster(cluster(a.x, a.y), x0, y0, x1, y1);
+    if (local.caminho(a, b, x0, y0, x1, y1, trecho) < 0)
+      return false;
+    saida.insert(saida.end(), trecho.begin() + 1, trecho.end());
+    if (cacheavel)
+      cache[chave(na, nb)] = trecho;
+  }
+  return true;
+}
@@ -0,0 +1,892 @@
+#include "planejador_rota.h"
+#include "cache_caminhos.h"
+#include "campo_fluxo.h"
+#include "planejador_hierarquico.h"
+#include "replanejador_dstar.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+const float SQRT2 = 1.41421356f;
+
+float octil(int x0, int y0, int x1, int y1) {
+  int dx = std::abs(x1 - x0);
+  int dy = std::abs(y1 - y0);
+  return (dx + dy) + (SQRT2 - 2.0f) * std::min(dx, dy);
+}
+
+int sinal(int v) { return (v > 0) - (v < 0); }
+
+/**
+ * Varre uma linha do bitset a partir de `inicio` na direção `dir` (+1/-1).
+ *
+ * Retorna a posição do primeiro ponto de salto (vizinho forçado ou alvo)
+ * encontrado antes da primeira célula bloqueada, ou -1. `forc` é o bitset de
+ * vizinhos forçados pré-calculado para esta linha e direção.
+ */
+int varrer(const uint64_t *l, const uint64_t *forc, int palavras, int n,
+           int inicio, int dir, int alvo) {
+  if (inicio < 0 || inicio >= n)
+    return -1;
+  int k = inicio >> 6;
+  int off = inicio & 63;
+
+  if (dir > 0) {
+    uint64_t mascara = ~0ULL << off;
+    for (; k < palavras; ++k, mascara = ~0ULL) {
+      uint64_t bloq = ~l[k] & mascara;
+      uint64_t f = forc[k] & mascara;
+      if (alvo >= inicio && (alvo >> 6) == k)
+        f |= 1ULL << (alvo & 63);
+      if (bloq | f) {
+        int pb = bloq ? __builtin_ctzll(bloq) : 64;
+        int pf = f ? __builtin_ctzll(f) : 64;
+        return pf < pb ? (k << 6) + pf : -1;
+      }
+    }
+  } else {
+    uint64_t mascara = off == 63 ? ~0ULL : ((1ULL << (off + 1)) - 1);
+    for (; k >= 0; --k, mascara = ~0ULL) {
+      uint64_t bloq = ~l[k] & mascara;
+      uint64_t f = forc[k] & mascara;
+      if (alvo >= 0 && alvo <= inicio && (alvo >> 6) == k)
+        f |= 1ULL << (alvo & 63);
+      if (bloq | f) {
+        int pb = bloq ? 63 - __builtin_clzll(bloq) : -1;
+        int pf = f ? 63 - __builtin_clzll(f) : -1;
+        return pf > pb ? (k << 6) + pf : -1;
+      }
+    }
+  }
+  return -1;
+}
+
+/**
+ * Marca em `forc` os vizinhos forçados de uma linha (ou coluna) para as duas
+ * direções de varredura. Uma posição é forçada quando a linha lateral está
+ * livre nela e bloqueada na posição imediatamente anterior (no sentido da
+ * varredura). `lado_a`/`lado_b` são as linhas adjacentes (nullptr fora do
+ * grid).
+ */
+void marcar_forcados(const uint64_t *lado_a, const uint64_t *lado_b,
+                     int palavras, uint64_t *forc_pos, uint64_t *forc_neg) {
+  const uint64_t *lados[2] = {lado_a, lado_b};
+  for (int k = 0; k < palavras; ++k) {
+    uint64_t p = 0, q = 0;
+    for (const uint64_t *s : lados) {
+      if (!s)
+        continue;
+      uint64_t anterior = (s[k] << 1) | (k > 0 ? s[k - 1] >> 63 : 0);
+      uint64_t seguinte =
+          (s[k] >> 1) | (k + 1 < palavras ? s[k + 1] << 63 : 0);
+      p |= s[k] & ~anterior;
+      q |= s[k] & ~seguinte;
+    }
+    forc_pos[k] = p;
+    forc_neg[k] = q;
+  }
+}
+
+} // namespace
+
+// --- GradeNavegacao ---
+
+GradeNavegacao::GradeNavegacao()
+    : w(0), h(0), tamanho_celula(TAMANHO_CELULA_PADRAO), palavras_linha(0),
+      palavras_coluna(0) {}
+
+GradeNavegacao::GradeNavegacao(const std::vector<std::vector<char>> &mapa,
+                               float tamanho_celula, float raio_veiculo)
+    : w(mapa.empty() ? 0 : mapa[0].size()), h(mapa.size()),
+      tamanho_celula(tamanho_celula) {
+  livre_.assign((size_t)w * h, 1);
+  for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w; ++x)
+      if (x >= (int)mapa[y].size() || mapa[y][x] == '1')
+        livre_[(size_t)y * w + x] = 0;
+
+  // Inflação: com o centro no centro da célula, o veículo já cabe em meia
+  // célula; só é preciso dilatar o que exceder isso.
+  int raio = std::max(
+      0, (int)std::ceil((raio_veiculo - tamanho_celula / 2.0f) / tamanho_celula));
+  if (raio > 0) {
+    std::vector<unsigned char> original = livre_;
+    for (int y = 0; y < h; ++y) {
+      for (int x = 0; x < w; ++x) {
+        if (original[(size_t)y * w + x])
+          continue;
+        for (int dy = -raio; dy <= raio; ++dy) {
+          for (int dx = -raio; dx <= raio; ++dx) {
+            int nx = x + dx, ny = y + dy;
+            if (dx * dx + dy * dy > raio * raio || nx < 0 || ny < 0 ||
+                nx >= w || ny >= h)
+              continue;
+            livre_[(size_t)ny * w + nx] = 0;
+          }
+        }
+      }
+    }
+  }
+
+  palavras_linha = (w + 63) / 64;
+  palavras_coluna = (h + 63) / 64;
+  bits_linhas.assign((size_t)h * palavras_linha, 0);
+  bits_colunas.assign((size_t)w * palavras_coluna, 0);
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      if (!livre_[(size_t)y * w + x])
+        continue;
+      bits_linhas[(size_t)y * palavras_linha + (x >> 6)] |= 1ULL << (x & 63);
+      bits_colunas[(size_t)x * palavras_coluna + (y >> 6)] |= 1ULL << (y & 63);
+    }
+  }
+
+  // Vizinhos forçados dependem só do grid: calculados uma vez por mapa
+  for (int d = 0; d < 2; ++d) {
+    forc_linhas[d].assign(bits_linhas.size(), 0);
+    forc_colunas[d].assign(bits_colunas.size(), 0);
+  }
+  for (int y = 0; y < h; ++y) {
+    size_t base = (size_t)y * palavras_linha;
+    marcar_forcados(y > 0 ? linha(y - 1) : nullptr,
+                    y + 1 < h ? linha(y + 1) : nullptr, palavras_linha,
+                    &forc_linhas[0][base], &forc_linhas[1][base]);
+  }
+  for (int x = 0; x < w; ++x) {
+    size_t base = (size_t)x * palavras_coluna;
+    marcar_forcados(x > 0 ? coluna(x - 1) : nullptr,
+                    x + 1 < w ? coluna(x + 1) : nullptr, palavras_coluna,
+                    &forc_colunas[0][base], &forc_colunas[1][base]);
+  }
+}
+
+const uint64_t *GradeNavegacao::linha(int y) const {
+  return &bits_linhas[(size_t)y * palavras_linha];
+}
+
+const uint64_t *GradeNavegacao::coluna(int x) const {
+  return &bits_colunas[(size_t)x * palavras_coluna];
+}
+
+const uint64_t *GradeNavegacao::forcadosLinha(int y, int dir) const {
+  return &forc_linhas[dir > 0 ? 0 : 1][(size_t)y * palavras_linha];
+}
+
+const uint64_t *GradeNavegacao::forcadosColuna(int x, int dir) const {
+  return &forc_colunas[dir > 0 ? 0 : 1][(size_t)x * palavras_coluna];
+}
+
+Celula GradeNavegacao::paraCelula(float x, float y) const {
+  return Celula{static_cast<int>(std::floor(x / tamanho_celula)),
+                static_cast<int>(std::floor(y / tamanho_celula))};
+}
+
+Point GradeNavegacao::paraMundo(const Celula &c, float velocidade) const {
+  return Point{(c.x + 0.5f) * tamanho_celula, (c.y + 0.5f) * tamanho_celula,
+               velocidade};
+}
+
+bool GradeNavegacao::linhaLivre(const Celula &a, const Celula &b) const {
+  int nx = std::abs(b.x - a.x);
+  int ny = std::abs(b.y - a.y);
+  int sx = sinal(b.x - a.x);
+  int sy = sinal(b.y - a.y);
+  int x = a.x, y = a.y;
+  if (!livre(x, y))
+    return false;
+
+  for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+    // Compara (0.5 + ix) / nx com (0.5 + iy) / ny sem divisão
+    long decisao = (long)(1 + 2 * ix) * ny - (long)(1 + 2 * iy) * nx;
+    if (decisao == 0) {
+      // Passa exatamente pelo vértice: as duas laterais precisam estar livres
+      if (!livre(x + sx, y) || !livre(x, y + sy))
+        return false;
+      x += sx;
+      y += sy;
+      ++ix;
+      ++iy;
+    } else if (decisao < 0) {
+      x += sx;
+      ++ix;
+    } else {
+      y += sy;
+      ++iy;
+    }
+    if (!livre(x, y))
+      return false;
+  }
+  return true;
+}
+
+void GradeNavegacao::bloquear(const Celula &c) {
+  if (!livre(c.x, c.y))
+    return;
+  livre_[(size_t)c.y * w + c.x] = 0;
+  bits_linhas[(size_t)c.y * palavras_linha + (c.x >> 6)] &=
+      ~(1ULL << (c.x & 63));
+  bits_colunas[(size_t)c.x * palavras_coluna + (c.y >> 6)] &=
+      ~(1ULL << (c.y & 63));
+
+  // Só mudam os vizinhos forçados das linhas e colunas ao lado da célula
+  for (int y = c.y - 1; y <= c.y + 1; y += 2) {
+    if (y < 0 || y >= h)
+      continue;
+    size_t base = (size_t)y * palavras_linha;
+    marcar_forcados(y > 0 ? linha(y - 1) : nullptr,
+                    y + 1 < h ? linha(y + 1) : nullptr, palavras_linha,
+                    &forc_linhas[0][base], &forc_linhas[1][base]);
+  }
+  for (int x = c.x - 1; x <= c.x + 1; x += 2) {
+    if (x < 0 || x >= w)
+      continue;
+    size_t base = (size_t)x * palavras_coluna;
+    marcar_forcados(x > 0 ? coluna(x - 1) : nullptr,
+                    x + 1 < w ? coluna(x + 1) : nullptr, palavras_coluna,
+                    &forc_colunas[0][base], &forc_colunas[1][base]);
+  }
+}
+
+bool GradeNavegacao::celulaLivreProxima(Celula &c, int raio_max) const {
+  if (livre(c.x, c.y))
+    return true;
+  for (int r = 1; r <= raio_max; ++r) {
+    int melhor_d2 = -1;
+    Celula melhor = c;
+    for (int dy = -r; dy <= r; ++dy) {
+      for (int dx = -r; dx <= r; ++dx) {
+        if (std::max(std::abs(dx), std::abs(dy)) != r ||
+            !livre(c.x + dx, c.y + dy))
+          continue;
+        int d2 = dx * dx + dy * dy;
+        if (melhor_d2 < 0 || d2 < melhor_d2) {
+          melhor_d2 = d2;
+          melhor = Celula{c.x + dx, c.y + dy};
+        }
+      }
+    }
+    if (melhor_d2 >= 0) {
+      c = melhor;
+      return true;
+    }
+  }
+  return false;
+}
+
+// --- PlanejadorJPS ---
+
+PlanejadorJPS::PlanejadorJPS(const GradeNavegacao &grade)
+    : grade(grade), expandidos(0), alvo{0, 0} {
+  nos.reserve(4096);
+  aberta.reserve(4096);
+}
+
+int PlanejadorJPS::saltarReto(int x, int y, int dx, int dy) const {
+  if (dy == 0) {
+    int pos = varrer(grade.linha(y), grade.forcadosLinha(y, dx),
+                     grade.palavrasLinha(), grade.largura(), x, dx,
+                     alvo.y == y ? alvo.x : -1);
+    return pos < 0 ? -1 : indice(pos, y);
+  }
+  int pos = varrer(grade.coluna(x), grade.forcadosColuna(x, dy),
+                   grade.palavrasColuna(), grade.altura(), y, dy,
+                   alvo.x == x ? alvo.y : -1);
+  return pos < 0 ? -1 : indice(x, pos);
+}
+
+int PlanejadorJPS::saltar(int x, int y, int dx, int dy) const {
+  if (dx == 0 || dy == 0) {
+    if (x < 0 || y < 0 || x >= grade.largura() || y >= grade.altura())
+      return -1;
+    return saltarReto(x, y, dx, dy);
+  }
+
+  // Diagonal: avança célula a célula; cada passo testa os dois saltos retos
+  while (true) {
+    if (!grade.livre(x, y))
+      return -1;
+    if (x == alvo.x && y == alvo.y)
+      return indice(x, y);
+    if ((x + dx >= 0 && x + dx < grade.largura() &&
+         saltarReto(x + dx, y, dx, 0) >= 0) ||
+        (y + dy >= 0 && y + dy < grade.altura() &&
+         saltarReto(x, y + dy, 0, dy) >= 0))
+      return indice(x, y);
+    // Sem cortar quinas: as duas ortogonais precisam estar livres
+    if (!grade.livre(x + dx, y) || !grade.livre(x, y + dy))
+      return -1;
+    x += dx;
+    y += dy;
+  }
+}
+
+int PlanejadorJPS::vizinhosPodados(int x, int y, int pai,
+                                   int dirs[8][2]) const {
+  int n = 0;
+  auto adicionar = [&](int dx, int dy) {
+    dirs[n][0] = dx;
+    dirs[n][1] = dy;
+    ++n;
+  };
+
+  if (pai < 0) {
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        if (dx == 0 && dy == 0)
+          continue;
+        bool ok = (dx == 0 || dy == 0)
+                      ? grade.livre(x + dx, y + dy)
+                      : grade.livre(x + dx, y) && grade.livre(x, y + dy);
+        if (ok)
+          adicionar(dx, dy);
+      }
+    }
+    return n;
+  }
+
+  int dx = sinal(x - pai % grade.largura());
+  int dy = sinal(y - pai / grade.largura());
+
+  if (dx != 0 && dy != 0) {
+    bool vert = grade.livre(x, y + dy);
+    bool horiz = grade.livre(x + dx, y);
+    if (vert)
+      adicionar(0, dy);
+    if (horiz)
+      adicionar(dx, 0);
+    if (vert && horiz)
+      adicionar(dx, dy);
+  } else if (dx != 0) {
+    bool frente = grade.livre(x + dx, y);
+    bool cima = grade.livre(x, y + 1);
+    bool baixo = grade.livre(x, y - 1);
+    if (frente) {
+      adicionar(dx, 0);
+      if (cima)
+        adicionar(dx, 1);
+      if (baixo)
+        adicionar(dx, -1);
+    }
+    if (cima)
+      adicionar(0, 1);
+    if (baixo)
+      adicionar(0, -1);
+  } else {
+    bool frente = grade.livre(x, y + dy);
+    bool dir = grade.livre(x + 1, y);
+    bool esq = grade.livre(x - 1, y);
+    if (frente) {
+      adicionar(0, dy);
+      if (dir)
+        adicionar(1, dy);
+      if (esq)
+        adicionar(-1, dy);
+    }
+    if (dir)
+      adicionar(1, 0);
+    if (esq)
+      adicionar(-1, 0);
+  }
+  return n;
+}
+
+bool PlanejadorJPS::planejar(const Celula &inicio, const Celula &objetivo,
+                             std::vector<Celula> &caminho) {
+  nos.clear(); // Invalida as posições guardadas nas células
+  aberta.clear();
+  caminho.clear();
+  expandidos = 0;
+  alvo = objetivo;
+
+  if (!grade.livre(inicio.x, inicio.y) || !grade.livre(objetivo.x, objetivo.y))
+    return false;
+
+  size_t celulas = (size_t)grade.largura() * grade.altura();
+  if (posicao.size() != celulas)
+    posicao.assign(celulas, 0);
+
+  int i_inicio = indice(inicio.x, inicio.y);
+  int i_alvo = indice(objetivo.x, objetivo.y);
+  criarNo(i_inicio, 0.0f, -1);
+  aberta.push_back(
+      {octil(inicio.x, inicio.y, alvo.x, alvo.y), 0.0f, i_inicio});
+
+  int w = grade.largura();
+  while (!aberta.empty()) {
+    std::pop_heap(aberta.begin(), aberta.end());
+    int atual = aberta.back().idx;
+    aberta.pop_back();
+
+    // Referência válida só até o próximo criarNo
+    InfoNo &info = *no(atual);
+    if (info.fechado)
+      continue; // Entrada obsoleta
+    info.fechado = true;
+    ++expandidos;
+    float g = info.g;
+    int pai = info.pai;
+
+    if (atual == i_alvo) {
+      for (int i = atual; i >= 0; i = no(i)->pai)
+        caminho.push_back(Celula{i % w, i / w});
+      std::reverse(caminho.begin(), caminho.end());
+      return true;
+    }
+
+    int x = atual % w;
+    int y = atual / w;
+    int dirs[8][2];
+    int n = vizinhosPodados(x, y, pai, dirs);
+    for (int d = 0; d < n; ++d) {
+      int salto = saltar(x + dirs[d][0], y + dirs[d][1], dirs[d][0], dirs[d][1]);
+      if (salto < 0)
+        continue;
+      int sx = salto % w;
+      int sy = salto / w;
+      float ng = g + octil(x, y, sx, sy);
+
+      InfoNo *s = no(salto);
+      if (!s) {
+        criarNo(salto, ng, atual);
+      } else if (!s->fechado && ng < s->g) {
+        s->g = ng;
+        s->pai = atual;
+      } else {
+        continue;
+      }
+      aberta.push_back({ng + octil(sx, sy, alvo.x, alvo.y), ng, salto});
+      std::push_heap(aberta.begin(), aberta.end());
+    }
+  }
+  return false;
+}
+
+// --- PlanejadorRota ---
+
+/**
+ * Parte da missão ainda não convertida em waypoints: o caminho abstrato
+ * (HPA*) e as células de um caminho que não couberam no anel da rota.
+ */
+struct MissaoPendente {
+  CaminhoAbstrato abstrato;
+  std::vector<Celula> resto; ///< A primeira já é o último waypoint anexado.
+  bool resto_final; ///< Depois do resto, a rota termina em `destino`.
+  float velocidade;
+  Point destino; ///< Ponto final exato (ou centro da célula ajustada).
+
+  MissaoPendente() : resto_final(false), velocidade(0) {}
+};
+
+/**
+ * Grafo HPA* construído numa thread própria sobre uma cópia do mapa. A thread
+ * só escreve aqui; o planejador recolhe o grafo quando `pronta`.
+ */
+struct ConstrucaoHPA {
+  std::shared_ptr<const GradeNavegacao> grade;
+  std::unique_ptr<PlanejadorHPA> hpa;
+  std::atomic<bool> pronta;
+  std::atomic<bool> cancelada; ///< Mapa substituído antes de terminar.
+
+  ConstrucaoHPA() : pronta(false), cancelada(false) {}
+};
+
+namespace {
+// Trechos abstratos refinados por chamada (cada um cobre até um cluster)
+const size_t TRECHOS_POR_REFINO = 4;
+} // namespace
+
+PlanejadorRota::PlanejadorRota()
+    : jps(grade), pendente(new MissaoPendente()),
+      campos(new CacheCamposFluxo()),
+      dstar(new ReplanejadorDStarLite(grade)),
+      cache_caminhos(new CacheCaminhos()), versao_mapa(0),
+      desvio_pendente(false), grade_campos_antiga(false) {}
+
+PlanejadorRota::~PlanejadorRota() {
+  if (construcao_hpa)
+    construcao_hpa->cancelada = true;
+}
+
+void PlanejadorRota::setMapa(const std::vector<std::vector<char>> &mapa,
+                             float tamanho_celula, float raio_veiculo) {
+  GradeNavegacao nova(mapa, tamanho_celula, raio_veiculo);
+
+  // Campos de fluxo só caem se alguma célula alterada estiver perto deles
+  if (nova.largura() == grade.largura() && nova.altura() == grade.altura() &&
+      nova.tamanhoCelula() == grade.tamanhoCelula()) {
+    std::vector<Celula> alteradas;
+    for (int y = 0; y < grade.altura(); ++y) {
+      const uint64_t *a = grade.linha(y);
+      const uint64_t *b = nova.linha(y);
+      for (int k = 0; k < grade.palavrasLinha(); ++k)
+        for (uint64_t dif = a[k] ^ b[k]; dif; dif &= dif - 1)
+          alteradas.push_back(Celula{(k << 6) + __builtin_ctzll(dif), y});
+    }
+    campos->invalidar(alteradas);
+  } else {
+    campos->limpar();
+  }
+
+  grade = nova;
+  // Cópia imutável para as threads de fundo (campos de fluxo e grafo HPA)
+  std::shared_ptr<const GradeNavegacao> copia =
+      std::make_shared<GradeNavegacao>(grade);
+  campos->setGrade(copia);
+  ++versao_mapa;
+  descartarPendente();
+  dstar->limpar(); // O mapa novo substitui os bloqueios vistos pelo sensor
+  desvio_pendente = false;
+  grade_campos_antiga = false;
+  hpa.reset();
+  grade_hpa.reset();
+  if (construcao_hpa)
+    construcao_hpa->cancelada = true; // Grafo de um mapa que já mudou
+  construcao_hpa.reset();
+  if ((long)grade.largura() * grade.altura() >= AREA_MINIMA_HIERARQUICO) {
+    // O grafo abstrato leva segundos em mapas grandes: constrói fora do
+    // ciclo do planejador, que segue publicando objetivo e perfil
+    std::shared_ptr<ConstrucaoHPA> c = std::make_shared<ConstrucaoHPA>();
+    c->grade = copia;
+    construcao_hpa = c;
+    std::thread([c]() {
+      std::unique_ptr<PlanejadorHPA> h(new PlanejadorHPA(*c->grade));
+      h->construir(TAMANHO_CLUSTER_PADRAO, &c->cancelada);
+      if (c->cancelada.load())
+        return;
+      c->hpa = std::move(h);
+      c->pronta.store(true, std::memory_order_release);
+    }).detach();
+  }
+}
+
+bool PlanejadorRota::receberHierarquia() {
+  if (!construcao_hpa ||
+      !construcao_hpa->pronta.load(std::memory_order_acquire))
+    return false;
+  grade_hpa = construcao_hpa->grade;
+  hpa = std::move(construcao_hpa->hpa);
+  construcao_hpa.reset();
+  return true;
+}
+
+size_t PlanejadorRota::anexarReduzido(const std::vector<Celula> &celulas,
+                                      float velocidade,
+                                      Rota &rota) const {
+  // Linha de visada: de cada âncora, pula para o ponto mais distante visível
+  // (bloqueios vistos pelo sensor também cortam a visada)
+  size_t i = 0;
+  while (i + 1 < celulas.size()) {
+    size_t j = i + 1;
+    while (j + 1 < celulas.size() &&
+           dstar->linhaLivre(celulas[i], celulas[j + 1]))
+      ++j;
+    if (!rota.push_back(grade.paraMundo(celulas[j], velocidade)))
+      break; // Anel cheio: a rota para na âncora atual
+    i = j;
+  }
+  return i;
+}
+
+void PlanejadorRota::anexarCaminho(const std::vector<Celula> &celulas,
+                                   float velocidade, const Point &destino,
+                                   bool final, Rota &rota) {
+  size_t i = anexarReduzido(celulas, velocidade, rota);
+  if (i + 1 < celulas.size()) {
+    // Anel cheio: o restante entra quando a fila esvaziar, sem ligar a
+    // última âncora ao destino por uma reta que pode cruzar paredes
+    pendente->resto.assign(celulas.begin() + i, celulas.end());
+    pendente->resto_final = final;
+    pendente->velocidade = velocidade;
+    pendente->destino = destino;
+    return;
+  }
+  if (!final)
+    return;
+  if (celulas.size() > 1) {
+    rota.back() = destino;
+  } else if (!rota.push_back(destino)) {
+    pendente->resto.assign(celulas.begin(), celulas.end());
+    pendente->resto_final = true;
+    pendente->velocidade = velocidade;
+    pendente->destino = destino;
+  }
+}
+
+bool PlanejadorRota::planejar(float x0, float y0, float x1, float y1,
+                              float velocidade, Rota &rota) {
+  if (!temMapa())
+    return false;
+
+  // Ruído de posição pode colocar o início numa célula inflada: aproxima
+  const int RAIO_AJUSTE = 3;
+  Celula inicio = grade.paraCelula(x0, y0);
+  Celula objetivo = grade.paraCelula(x1, y1);
+  Celula objetivo_original = objetivo;
+  if (!grade.celulaLivreProxima(inicio, RAIO_AJUSTE) ||
+      !grade.celulaLivreProxima(objetivo, RAIO_AJUSTE))
+    return false;
+
+  // O caminho é lido direto da entrada do cache, sem cópia
+  const std::vector<Celula> *guardado =
+      cache_caminhos->buscar(inicio, objetivo, versao_mapa);
+  if (!guardado) {
+    auto t0 = std::chrono::steady_clock::now();
+    if (!jps.planejar(inicio, objetivo, caminho))
+      return false;
+    std::chrono::duration<double, std::micro> custo =
+        std::chrono::steady_clock::now() - t0;
+    guardado = &cache_caminhos->guardar(inicio, objetivo, versao_mapa,
+                                        caminho, custo.count());
+  }
+
+  // Termina no ponto exato pedido se ele não precisou ser ajustado
+  bool exato = objetivo.x == objetivo_original.x &&
+               objetivo.y == objetivo_original.y;
+  anexarCaminho(*guardado, velocidade,
+                exato ? Point{x1, y1, velocidade}
+                      : grade.paraMundo(objetivo, velocidade),
+                true, rota);
+  return true;
+}
+
+bool PlanejadorRota::segmentoTransitavel(float x0, float y0, float x1,
+                                         float y1) const {
+  if (!temMapa())
+    return true; // Sem mapa não há como validar; confia no operador
+  return grade.linhaLivre(grade.paraCelula(x0, y0), grade.paraCelula(x1, y1));
+}
+
+bool PlanejadorRota::validarRota(float x0, float y0, Rota &rota) {
+  if (!temMapa())
+    return true;
+
+  Rota &corrigida = auxiliar;
+  corrigida.clear();
+  float px = x0, py = y0;
+  for (const Point &p : rota) {
+    bool ok = segmentoTransitavel(px, py, p.x, p.y)
+                  ? corrigida.push_back(p)
+                  : planejar(px, py, p.x, p.y, p.speed, corrigida);
+    if (!pendente->resto.empty()) { // Não coube: a rota fica como estava
+      pendente->resto.clear();
+      return false;
+    }
+    if (!ok)
+      return false;
+    px = p.x;
+    py = p.y;
+  }
+  rota.swap(corrigida);
+  return true;
+}
+
+bool PlanejadorRota::planejarMissao(float x0, float y0, float x1, float y1,
+                                    float velocidade, Rota &rota) {
+  descartarPendente();
+  if (!temMapa())
+    return false;
+
+  const int RAIO_AJUSTE = 3;
+  Celula inicio = grade.paraCelula(x0, y0);
+  Celula objetivo = grade.paraCelula(x1, y1);
+  Celula objetivo_original = objetivo;
+  if (!grade.celulaLivreProxima(inicio, RAIO_AJUSTE) ||
+      !grade.celulaLivreProxima(objetivo, RAIO_AJUSTE))
+    return false;
+  bool exato = objetivo.x == objetivo_original.x &&
+               objetivo.y == objetivo_original.y;
+  Point destino = exato ? Point{x1, y1, velocidade}
+                        : grade.paraMundo(objetivo, velocidade);
+
+  receberHierarquia();
+  if (seguirCampo(inicio, objetivo, velocidade, destino, rota))
+    return true;
+  if (!hpa)
+    return planejar(x0, y0, x1, y1, velocidade, rota);
+  if (!hpa->planejar(inicio, objetivo, pendente->abstrato))
+    return false;
+
+  pendente->velocidade = velocidade;
+  pendente->destino = destino;
+  if (!pendente->abstrato.pendente()) { // Início e objetivo na mesma célula
+    caminho.assign(1, objetivo);
+    anexarCaminho(caminho, velocidade, destino, true, rota);
+    return true;
+  }
+  return refinarPendente(rota);
+}
+
+bool PlanejadorRota::seguirCampo(const Celula &inicio, const Celula &objetivo,
+                                 float velocidade, const Point &destino,
+                                 Rota &rota) {
+  if (grade_campos_antiga) {
+    // Campos gerados daqui em diante já contornam os bloqueios do sensor
+    campos->setGrade(std::make_shared<GradeNavegacao>(grade));
+    grade_campos_antiga = false;
+  }
+  std::shared_ptr<const CampoFluxo> campo = campos->pedir(objetivo);
+  if (!campo || campo->custo(inicio.x, inicio.y) < 0)
+    return false;
+
+  // Cada passo é uma consulta O(1); o limite só protege contra ciclos
+  caminho.assign(1, inicio);
+  size_t limite = (size_t)grade.largura() * grade.altura();
+  Celula c = inicio, prox;
+  while (campo->proximo(c, prox) && caminho.size() <= limite) {
+    caminho.push_back(prox);
+    c = prox;
+  }
+  if (c.x != objetivo.x || c.y != objetivo.y)
+    return false;
+  anexarCaminho(caminho, velocidade, destino, true, rota);
+  return true;
+}
+
+bool PlanejadorRota::refinarPendente(Rota &rota) {
+  if (!temPendente())
+    return true;
+
+  // Primeiro as células que não couberam no anel; depois o caminho abstrato
+  bool final;
+  if (!pendente->resto.empty()) {
+    caminho.swap(pendente->resto);
+    pendente->resto.clear();
+    final = pendente->resto_final;
+  } else {
+    CaminhoAbstrato &abstrato = pendente->abstrato;
+    caminho.assign(1, abstrato.pontos[abstrato.proximo]);
+    if (!hpa->refinar(abstrato, TRECHOS_POR_REFINO, caminho)) {
+      descartarPendente();
+      return false;
+    }
+    final = !abstrato.pendente();
+  }
+  size_t antes = rota.size();
+  Point origem = antes ? rota.back() : grade.paraMundo(caminho.front(), 0.0f);
+  anexarCaminho(caminho, pendente->velocidade, pendente->destino, final, rota);
+  // O grafo abstrato é de antes dos bloqueios do sensor: trechos que os
+  // cruzam ficam para o desvio do D* Lite
+  if (trechoBloqueado(origem.x, origem.y, rota, antes) < rota.size())
+    desvio_pendente = true;
+  return true;
+}
+
+bool PlanejadorRota::temPendente() const {
+  return !pendente->resto.empty() || (hpa && pendente->abstrato.pendente());
+}
+
+void PlanejadorRota::descartarPendente() {
+  pendente->abstrato.limpar();
+  pendente->resto.clear();
+}
+
+bool PlanejadorRota::marcarBloqueio(float x, float y) {
+  if (!temMapa())
+    return false;
+  Celula c = grade.paraCelula(x, y);
+  if (!dstar->marcarBloqueada(c)) {
+    // Reaviso: a rota pode ter voltado a cruzar o bloqueio
+    if (dstar->bloqueadaSensor(c))
+      desvio_pendente = true;
+    return false;
+  }
+  grade.bloquear(c); // JPS, linha de visada e janelas novas o evitam
+  campos->invalidar(std::vector<Celula>(1, c));
+  grade_campos_antiga = true;
+  ++versao_mapa; // Caminhos guardados podem cruzar o bloqueio
+  desvio_pendente = true;
+  return true;
+}
+
+// Primeiro waypoint (a partir de `desde`) cujo trecho de chegada cruza um
+// bloqueio do sensor; rota.size() se nenhum cruza.
+size_t PlanejadorRota::trechoBloqueado(float x0, float y0,
+                                       const Rota &rota,
+                                       size_t desde) const {
+  if (dstar->bloqueiosSensor() == 0)
+    return rota.size();
+  Celula a = grade.paraCelula(x0, y0);
+  for (size_t k = desde; k < rota.size(); ++k) {
+    Celula b = grade.paraCelula(rota[k].x, rota[k].y);
+    if (dstar->cruzaBloqueio(a, b))
+      return k;
+    a = b;
+  }
+  return rota.size();
+}
+
+bool PlanejadorRota::desviarBloqueios(float x0, float y0,
+                                      Rota &rota,
+                                      int orcamento_us) {
+  if (!desvio_pendente)
+    return true;
+
+  // Waypoints que caíram sobre um bloqueio são abandonados
+  while (!rota.empty() &&
+         dstar->bloqueadaSensor(grade.paraCelula(rota.front().x,
+                                                 rota.front().y)))
+    rota.pop_front();
+  size_t k_alvo = trechoBloqueado(x0, y0, rota, 0);
+  if (k_alvo == rota.size()) { // A rota não cruza nenhum bloqueio
+    desvio_pendente = false;
+    return true;
+  }
+
+  // Se o destino da busca anterior ainda está na rota depois do trecho
+  // bloqueado, a busca continua incremental; senão recomeça no fim do trecho.
+  if (dstar->ativo()) {
+    for (size_t k = k_alvo; k < rota.size(); ++k) {
+      Celula c = grade.paraCelula(rota[k].x, rota[k].y);
+      if (c.x == dstar->objetivo().x && c.y == dstar->objetivo().y) {
+        k_alvo = k;
+        break;
+      }
+    }
+  }
+
+  const int RAIO_AJUSTE = 3;
+  Celula inicio = grade.paraCelula(x0, y0);
+  Celula alvo = grade.paraCelula(rota[k_alvo].x, rota[k_alvo].y);
+  if (!grade.celulaLivreProxima(inicio, RAIO_AJUSTE) ||
+      !grade.celulaLivreProxima(alvo, RAIO_AJUSTE)) {
+    desvio_pendente = false;
+    return false;
+  }
+  if (!dstar->ativo() || alvo.x != dstar->objetivo().x ||
+      alvo.y != dstar->objetivo().y)
+    dstar->iniciar(inicio, alvo);
+  else
+    dstar->moverPara(inicio);
+
+  if (!dstar->reparar(orcamento_us))
+    return true; // Orçamento esgotado: continua no próximo ciclo
+  desvio_pendente = false;
+  if (!dstar->caminho(caminho))
+    return false;
+
+  Point destino = rota[k_alvo];
+  Rota &desvio = auxiliar;
+  desvio.clear();
+  // O desvio entra na frente da rota: se não couber no espaço livre do anel,
+  // cortá-lo ligaria dois pontos por uma reta que cruza o bloqueio
+  size_t livre = Rota::capacity() - (rota.size() - (k_alvo + 1));
+  if (anexarReduzido(caminho, destino.speed, desvio) + 1 < caminho.size() ||
+      desvio.size() > livre)
+    return false;
+  rota.pop_front(k_alvo + 1);
+  if (desvio.empty())
+    desvio.push_back(destino);
+  else
+    desvio.back() = destino;
+  for (size_t k = desvio.size(); k-- > 0;)
+    rota.push_front(desvio[k]);
+  // Outro trecho mais adiante pode cruzar bloqueios: segue no próximo ciclo
+  desvio_pendente = trechoBloqueado(destino.x, destino.y, rota,
+                                    desvio.size()) < rota.size();
+  return true;
+}
@@ -0,0 +1,283 @@
+#include "replanejador_dstar.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+
+// Custos inteiros (10 reto, 14 diagonal): a busca incremental depende de
+// empates exatos entre chaves, que somas de sqrt(2) em ponto flutuante quebram.
+const int CUSTO_RETO = 10;
+const int CUSTO_DIAGONAL = 14;
+const int INF = std::numeric_limits<int>::max() / 4;
+
+int octil(const Celula &a, const Celula &b) {
+  int dx = std::abs(a.x - b.x);
+  int dy = std::abs(a.y - b.y);
+  return CUSTO_RETO * std::max(dx, dy) +
+         (CUSTO_DIAGONAL - CUSTO_RETO) * std::min(dx, dy);
+}
+
+int somar(int a, int b) { return (a >= INF || b >= INF) ? INF : a + b; }
+
+// Liang-Barsky: restringe [t0, t1] ao semiplano p*t <= q
+bool recortar(float p, float q, float &t0, float &t1) {
+  if (p == 0.0f)
+    return q >= 0.0f;
+  float r = q / p;
+  if (p < 0.0f) {
+    if (r > t1)
+      return false;
+    t0 = std::max(t0, r);
+  } else {
+    if (r < t0)
+      return false;
+    t1 = std::min(t1, r);
+  }
+  return true;
+}
+
+} // namespace
+
+ReplanejadorDStarLite::ReplanejadorDStarLite(const GradeNavegacao &grade)
+    : grade(grade), ativo_(false), inicio_{0, 0}, objetivo_{0, 0},
+      ultimo_{0, 0}, km(0), expandidos_(0) {}
+
+void ReplanejadorDStarLite::limpar() {
+  ativo_ = false;
+  nos.clear();
+  fila.clear();
+  bloqueios.clear();
+  expandidos_ = 0;
+}
+
+bool ReplanejadorDStarLite::livre(int x, int y) const {
+  return grade.livre(x, y) &&
+         bloqueios.find(y * grade.largura() + x) == bloqueios.end();
+}
+
+bool ReplanejadorDStarLite::bloqueadaSensor(const Celula &c) const {
+  return c.x >= 0 && c.y >= 0 && c.x < grade.largura() &&
+         c.y < grade.altura() && bloqueios.find(indice(c)) != bloqueios.end();
+}
+
+bool ReplanejadorDStarLite::linhaLivre(const Celula &a, const Celula &b) const {
+  return grade.linhaLivre(a, b) && !cruzaBloqueio(a, b);
+}
+
+bool ReplanejadorDStarLite::cruzaBloqueio(const Celula &a,
+                                          const Celula &b) const {
+  // Os bloqueios são poucos: testa o segmento (entre centros) contra o
+  // quadrado de cada um; encostar numa quina já conta como cruzar.
+  float ax = a.x + 0.5f, ay = a.y + 0.5f;
+  float dx = (float)(b.x - a.x), dy = (float)(b.y - a.y);
+  for (int i : bloqueios) {
+    Celula c = celula(i);
+    float t0 = 0.0f, t1 = 1.0f;
+    if (recortar(-dx, ax - c.x, t0, t1) && recortar(dx, c.x + 1 - ax, t0, t1) &&
+        recortar(-dy, ay - c.y, t0, t1) && recortar(dy, c.y + 1 - ay, t0, t1))
+      return true;
+  }
+  return false;
+}
+
+ReplanejadorDStarLite::No &ReplanejadorDStarLite::no(int idx) {
+  auto it = nos.find(idx);
+  if (it != nos.end())
+    return it->second;
+  return nos[idx] = No{INF, INF, Chave{INF, INF}, false};
+}
+
+int ReplanejadorDStarLite::g(int idx) const {
+  auto it = nos.find(idx);
+  return it == nos.end() ? INF : it->second.g;
+}
+
+int ReplanejadorDStarLite::rhs(int idx) const {
+  auto it = nos.find(idx);
+  return it == nos.end() ? INF : it->second.rhs;
+}
+
+ReplanejadorDStarLite::Chave
+ReplanejadorDStarLite::calcularChave(int idx) const {
+  int m = std::min(g(idx), rhs(idx));
+  return Chave{somar(m, octil(inicio_, celula(idx)) + km), m};
+}
+
+int ReplanejadorDStarLite::vizinhos(int idx, int saida[8],
+                                    int custos[8]) const {
+  // Grid não direcionado: sucessores e predecessores coincidem
+  Celula c = celula(idx);
+  int n = 0;
+  if (!livre(c.x, c.y))
+    return 0;
+  for (int dy = -1; dy <= 1; ++dy) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      if (dx == 0 && dy == 0)
+        continue;
+      if (!livre(c.x + dx, c.y + dy))
+        continue;
+      if (dx != 0 && dy != 0 &&
+          (!livre(c.x + dx, c.y) || !livre(c.x, c.y + dy)))
+        continue;
+      saida[n] = idx + dy * grade.largura() + dx;
+      custos[n] = (dx != 0 && dy != 0) ? CUSTO_DIAGONAL : CUSTO_RETO;
+      ++n;
+    }
+  }
+  return n;
+}
+
+void ReplanejadorDStarLite::atualizarVertice(int idx) {
+  No &u = no(idx);
+  if (idx != indice(objetivo_)) {
+    int viz[8];
+    int custo[8];
+    int n = vizinhos(idx, viz, custo);
+    int melhor = INF;
+    for (int k = 0; k < n; ++k)
+      melhor = std::min(melhor, somar(custo[k], g(viz[k])));
+    u.rhs = melhor;
+  }
+  // Remoção preguiçosa: entradas antigas são descartadas ao sair da fila
+  u.na_fila = false;
+  if (u.g != u.rhs) {
+    u.chave = calcularChave(idx);
+    u.na_fila = true;
+    fila.push_back(EntradaFila{u.chave, idx});
+    std::push_heap(fila.begin(), fila.end());
+  }
+}
+
+void ReplanejadorDStarLite::iniciar(const Celula &inicio,
+                                    const Celula &objetivo) {
+  nos.clear();
+  fila.clear();
+  expandidos_ = 0;
+  km = 0;
+  inicio_ = inicio;
+  ultimo_ = inicio;
+  objetivo_ = objetivo;
+  ativo_ = true;
+
+  int i = indice(objetivo);
+  No &o = no(i);
+  o.rhs = 0;
+  o.chave = calcularChave(i);
+  o.na_fila = true;
+  fila.push_back(EntradaFila{o.chave, i});
+}
+
+void ReplanejadorDStarLite::moverPara(const Celula &atual) {
+  if (atual.x == inicio_.x && atual.y == inicio_.y)
+    return;
+  inicio_ = atual;
+  km += octil(ultimo_, inicio_);
+  ultimo_ = inicio_;
+}
+
+bool ReplanejadorDStarLite::marcarBloqueada(const Celula &c) {
+  if (!livre(c.x, c.y))
+    return false;
+  bloqueios.insert(indice(c));
+  if (!ativo_)
+    return true;
+
+  // A célula e as arestas que passam por ela (inclusive diagonais que cortam
+  // a sua quina) mudam de custo: reabre a vizinhança 3x3.
+  for (int dy = -1; dy <= 1; ++dy) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      int x = c.x + dx, y = c.y + dy;
+      if (x < 0 || y < 0 || x >= grade.largura() || y >= grade.altura())
+        continue;
+      atualizarVertice(y * grade.largura() + x);
+    }
+  }
+  return true;
+}
+
+bool ReplanejadorDStarLite::reparar(int orcamento_us) {
+  if (!ativo_)
+    return false;
+  auto limite = std::chrono::steady_clock::now() +
+                std::chrono::microseconds(orcamento_us);
+  int i_inicio = indice(inicio_);
+  int desde_relogio = 0;
+
+  while (!fila.empty()) {
+    const EntradaFila topo = fila.front();
+    No &u = no(topo.idx);
+    if (!u.na_fila || u.chave < topo.chave || topo.chave < u.chave) {
+      std::pop_heap(fila.begin(), fila.end());
+      fila.pop_back(); // Entrada obsoleta
+      continue;
+    }
+    if (!(topo.chave < calcularChave(i_inicio)) && rhs(i_inicio) == g(i_inicio))
+      return true;
+
+    if (++desde_relogio >= 256) {
+      desde_relogio = 0;
+      if (std::chrono::steady_clock::now() > limite)
+        return false; // Continua no próximo ciclo
+    }
+
+    std::pop_heap(fila.begin(), fila.end());
+    fila.pop_back();
+    u.na_fila = false;
+    ++expandidos_;
+
+    Chave nova = calcularChave(topo.idx);
+    int viz[8];
+    int custo[8];
+    if (topo.chave < nova) {
+      u.chave = nova;
+      u.na_fila = true;
+      fila.push_back(EntradaFila{nova, topo.idx});
+      std::push_heap(fila.begin(), fila.end());
+    } else if (u.g > u.rhs) {
+      u.g = u.rhs;
+      int n = vizinhos(topo.idx, viz, custo);
+      for (int k = 0; k < n; ++k)
+        atualizarVertice(viz[k]);
+    } else {
+      u.g = INF;
+      int n = vizinhos(topo.idx, viz, custo);
+      for (int k = 0; k < n; ++k)
+        atualizarVertice(viz[k]);
+      atualizarVertice(topo.idx);
+    }
+  }
+  return true;
+}
+
+bool ReplanejadorDStarLite::caminho(std::vector<Celula> &saida) const {
+  saida.clear();
+  int atual = indice(inicio_);
+  int alvo = indice(objetivo_);
+  if (!ativo_ || rhs(atual) == INF)
+    return false;
+
+  saida.push_back(inicio_);
+  size_t limite = (size_t)grade.largura() * grade.altura();
+  while (atual != alvo && saida.size() <= limite) {
+    int viz[8];
+    int custo[8];
+    int n = vizinhos(atual, viz, custo);
+    int melhor = -1;
+    int melhor_custo = INF;
+    for (int k = 0; k < n; ++k) {
+      int c = somar(custo[k], g(viz[k]));
+      if (c < melhor_custo) {
+        melhor_custo = c;
+        melhor = viz[k];
+      }
+    }
+    if (melhor < 0)
+      return false;
+    atual = melhor;
+    saida.push_back(celula(atual));
+  }
+  return atual == alvo;
+}
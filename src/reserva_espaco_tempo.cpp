@@ -0,0 +1,385 @@
+#include "reserva_espaco_tempo.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+const float SQRT2 = 1.41421356f;
+
+bool igual(const Celula &a, const Celula &b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+// Com passos diagonais de um slot, a distância em slots é a de Chebyshev
+int chebyshev(int x0, int y0, int x1, int y1) {
+  return std::max(std::abs(x1 - x0), std::abs(y1 - y0));
+}
+
+// a vai de a0 a a1 e b de b0 a b1 cruzando a mesma quina em diagonal
+bool cruzamDiagonais(const Celula &a0, const Celula &a1, const Celula &b0,
+                     const Celula &b1) {
+  if (a0.x == a1.x || a0.y == a1.y)
+    return false;
+  Celula c1{a1.x, a0.y}, c2{a0.x, a1.y};
+  return (igual(b0, c1) && igual(b1, c2)) || (igual(b0, c2) && igual(b1, c1));
+}
+
+} // namespace
+
+const Celula &CaminhoTemporal::em(int t) const {
+  int k = std::min(std::max(t - t0, 0), (int)celulas.size() - 1);
+  return celulas[k];
+}
+
+// --- TabelaReservas ---
+
+TabelaReservas::TabelaReservas(const GradeNavegacao &grade) : grade(grade) {}
+
+bool TabelaReservas::ocupar(int id, const Celula &c, int t) {
+  uint64_t k = chave(c, t);
+  if (!ocupacao.insert(std::make_pair(k, id)).second)
+    return false; // Já reservado (por outro ou pelo próprio)
+  por_agente[id].push_back(k);
+  return true;
+}
+
+void TabelaReservas::reservar(const CaminhoTemporal &caminho, int ate) {
+  for (size_t k = 0; k < caminho.celulas.size(); ++k)
+    ocupar(caminho.id, caminho.celulas[k], caminho.t0 + (int)k);
+  if (caminho.completo && !caminho.celulas.empty()) {
+    int t = caminho.t0 + (int)caminho.celulas.size();
+    for (; t <= ate; ++t)
+      ocupar(caminho.id, caminho.celulas.back(), t);
+  }
+}
+
+void TabelaReservas::liberar(int id) {
+  auto it = por_agente.find(id);
+  if (it == por_agente.end())
+    return;
+  for (uint64_t k : it->second)
+    ocupacao.erase(k);
+  por_agente.erase(it);
+}
+
+void TabelaReservas::limpar() {
+  ocupacao.clear();
+  por_agente.clear();
+}
+
+int TabelaReservas::dono(const Celula &c, int t) const {
+  auto it = ocupacao.find(chave(c, t));
+  return it == ocupacao.end() ? -1 : it->second;
+}
+
+bool TabelaReservas::podeMover(int id, const Celula &de, const Celula &para,
+                               int t) const {
+  if (!podeOcupar(id, para, t + 1))
+    return false;
+  // Troca de posição: dois caminhões frente a frente no mesmo túnel
+  int outro = dono(para, t);
+  if (outro >= 0 && outro != id && dono(de, t + 1) == outro)
+    return false;
+  // Duas diagonais cruzando a mesma quina no mesmo slot
+  if (de.x != para.x && de.y != para.y) {
+    Celula c1{para.x, de.y}, c2{de.x, para.y};
+    outro = dono(c1, t);
+    if (outro >= 0 && outro != id && dono(c2, t + 1) == outro)
+      return false;
+    outro = dono(c2, t);
+    if (outro >= 0 && outro != id && dono(c1, t + 1) == outro)
+      return false;
+  }
+  return true;
+}
+
+// --- BuscaEspacoTempo ---
+
+BuscaEspacoTempo::BuscaEspacoTempo(const GradeNavegacao &grade, int horizonte)
+    : grade(grade), horizonte_(std::max(1, horizonte)),
+      lado(2 * std::max(1, horizonte) + 1), geracao(0), expandidos_(0) {}
+
+bool BuscaEspacoTempo::violaVertice(int celula, int t) const {
+  for (const Restricao *r : minhas)
+    if (r->destino < 0 && r->celula == celula && r->t == t)
+      return true;
+  return false;
+}
+
+bool BuscaEspacoTempo::violaAresta(int de, int para, int t) const {
+  for (const Restricao *r : minhas)
+    if (r->destino == para && r->celula == de && r->t == t)
+      return true;
+  return false;
+}
+
+bool BuscaEspacoTempo::planejar(const PedidoCaminho &pedido, int t0,
+                                const TabelaReservas &tabela,
+                                const std::vector<Restricao> &restricoes,
+                                CaminhoTemporal &saida) {
+  saida.id = pedido.id;
+  saida.t0 = t0;
+  saida.celulas.clear();
+  saida.completo = false;
+  saida.custo = 0;
+  expandidos_ = 0;
+
+  minhas.clear();
+  for (const Restricao &r : restricoes)
+    if (r.agente == pedido.id)
+      minhas.push_back(&r);
+
+  const Celula &s = pedido.inicio;
+  const Celula &obj = pedido.objetivo;
+  const int H = horizonte_;
+  const int w = grade.largura();
+  if (!grade.livre(s.x, s.y))
+    return false;
+
+  // Caixa alcançável na janela: um passo por slot a partir do início
+  size_t n = (size_t)lado * lado * (H + 1);
+  if (marca.size() < n) {
+    pai.resize(n);
+    marca.assign(n, 0);
+    geracao = 0;
+  }
+  if (++geracao == 0) {
+    std::fill(marca.begin(), marca.end(), 0);
+    geracao = 1;
+  }
+  const int plano = lado * lado;
+  auto local = [&](int x, int y, int dt) {
+    return (dt * lado + (y - s.y + H)) * lado + (x - s.x + H);
+  };
+
+  aberta.clear();
+  int h0 = chebyshev(s.x, s.y, obj.x, obj.y);
+  int raiz = local(s.x, s.y, 0);
+  marca[raiz] = geracao;
+  pai[raiz] = -1;
+  aberta.push_back({h0, h0, raiz});
+
+  int fim = -1;
+  while (!aberta.empty()) {
+    EntradaAberta e = aberta.front();
+    std::pop_heap(aberta.begin(), aberta.end());
+    aberta.pop_back();
+    ++expandidos_;
+
+    int dt = e.no / plano;
+    int resto = e.no % plano;
+    int x = resto % lado - H + s.x;
+    int y = resto / lado - H + s.y;
+    int idx = y * w + x;
+
+    if (x == obj.x && y == obj.y) {
+      // Só termina se puder ficar no objetivo até o fim da janela
+      bool fica = true;
+      for (int k = dt + 1; k <= H && fica; ++k)
+        fica = tabela.podeOcupar(pedido.id, obj, t0 + k) &&
+               !violaVertice(idx, t0 + k);
+      if (fica) {
+        saida.completo = true;
+        saida.custo = dt;
+        fim = e.no;
+        break;
+      }
+    }
+    if (dt == H) {
+      // Objetivo além da janela: melhor prefixo (menor f entre os abertos)
+      saida.custo = H + e.h;
+      fim = e.no;
+      break;
+    }
+
+    int t = t0 + dt;
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        int nx = x + dx, ny = y + dy; // (0,0) = esperar
+        if (!grade.livre(nx, ny))
+          continue;
+        if (dx != 0 && dy != 0 &&
+            (!grade.livre(nx, y) || !grade.livre(x, ny)))
+          continue; // Sem cortar quinas
+        // g = dt + 1 para qualquer pai: o primeiro a chegar já é ótimo
+        int j = local(nx, ny, dt + 1);
+        if (marca[j] == geracao)
+          continue;
+        int nidx = ny * w + nx;
+        if (!tabela.podeMover(pedido.id, Celula{x, y}, Celula{nx, ny}, t) ||
+            violaVertice(nidx, t + 1) || violaAresta(idx, nidx, t))
+          continue;
+        marca[j] = geracao;
+        pai[j] = e.no;
+        int h = chebyshev(nx, ny, obj.x, obj.y);
+        aberta.push_back({dt + 1 + h, h, j});
+        std::push_heap(aberta.begin(), aberta.end());
+      }
+    }
+  }
+  if (fim < 0)
+    return false;
+
+  for (int no = fim; no >= 0; no = pai[no]) {
+    int resto = no % plano;
+    saida.celulas.push_back(
+        Celula{resto % lado - H + s.x, resto / lado - H + s.y});
+  }
+  std::reverse(saida.celulas.begin(), saida.celulas.end());
+  return true;
+}
+
+// --- PlanejadorMultiCaminhao ---
+
+PlanejadorMultiCaminhao::PlanejadorMultiCaminhao(const GradeNavegacao &grade,
+                                                 int horizonte)
+    : grade(grade), tabela(grade), busca(grade, horizonte), nos_cbs(0) {}
+
+bool PlanejadorMultiCaminhao::planejar(
+    const std::vector<PedidoCaminho> &pedidos, int t0,
+    std::vector<CaminhoTemporal> &saida) {
+  for (const PedidoCaminho &p : pedidos)
+    tabela.liberar(p.id);
+  saida.clear();
+  nos_cbs = 0;
+
+  if (pedidos.size() > 1 && pedidos.size() <= MAX_AGENTES_CBS &&
+      planejarCBS(pedidos, t0, saida)) {
+    for (const CaminhoTemporal &c : saida)
+      tabela.reservar(c, t0 + busca.horizonte());
+    return true;
+  }
+  saida.clear();
+  return planejarPrioritario(pedidos, t0, saida);
+}
+
+bool PlanejadorMultiCaminhao::planejarPrioritario(
+    const std::vector<PedidoCaminho> &pedidos, int t0,
+    std::vector<CaminhoTemporal> &saida) {
+  static const std::vector<Restricao> sem_restricoes;
+  bool ok = true;
+  saida.resize(pedidos.size());
+  for (size_t i = 0; i < pedidos.size(); ++i) {
+    CaminhoTemporal &c = saida[i];
+    if (!busca.planejar(pedidos[i], t0, tabela, sem_restricoes, c)) {
+      // Sem caminho: o caminhão continua ocupando a própria célula
+      c.celulas.assign(1, pedidos[i].inicio);
+      c.completo = false;
+      ok = false;
+    }
+    tabela.reservar(c, t0 + busca.horizonte());
+  }
+  return ok;
+}
+
+bool PlanejadorMultiCaminhao::primeiroConflito(
+    const std::vector<CaminhoTemporal> &caminhos, int t0, Conflito &c) const {
+  int fim = t0 + busca.horizonte();
+  for (int t = t0; t < fim; ++t) {
+    for (size_t a = 0; a < caminhos.size(); ++a) {
+      const Celula &a0 = caminhos[a].em(t), &a1 = caminhos[a].em(t + 1);
+      for (size_t b = a + 1; b < caminhos.size(); ++b) {
+        const Celula &b0 = caminhos[b].em(t), &b1 = caminhos[b].em(t + 1);
+        bool vertice = igual(a1, b1);
+        if (vertice || (igual(a0, b1) && igual(a1, b0)) ||
+            cruzamDiagonais(a0, a1, b0, b1)) {
+          c = Conflito{(int)a, (int)b, t, vertice};
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool PlanejadorMultiCaminhao::planejarCBS(
+    const std::vector<PedidoCaminho> &pedidos, int t0,
+    std::vector<CaminhoTemporal> &saida) {
+  struct NoCBS {
+    std::vector<Restricao> restricoes;
+    std::vector<CaminhoTemporal> caminhos;
+    int custo;
+  };
+  typedef std::pair<int, size_t> Aberto; // (-custo, nó): heap de mínimo
+  std::vector<NoCBS> nos;
+  std::vector<Aberto> aberta;
+
+  // Raiz: cada caminhão sozinho contra as reservas do resto da frota
+  NoCBS raiz;
+  raiz.custo = 0;
+  raiz.caminhos.resize(pedidos.size());
+  for (size_t i = 0; i < pedidos.size(); ++i) {
+    if (!busca.planejar(pedidos[i], t0, tabela, raiz.restricoes,
+                        raiz.caminhos[i]))
+      return false;
+    raiz.custo += raiz.caminhos[i].custo;
+  }
+  nos.push_back(raiz);
+  aberta.push_back(Aberto(-raiz.custo, 0));
+
+  while (!aberta.empty() && nos.size() < MAX_NOS_CBS) {
+    std::pop_heap(aberta.begin(), aberta.end());
+    size_t atual = aberta.back().second;
+    aberta.pop_back();
+
+    Conflito cf;
+    if (!primeiroConflito(nos[atual].caminhos, t0, cf)) {
+      nos_cbs = nos.size();
+      saida = nos[atual].caminhos;
+      return true;
+    }
+
+    // Um filho por lado do conflito, cada um proibindo o movimento de um
+    for (int lado = 0; lado < 2; ++lado) {
+      size_t k = lado == 0 ? cf.a : cf.b;
+      NoCBS filho = nos[atual];
+      const CaminhoTemporal &ck = filho.caminhos[k];
+      if (cf.vertice)
+        filho.restricoes.push_back(
+            Restricao{pedidos[k].id, indice(ck.em(cf.t + 1)), -1, cf.t + 1});
+      else
+        filho.restricoes.push_back(Restricao{pedidos[k].id,
+                                             indice(ck.em(cf.t)),
+                                             indice(ck.em(cf.t + 1)), cf.t});
+      filho.custo -= filho.caminhos[k].custo;
+      if (!busca.planejar(pedidos[k], t0, tabela, filho.restricoes,
+                          filho.caminhos[k]))
+        continue;
+      filho.custo += filho.caminhos[k].custo;
+      nos.push_back(filho);
+      aberta.push_back(Aberto(-filho.custo, nos.size() - 1));
+      std::push_heap(aberta.begin(), aberta.end());
+    }
+  }
+  nos_cbs = nos.size();
+  return false;
+}
+
+void caminhoParaRota(const CaminhoTemporal &caminho,
+                     const GradeNavegacao &grade, float duracao_slot,
+                     std::deque<Point> &rota) {
+  int espera = 0;
+  int dx_ant = 0, dy_ant = 0;
+  float v_ant = -1.0f;
+  for (size_t k = 1; k < caminho.celulas.size(); ++k) {
+    const Celula &de = caminho.celulas[k - 1];
+    const Celula &para = caminho.celulas[k];
+    int dx = para.x - de.x, dy = para.y - de.y;
+    if (dx == 0 && dy == 0) {
+      ++espera;
+      continue;
+    }
+    float dist = grade.tamanhoCelula() * ((dx != 0 && dy != 0) ? SQRT2 : 1.0f);
+    float v = dist / ((espera + 1) * duracao_slot);
+    Point p = grade.paraMundo(para, v);
+    // Passos seguidos na mesma direção e velocidade viram um só waypoint
+    if (dx == dx_ant && dy == dy_ant && v == v_ant && espera == 0)
+      rota.back() = p;
+    else
+      rota.push_back(p);
+    espera = 0;
+    dx_ant = dx;
+    dy_ant = dy;
+    v_ant = v;
+  }
+}
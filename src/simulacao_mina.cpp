@@ -1,4 +1,8 @@
 #include "simulacao_mina.h"
+#include "mapa_ocupacao.h"
+#include "modelo_veiculo.h"
+#include "utils/medidor_periodo.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
@@ -10,7 +14,7 @@ const float TRUCK_LENGTH = 4.8f;
 
 SimulacaoMina::SimulacaoMina(const std::vector<std::vector<char>> &mapa_ref,
                              int num_caminhoes)
-    : mapa(mapa_ref), dt(0.1f) {
+    : mapa(mapa_ref), ocupacao(criar_mapa_ocupacao(mapa_ref)), dt(0.1f) {
 
   // Inicializa a frota
   for (int i = 0; i < num_caminhoes; ++i) {
@@ -48,6 +52,8 @@ SimulacaoMina::SimulacaoMina(const std::vector<std::vector<char>> &mapa_ref,
     c.i_falha_eletrica = false;
     c.i_falha_hidraulica = false;
     c.i_lidar_distancia = 100.0f; // Distância inicial segura
+    c.seq = 0;
+    c.t_amostra_us = 0;
 
     // std::cout << "[DEBUG-INIT] Caminhao " << i << " criado. Pos: (" <<
     // start_x
@@ -60,9 +66,13 @@ SimulacaoMina::SimulacaoMina(const std::vector<std::vector<char>> &mapa_ref,
 
 void SimulacaoMina::atualizar_passo_tempo() {
   std::lock_guard<std::mutex> lock(mtx_simulacao);
+  int64_t agora = relogio_monotonico_us();
   for (auto &caminhao : frota) {
     modelo_bicicleta(caminhao);
     modelo_maquina_termica(caminhao);
+    // Carimbo de origem da amostra (sequência por caminhão)
+    ++caminhao.seq;
+    caminhao.t_amostra_us = agora;
   }
 }
 
@@ -71,42 +81,15 @@ void SimulacaoMina::modelo_bicicleta(CaminhaoFisico &caminhao) {
   // std::cout << "[DEBUG-PRE-UPD] Vel: " << caminhao.velocidade << " Acel: " <<
   // caminhao.o_aceleracao << std::endl;
 
-  // 1. Atualiza velocidade baseado na aceleração (conversão de % para
-  // aceleração real) o_aceleracao vai de -100 a 100%, convertemos para m/s²
-  float aceleracao_real = caminhao.o_aceleracao * 0.2f; // Máximo de 20 m/s²
-  caminhao.velocidade += aceleracao_real * dt;
-
-  // Limita velocidade (não pode ser negativa em modelo simplificado)
-  if (caminhao.velocidade < 0.0f)
-    caminhao.velocidade = 0.0f;
-  if (caminhao.velocidade > 25.0f)
-    caminhao.velocidade = 25.0f; // Limite máximo ~90 km/h
-
-  // 2. Atualiza direção baseado no comando o_direcao
-  // No modo manual, o_direcao já é o ângulo absoluto
-  // Aplicamos uma taxa de giro gradual para suavizar
-  float diff_angulo = caminhao.o_direcao - caminhao.i_angulo_x;
-  while (diff_angulo > 180.0f)
-    diff_angulo -= 360.0f;
-  while (diff_angulo < -180.0f)
-    diff_angulo += 360.0f;
-
-  float taxa_giro = 50.0f; // graus por segundo
-  float ajuste =
-      std::max(-taxa_giro * dt, std::min(taxa_giro * dt, diff_angulo));
-  caminhao.i_angulo_x += ajuste;
-
-  if (caminhao.i_angulo_x >= 360.0f)
-    caminhao.i_angulo_x -= 360.0f;
-  if (caminhao.i_angulo_x < 0.0f)
-    caminhao.i_angulo_x += 360.0f;
-
-  // 3. Calcula nova posição baseada na velocidade e direção
-  float rad_ang = caminhao.i_angulo_x * M_PI / 180.0f;
-  float next_x =
-      caminhao.i_posicao_x + caminhao.velocidade * std::cos(rad_ang) * dt;
-  float next_y =
-      caminhao.i_posicao_y + caminhao.velocidade * std::sin(rad_ang) * dt;
+  // 1-3. Velocidade, direção (taxa de giro limitada) e próxima posição; o
+  // mesmo modelo gera as primitivas do controlador MPC
+  EstadoCinematico e{caminhao.i_posicao_x, caminhao.i_posicao_y,
+                     caminhao.i_angulo_x, caminhao.velocidade};
+  avancar_bicicleta(e, caminhao.o_aceleracao, caminhao.o_direcao, dt);
+  caminhao.velocidade = e.velocidade;
+  caminhao.i_angulo_x = e.angulo;
+  float next_x = e.x;
+  float next_y = e.y;
 
   if (verificar_colisao(next_x, next_y, caminhao.i_angulo_x)) {
     // Colisão detectada: Para o caminhão e inverte direção
@@ -136,34 +119,22 @@ void SimulacaoMina::modelo_bicicleta(CaminhaoFisico &caminhao) {
 float SimulacaoMina::calcular_lidar(const CaminhaoFisico &caminhao) {
   float x = caminhao.i_posicao_x;
   float y = caminhao.i_posicao_y;
-  float ang_rad = caminhao.i_angulo_x * M_PI / 180.0f;
-  float dx = std::cos(ang_rad);
-  float dy = std::sin(ang_rad);
+  float dx = cos_graus(caminhao.i_angulo_x);
+  float dy = sen_graus(caminhao.i_angulo_x);
 
   float max_dist = 100.0f;
-  float step_size = 1.0f; // 1 meter precision (was CELL_SIZE/2 = 5m)
-  float dist = 0.0f;
 
-  while (dist < max_dist) {
-    dist += step_size;
-    float check_x = x + dx * dist;
-    float check_y = y + dy * dist;
-
-    int grid_x = static_cast<int>(check_x / CELL_SIZE);
-    int grid_y = static_cast<int>(check_y / CELL_SIZE);
-
-    // Check bounds
-    if (grid_y < 0 || grid_y >= (int)mapa.size() || grid_x < 0 ||
-        grid_x >= (int)mapa[0].size()) {
-      return dist; // Hit world edge
-    }
-
-    // Check wall
-    if (mapa[grid_y][grid_x] == '1') {
-      return dist; // Hit wall
-    }
-  }
-  return max_dist;
+  // Raycast no backend de ocupação (em unidades de célula). O grid avança
+  // célula a célula; a quadtree salta blocos livres inteiros.
+  float dist_celulas = ocupacao->raycast(x / CELL_SIZE, y / CELL_SIZE, dx, dy,
+                                         max_dist / CELL_SIZE);
+  float dist = dist_celulas * CELL_SIZE;
+  if (dist >= max_dist)
+    return max_dist;
+
+  // Mantém a resolução de 1 metro do sensor (primeiro passo inteiro dentro
+  // da parede ou fora do mundo)
+  return std::max(1.0f, std::ceil(dist));
 }
 
 void SimulacaoMina::modelo_maquina_termica(CaminhaoFisico &caminhao) {
@@ -183,9 +154,8 @@ void SimulacaoMina::modelo_maquina_termica(CaminhaoFisico &caminhao) {
 }
 
 bool SimulacaoMina::verificar_colisao(float x, float y, float angulo) {
-  float rad = angulo * M_PI / 180.0f;
-  float cos_a = std::cos(rad);
-  float sin_a = std::sin(rad);
+  float cos_a = cos_graus(angulo);
+  float sin_a = sen_graus(angulo);
 
   float w2 = TRUCK_WIDTH / 2.0f;
   float l2 = TRUCK_LENGTH / 2.0f;
@@ -193,29 +163,28 @@ bool SimulacaoMina::verificar_colisao(float x, float y, float angulo) {
   float corners_x[] = {l2, l2, -l2, -l2};
   float corners_y[] = {-w2, w2, -w2, w2};
 
-  int map_height = mapa.size();
-  int map_width = mapa[0].size();
-
+  int grid_xs[4], grid_ys[4];
   for (int i = 0; i < 4; i++) {
     float global_x = x + (corners_x[i] * cos_a - corners_y[i] * sin_a);
     float global_y = y + (corners_x[i] * sin_a + corners_y[i] * cos_a);
 
-    int grid_x = static_cast<int>(global_x / CELL_SIZE);
-    int grid_y = static_cast<int>(global_y / CELL_SIZE);
+    grid_xs[i] = static_cast<int>(std::floor(global_x / CELL_SIZE));
+    grid_ys[i] = static_cast<int>(std::floor(global_y / CELL_SIZE));
+  }
 
-    if (grid_x < 0 || grid_x >= map_width || grid_y < 0 ||
-        grid_y >= map_height) {
-      // std::cout << "[DEBUG-COLISAO] Fora do mapa: " << grid_x << "," <<
-      // grid_y
-      //<< std::endl;
-      return true;
-    }
-    if (mapa[grid_y][grid_x] == '1') {
-      // std::cout << "[DEBUG-COLISAO] Parede em: " << grid_x << "," << grid_y
-      //           << " (Global: " << global_x << "," << global_y << ")"
-      //           << std::endl;
+  // Caminho rápido: se a caixa envolvente dos cantos está livre, nenhum canto
+  // colide (na quadtree isso resolve blocos livres sem visitar células).
+  int min_x = *std::min_element(grid_xs, grid_xs + 4);
+  int max_x = *std::max_element(grid_xs, grid_xs + 4);
+  int min_y = *std::min_element(grid_ys, grid_ys + 4);
+  int max_y = *std::max_element(grid_ys, grid_ys + 4);
+  if (ocupacao->regiao_livre(min_x, min_y, max_x, max_y))
+    return false;
+
+  // Fora do mapa ou parede em algum canto
+  for (int i = 0; i < 4; i++) {
+    if (ocupacao->ocupado(grid_xs[i], grid_ys[i]))
       return true;
-    }
   }
   return false;
 }
@@ -228,6 +197,21 @@ CaminhaoFisico SimulacaoMina::getEstadoReal(int id_caminhao) {
   return CaminhaoFisico();
 }
 
+void SimulacaoMina::posicionarCaminhao(int id_caminhao, float x, float y,
+                                       float angulo) {
+  std::lock_guard<std::mutex> lock(mtx_simulacao);
+  if (id_caminhao >= 0 && id_caminhao < (int)frota.size()) {
+    CaminhaoFisico &c = frota[id_caminhao];
+    c.i_posicao_x = x;
+    c.i_posicao_y = y;
+    c.i_angulo_x = angulo;
+    c.velocidade = 0.0f;
+    c.o_aceleracao = 0.0f;
+    c.o_direcao = angulo;
+    c.i_lidar_distancia = calcular_lidar(c);
+  }
+}
+
 void SimulacaoMina::setComandoAtuador(int id_caminhao, int aceleracao,
                                       int direcao) {
   std::lock_guard<std::mutex> lock(mtx_simulacao);
@@ -164,6 +164,8 @@ int main() {
       j["vel"] = estado.velocidade;
       j["temp"] = estado.i_temperatura;
       j["lidar"] = estado.i_lidar_distancia;
+      j["seq"] = estado.seq;
+      j["t_us"] = estado.t_amostra_us;
 
       std::string payload = j.dump();
       mosquitto_publish(mosq, NULL, "caminhao/sensores", payload.length(),
@@ -0,0 +1,177 @@
+#include "sintonia_ganhos.h"
+#include "perfil_velocidade.h"
+#include "simulacao_mina.h"
+#include "utils/trigonometria.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Filtro dos sensores, como em task_tratamento_sensores (K = 2 / (1 + 10))
+const float K_EMA_SENSOR = 2.0f / 11.0f;
+const float DESVIO_POSICAO = 1.0f; // m
+const float DESVIO_ANGULO = 2.0f;  // graus
+
+// Tempo máximo por cenário: folga sobre o tempo previsto pelo perfil
+const float FATOR_TEMPO_LIMITE = 3.0f;
+const float FOLGA_TEMPO_LIMITE = 20.0f; // s
+
+// Tempo de percurso do perfil, com velocidade mínima na partida do repouso
+float tempo_perfil(const PerfilVelocidade &perfil) {
+  const std::vector<AmostraPerfil> &a = perfil.amostras();
+  float t = 0.0f;
+  for (size_t i = 1; i < a.size(); ++i) {
+    float v = 0.5f * (a[i].velocidade + a[i - 1].velocidade);
+    t += (a[i].s - a[i - 1].s) / std::max(v, 0.5f);
+  }
+  return t;
+}
+
+} // namespace
+
+bool montar_cenario(std::shared_ptr<const std::vector<std::vector<char>>> mapa,
+                    float x0, float y0, float x1, float y1,
+                    const Rota &rota, unsigned semente,
+                    CenarioSintonia &cenario) {
+  std::shared_ptr<PerfilVelocidade> perfil =
+      std::make_shared<PerfilVelocidade>();
+  perfil->construir(x0, y0, 0.0f, rota);
+  if (perfil->vazio() || perfil->comprimento() < RAIO_CHEGADA)
+    return false;
+
+  // Parte alinhado com o início da curva
+  size_t dica = 0;
+  float ax, ay;
+  perfil->pontoEm(10.0f, dica, ax, ay);
+  float angulo = atan2_graus(ay - y0, ax - x0);
+  if (angulo < 0.0f)
+    angulo += 360.0f;
+
+  cenario.mapa = mapa;
+  cenario.x0 = x0;
+  cenario.y0 = y0;
+  cenario.angulo0 = angulo;
+  cenario.x1 = x1;
+  cenario.y1 = y1;
+  cenario.perfil = perfil;
+  cenario.tempo_nominal = tempo_perfil(*perfil);
+  cenario.semente = semente;
+  return true;
+}
+
+MetricasGanhos avaliar_ganhos(const CenarioSintonia &cenario,
+                              const GanhosControle &ganhos) {
+  MetricasGanhos m;
+  m.cenarios = 1;
+  const PerfilVelocidade &perfil = *cenario.perfil;
+
+  SimulacaoMina sim(*cenario.mapa, 1);
+  sim.posicionarCaminhao(0, cenario.x0, cenario.y0, cenario.angulo0);
+
+  // Mesmo ruído em todas as avaliações do cenário: a comparação entre
+  // ganhos não depende da sorte
+  std::mt19937 gerador(cenario.semente);
+  std::normal_distribution<float> ruido_pos(0.0f, DESVIO_POSICAO);
+  std::normal_distribution<float> ruido_ang(0.0f, DESVIO_ANGULO);
+
+  LoteControle lote;
+  lote.redimensionar(1);
+  DicasPerfil dicas;
+  float ema_x = 0.0f, ema_y = 0.0f, ema_ang = 0.0f;
+
+  const float limite =
+      FATOR_TEMPO_LIMITE * cenario.tempo_nominal + FOLGA_TEMPO_LIMITE;
+  float t = 0.0f, soma_erro = 0.0f;
+  int passos = 0;
+  bool perto_parede = false, chegou = false;
+  float angulo_anterior = cenario.angulo0;
+
+  for (; t < limite; t += DT_SINTONIA, ++passos) {
+    CaminhaoFisico real = sim.getEstadoReal(0);
+
+    // Erro de seguimento: distância à curva no comprimento de arco atual
+    size_t dica_erro = dicas.perfil;
+    float s = perfil.localizar(real.i_posicao_x, real.i_posicao_y, dica_erro);
+    float cx, cy;
+    size_t dica_ponto = dica_erro;
+    perfil.pontoEm(s, dica_ponto, cx, cy);
+    soma_erro += std::hypot(real.i_posicao_x - cx, real.i_posicao_y - cy);
+
+    // Colisão: o simulador para o caminhão e o vira ~180 graus num passo,
+    // o que o limite de taxa de giro nunca produz
+    float giro = real.i_angulo_x - angulo_anterior;
+    giro -= 360.0f * std::floor((giro + 180.0f) / 360.0f);
+    if (std::fabs(giro) > 90.0f)
+      ++m.colisoes;
+    angulo_anterior = real.i_angulo_x;
+
+    // CAS: conta cada aproximação, não cada ciclo abaixo do limiar
+    bool perto = real.i_lidar_distancia < DISTANCIA_DISPARO_CAS;
+    if (perto && !perto_parede)
+      ++m.disparos_cas;
+    perto_parede = perto;
+
+    if (std::hypot(real.i_posicao_x - cenario.x1,
+                   real.i_posicao_y - cenario.y1) < RAIO_CHEGADA &&
+        real.velocidade < 1.0f) {
+      chegou = true;
+      break;
+    }
+
+    // Sensores: ruído, quantização e EMA, como a tarefa de sensores
+    float px = (float)(int)(real.i_posicao_x + ruido_pos(gerador));
+    float py = (float)(int)(real.i_posicao_y + ruido_pos(gerador));
+    float pa = (float)(int)(real.i_angulo_x + ruido_ang(gerador));
+    if (passos == 0) {
+      ema_x = px;
+      ema_y = py;
+      ema_ang = normalizar_graus(pa);
+    } else {
+      ema_x += (px - ema_x) * K_EMA_SENSOR;
+      ema_y += (py - ema_y) * K_EMA_SENSOR;
+      ema_ang = media_movel_angulo(pa, ema_ang, K_EMA_SENSOR);
+    }
+    float x = (float)(int)ema_x, y = (float)(int)ema_y;
+    float v = (float)(int)real.velocidade;
+
+    // Lei de controle da navegação
+    lote.x[0] = x;
+    lote.y[0] = y;
+    lote.angulo[0] = (float)(int)ema_ang;
+    lote.velocidade[0] = v;
+    referencia_perfil(perfil, x, y, v, ganhos, dicas, lote.v_ref[0],
+                      lote.alvo_x[0], lote.alvo_y[0]);
+    calcular_controle_lote(lote, DT_SINTONIA, ganhos);
+
+    sim.setComandoAtuador(0, lote.aceleracao[0], lote.direcao[0]);
+    sim.atualizar_passo_tempo();
+  }
+
+  m.erro_medio = passos > 0 ? soma_erro / passos : 0.0f;
+  if (!chegou) {
+    ++m.nao_chegou;
+    t = limite;
+  }
+  m.tempo_relativo = t / std::max(cenario.tempo_nominal, DT_SINTONIA);
+  return m;
+}
+
+MetricasGanhos avaliar_ganhos(const std::vector<CenarioSintonia> &cenarios,
+                              const GanhosControle &ganhos) {
+  MetricasGanhos total;
+  for (const CenarioSintonia &c : cenarios) {
+    MetricasGanhos m = avaliar_ganhos(c, ganhos);
+    total.erro_medio += m.erro_medio;
+    total.tempo_relativo += m.tempo_relativo;
+    total.disparos_cas += m.disparos_cas;
+    total.colisoes += m.colisoes;
+    total.nao_chegou += m.nao_chegou;
+    total.cenarios += m.cenarios;
+  }
+  if (total.cenarios > 0) {
+    total.erro_medio /= total.cenarios;
+    total.tempo_relativo /= total.cenarios;
+  }
+  return total;
+}
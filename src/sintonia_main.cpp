@@ -0,0 +1,282 @@
+#include "controle_lote.h"
+#include "grafo_tuneis.h"
+#include "mine_generator.h"
+#include "planejador_rota.h"
+#include "sintonia_ganhos.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Sintonia dos ganhos da navegação: busca aleatória seguida de mutações dos
+// melhores, cada candidato avaliado em malha fechada contra SimulacaoMina em
+// todos os cenários. Os candidatos de uma rodada rodam em paralelo.
+//
+// Uso: bin/sintonia [avaliacoes] [threads] [arquivo_saida]
+// Grava o melhor conjunto em arquivo_saida (padrão ganhos.conf, lido pelo
+// app) e a fronteira de Pareto em sintonia_pareto.csv.
+
+namespace {
+
+const int MAPAS = 3;
+const int ROTAS_POR_MAPA = 8;
+const float VELOCIDADE_CENARIO = 15.0f; // m/s, velocidade dos trechos
+const int TAMANHO_MAPA = 61;
+
+// Pontuação: erro (m) + PESO_TEMPO * tempo relativo + PESO_INCIDENTE *
+// incidentes por cenário
+const float PESO_TEMPO = 2.0f;
+const float PESO_INCIDENTE = 10.0f;
+
+const float FRACAO_ALEATORIA = 0.4f; // Parte do orçamento em busca aleatória
+const size_t ELITE = 8;              // Pais das mutações
+const float DESVIO_MUTACAO = 0.15f;  // Relativo à faixa do parâmetro
+
+// Parâmetros sintonizados e faixa de busca
+struct FaixaGanho {
+  const char *nome;
+  float GanhosControle::*campo;
+  float minimo, maximo;
+};
+
+const FaixaGanho FAIXAS[] = {
+    {"kp_vel", &GanhosControle::kp_vel, 5.0f, 40.0f},
+    {"ki_vel", &GanhosControle::ki_vel, 5.0f, 40.0f},
+    {"entre_eixos", &GanhosControle::entre_eixos, 3.0f, 9.0f},
+    {"k_antecipacao", &GanhosControle::k_antecipacao, 0.5f, 2.0f},
+    {"antecipacao_min", &GanhosControle::antecipacao_min, 1.5f, 6.0f},
+    {"antecipacao_vel_s", &GanhosControle::antecipacao_vel_s, 0.0f, 1.5f},
+    {"antecipacao_vel_min", &GanhosControle::antecipacao_vel_min, 0.0f, 5.0f},
+};
+
+struct Candidato {
+  GanhosControle ganhos;
+  MetricasGanhos metricas;
+  float pontuacao;
+};
+
+float pontuar(const MetricasGanhos &m) {
+  float n = (float)std::max(1, m.cenarios);
+  return m.erro_medio + PESO_TEMPO * m.tempo_relativo +
+         PESO_INCIDENTE * m.incidentes() / n;
+}
+
+float centro_celula(int c) {
+  return c * TAMANHO_CELULA_PADRAO + TAMANHO_CELULA_PADRAO / 2.0f;
+}
+
+// Rotas entre nós do grafo de túneis (a primeira sai da zona de partida)
+void gerar_cenarios(std::mt19937 &gerador,
+                    std::vector<CenarioSintonia> &cenarios) {
+  unsigned semente = 1;
+  for (int i = 0; i < MAPAS; ++i) {
+    MineGenerator gen(TAMANHO_MAPA, TAMANHO_MAPA);
+    gen.generate();
+    std::shared_ptr<const std::vector<std::vector<char>>> mapa =
+        std::make_shared<std::vector<std::vector<char>>>(gen.getMinefield());
+    const std::vector<NoGrafo> &nos = gen.getGrafo().nos();
+    if (nos.size() < 2)
+      continue;
+
+    PlanejadorRota planejador;
+    planejador.setMapa(*mapa);
+    std::uniform_int_distribution<size_t> sorteio(0, nos.size() - 1);
+
+    int rotas = 0;
+    for (int tentativa = 0;
+         rotas < ROTAS_POR_MAPA && tentativa < 10 * ROTAS_POR_MAPA;
+         ++tentativa) {
+      const NoGrafo &a = tentativa == 0 ? nos[0] : nos[sorteio(gerador)];
+      const NoGrafo &b = nos[sorteio(gerador)];
+      float x0 = centro_celula(a.x), y0 = centro_celula(a.y);
+      float x1 = centro_celula(b.x), y1 = centro_celula(b.y);
+      Rota rota;
+      CenarioSintonia c;
+      if (planejador.planejar(x0, y0, x1, y1, VELOCIDADE_CENARIO, rota) &&
+          montar_cenario(mapa, x0, y0, x1, y1, rota, semente++, c)) {
+        cenarios.push_back(c);
+        ++rotas;
+      }
+    }
+  }
+}
+
+GanhosControle sortear(std::mt19937 &gerador) {
+  GanhosControle g;
+  for (const FaixaGanho &f : FAIXAS)
+    g.*f.campo =
+        std::uniform_real_distribution<float>(f.minimo, f.maximo)(gerador);
+  return g;
+}
+
+GanhosControle mutar(const GanhosControle &pai, std::mt19937 &gerador) {
+  GanhosControle g = pai;
+  std::normal_distribution<float> ruido(0.0f, DESVIO_MUTACAO);
+  for (const FaixaGanho &f : FAIXAS) {
+    float v = g.*f.campo + ruido(gerador) * (f.maximo - f.minimo);
+    g.*f.campo = std::min(f.maximo, std::max(f.minimo, v));
+  }
+  return g;
+}
+
+// Avalia candidatos[inicio, fim) em paralelo; cada thread pega o próximo
+// índice livre, então rodadas desbalanceadas não deixam núcleos ociosos
+void avaliar_rodada(std::vector<Candidato> &candidatos, size_t inicio,
+                    const std::vector<CenarioSintonia> &cenarios,
+                    unsigned num_threads) {
+  std::atomic<size_t> proximo(inicio);
+  auto trabalhador = [&]() {
+    for (size_t i = proximo++; i < candidatos.size(); i = proximo++) {
+      Candidato &c = candidatos[i];
+      c.metricas = avaliar_ganhos(cenarios, c.ganhos);
+      c.pontuacao = pontuar(c.metricas);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < num_threads; ++t)
+    threads.emplace_back(trabalhador);
+  for (std::thread &t : threads)
+    t.join();
+}
+
+bool domina(const MetricasGanhos &a, const MetricasGanhos &b) {
+  bool melhor_ou_igual = a.erro_medio <= b.erro_medio &&
+                         a.tempo_relativo <= b.tempo_relativo &&
+                         a.incidentes() <= b.incidentes();
+  bool estritamente = a.erro_medio < b.erro_medio ||
+                      a.tempo_relativo < b.tempo_relativo ||
+                      a.incidentes() < b.incidentes();
+  return melhor_ou_igual && estritamente;
+}
+
+std::vector<const Candidato *>
+fronteira_pareto(const std::vector<Candidato> &candidatos) {
+  std::vector<const Candidato *> fronteira;
+  for (const Candidato &c : candidatos) {
+    bool dominado = false;
+    for (const Candidato &o : candidatos) {
+      if (domina(o.metricas, c.metricas)) {
+        dominado = true;
+        break;
+      }
+    }
+    if (!dominado)
+      fronteira.push_back(&c);
+  }
+  return fronteira;
+}
+
+std::string resumo(const MetricasGanhos &m) {
+  std::ostringstream s;
+  s << "erro " << m.erro_medio << " m, tempo " << m.tempo_relativo
+    << "x, CAS " << m.disparos_cas << ", colisoes " << m.colisoes
+    << ", sem chegada " << m.nao_chegou << " (" << m.cenarios
+    << " cenarios)";
+  return s.str();
+}
+
+void gravar_pareto(const std::string &arquivo,
+                   const std::vector<const Candidato *> &fronteira) {
+  std::ofstream f(arquivo);
+  for (const FaixaGanho &g : FAIXAS)
+    f << g.nome << ",";
+  f << "erro_medio,tempo_relativo,disparos_cas,colisoes,nao_chegou,"
+       "pontuacao\n";
+  for (const Candidato *c : fronteira) {
+    for (const FaixaGanho &g : FAIXAS)
+      f << c->ganhos.*g.campo << ",";
+    const MetricasGanhos &m = c->metricas;
+    f << m.erro_medio << "," << m.tempo_relativo << "," << m.disparos_cas
+      << "," << m.colisoes << "," << m.nao_chegou << "," << c->pontuacao
+      << "\n";
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t avaliacoes = argc > 1 ? std::atoi(argv[1]) : 192;
+  unsigned num_threads = argc > 2 ? std::atoi(argv[2]) : 0;
+  std::string saida = argc > 3 ? argv[3] : "ganhos.conf";
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  avaliacoes = std::max<size_t>(avaliacoes, 1);
+
+  std::mt19937 gerador(42);
+  std::vector<CenarioSintonia> cenarios;
+  gerar_cenarios(gerador, cenarios);
+  if (cenarios.empty()) {
+    std::cerr << "[Sintonia] Nenhum cenario planejado." << std::endl;
+    return 1;
+  }
+  std::cout << "[Sintonia] " << cenarios.size() << " cenarios, "
+            << avaliacoes << " avaliacoes, " << num_threads << " threads"
+            << std::endl;
+
+  auto inicio = std::chrono::steady_clock::now();
+
+  // Rodada 0: ganhos atuais (referência) e amostras aleatórias
+  std::vector<Candidato> candidatos(1);
+  candidatos[0].ganhos = carregar_ganhos_controle(saida);
+  size_t aleatorios = std::max<size_t>(1, avaliacoes * FRACAO_ALEATORIA);
+  while (candidatos.size() < std::min(avaliacoes, aleatorios + 1)) {
+    candidatos.push_back(Candidato());
+    candidatos.back().ganhos = sortear(gerador);
+  }
+  avaliar_rodada(candidatos, 0, cenarios, num_threads);
+  const MetricasGanhos referencia = candidatos[0].metricas;
+  std::cout << "[Sintonia] Referencia: " << resumo(referencia) << std::endl;
+
+  // Rodadas seguintes: mutações dos melhores até esgotar o orçamento
+  std::vector<Candidato> elite;
+  while (candidatos.size() < avaliacoes) {
+    elite = candidatos;
+    size_t k = std::min(ELITE, elite.size());
+    std::partial_sort(elite.begin(), elite.begin() + k, elite.end(),
+                      [](const Candidato &a, const Candidato &b) {
+                        return a.pontuacao < b.pontuacao;
+                      });
+    size_t rodada = std::min<size_t>(avaliacoes - candidatos.size(),
+                                     std::max<size_t>(k, num_threads));
+    size_t primeiro = candidatos.size();
+    for (size_t i = 0; i < rodada; ++i) {
+      candidatos.push_back(Candidato());
+      candidatos.back().ganhos = mutar(elite[i % k].ganhos, gerador);
+    }
+    avaliar_rodada(candidatos, primeiro, cenarios, num_threads);
+  }
+
+  const Candidato &melhor = *std::min_element(
+      candidatos.begin(), candidatos.end(),
+      [](const Candidato &a, const Candidato &b) {
+        return a.pontuacao < b.pontuacao;
+      });
+  double segundos = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - inicio)
+                        .count();
+  std::cout << "[Sintonia] Melhor:     " << resumo(melhor.metricas)
+            << std::endl;
+  std::cout << "[Sintonia] " << candidatos.size() * cenarios.size()
+            << " simulacoes em " << segundos << " s" << std::endl;
+
+  std::ostringstream cabecalho;
+  cabecalho << "Gerado por bin/sintonia (" << candidatos.size()
+            << " avaliacoes)\n"
+            << "Melhor: " << resumo(melhor.metricas) << "\n"
+            << "Referencia: " << resumo(referencia);
+  if (!salvar_ganhos_controle(saida, melhor.ganhos, cabecalho.str())) {
+    std::cerr << "[Sintonia] Nao foi possivel gravar " << saida << std::endl;
+    return 1;
+  }
+  std::vector<const Candidato *> fronteira = fronteira_pareto(candidatos);
+  gravar_pareto("sintonia_pareto.csv", fronteira);
+  std::cout << "[Sintonia] Ganhos em " << saida << ", " << fronteira.size()
+            << " conjuntos de Pareto em sintonia_pareto.csv" << std::endl;
+  return 0;
+}
@@ -1,25 +1,63 @@
 #include "task_collision_avoidance.h"
-#include "utils/sleep_asynch.h"
+#include "perfil_velocidade.h"
+#include "utils/medidor_periodo.h"
+#include "utils/trigonometria.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <thread>
 
 // Configurações de Segurança
-const float SAFE_DISTANCE_METERS = 8.0f; // Distância mínima segura (Refined)
-const int FAULT_CODE_OBSTACLE = 4;       // Código de falha para obstáculo
+const float SAFE_DISTANCE_METERS = 8.0f;     // Distância mínima segura (Refined)
+const float CRITICAL_DISTANCE_METERS = 3.0f; // Abaixo disso não há desvio
+const int FAULT_CODE_OBSTACLE = 4; // Código de falha para obstáculo
+
+namespace {
+
+// Maior velocidade que ainda para antes da distância crítica, contando um
+// ciclo do CAS (t) de reação: v·t + v²/(2a) = d - crítica
+float velocidade_para_parar(float distancia, float t) {
+  float a = FRENAGEM_MAX_PERFIL;
+  float folga = std::max(0.0f, distancia - CRITICAL_DISTANCE_METERS);
+  return a * (std::sqrt(t * t + 2.0f * folga / a) - t);
+}
+
+} // namespace
 
 void task_collision_avoidance(GerenciadorDados &dados, EventosSistema &eventos,
-                              IVeiculoDriver &driver) {
+                              IVeiculoDriver &driver,
+                              std::chrono::steady_clock::duration periodo) {
   // std::cout << "[CAS] Task de Prevenção de Colisão INICIADA." << std::endl;
+  MedidorPeriodo relogio("CAS");
+  const float SEM_LIMITE = std::numeric_limits<float>::infinity();
+  float t_ciclo = std::chrono::duration<float>(periodo).count();
 
   while (true) {
+    relogio.acordou();
+
     // 1. Leitura de Alta Prioridade (Snapshot)
     DadosSensores estado = dados.lerUltimoEstado();
 
     // 2. Lógica de Segurança (Safety Kernel)
     // Se a distância for menor que o limiar seguro, ativa freio de emergência
     float distancia = estado.i_lidar_distancia;
-    if (distancia < SAFE_DISTANCE_METERS) {
+    if (distancia < SAFE_DISTANCE_METERS &&
+        distancia >= CRITICAL_DISTANCE_METERS &&
+        dados.getReplanejamentoAtivo()) {
+      // --- BLOQUEIO À FRENTE, COM MARGEM PARA DESVIAR ---
+      // O planejador marca a célula e repara a rota (D* Lite) no próximo
+      // ciclo; se o obstáculo chegar à distância crítica, intertrava abaixo.
+      // Até o desvio afastar o obstáculo, a navegação fica abaixo da
+      // velocidade que ainda para antes da distância crítica.
+      float ang = estado.i_angulo_x;
+      dados.reportarBloqueio(
+          {estado.i_posicao_x + distancia * cos_graus(ang),
+           estado.i_posicao_y + distancia * sen_graus(ang)});
+      dados.setLimiteVelocidade(velocidade_para_parar(distancia, t_ciclo));
+
+    } else if (distancia < SAFE_DISTANCE_METERS && !dados.getManobraRecuo()) {
       // --- SITUAÇÃO DE PERIGO DETECTADA ---
       // Violação de segurança detectada!
       // std::cout << "[CAS] PERIGO! Obstaculo detectado a " << distancia
@@ -40,6 +78,7 @@ void task_collision_avoidance(GerenciadorDados &dados, EventosSistema &eventos,
         //           << std::endl;
         eventos.sinalizar_falha(FAULT_CODE_OBSTACLE);
       }
+      dados.setLimiteVelocidade(SEM_LIMITE); // A falha já freia
 
     } else {
       // --- SITUAÇÃO SEGURA ---
@@ -47,10 +86,11 @@ void task_collision_avoidance(GerenciadorDados &dados, EventosSistema &eventos,
       // Opcional: Se a falha estava ativa e o obstáculo sumiu, poderíamos
       // tentar resetar? Por segurança, exigimos reset manual do operador (botão
       // R).
+      dados.setLimiteVelocidade(SEM_LIMITE);
     }
 
-    // 3. Loop de Alta Frequência (20Hz - 50ms)
+    // 3. Loop de Alta Frequência (padrão 20Hz - 50ms)
     // Deve ser rápido o suficiente para reagir antes da colisão
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::this_thread::sleep_until(relogio.proximo(periodo));
   }
 }
@@ -1,6 +1,9 @@
 #include "task_controle_navegacao.h"
+#include "controlador_mpc.h"
+#include "controle_lote.h"
 #include "gerenciador_dados.h"
 #include "interfaces/i_veiculo_driver.h"
+#include "perfil_velocidade.h"
 #include "utils/sleep_asynch.h" // Incluindo o utilitário de tempo preciso
 #include <algorithm>
 #include <boost/asio.hpp> // Motor assíncrono local
@@ -8,10 +11,10 @@
 #include <iostream>
 
 struct ControladorEstado {
-  // Speed Control (IP)
-  float kp_vel = 20.0f;
-  float ki_vel = 20.0f;
-  float integral_vel = 0.0f;
+  // Speed Control (IP) e Pure Pursuit: lote de um caminhão
+  GanhosControle ganhos;
+  LoteControle lote;
+  ControladorEstado() { lote.redimensionar(1); }
 
   // Heading Control (IP)
   float kp_ang = 1.0f;
@@ -21,43 +24,73 @@ struct ControladorEstado {
   // State Feedback Setpoints (Internal)
   float setpoint_velocidade = 0.0f;
   float setpoint_angulo = 0.0f;
+
+  // Perfil de velocidade da rota (consulta por comprimento de arco)
+  std::shared_ptr<const PerfilVelocidade> perfil;
+  DicasPerfil dicas; // Trechos consultados no ciclo anterior
 };
 
-void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos) {
+void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos,
+                             ModoNavegacao modo,
+                             std::chrono::steady_clock::duration periodo,
+                             bool encadeado, const GanhosControle &ganhos) {
   // 1. Configuração do Motor de Tempo Local (Loop de eventos dedicado)
   boost::asio::io_context io;
-  SleepAsynch timer(io);
+  SleepAsynch timer(io, "NAV");
+  const float dt_nominal = std::chrono::duration<float>(periodo).count();
+
+  // Modo encadeado: cada amostra nova do sensor dispara um ciclo; sem
+  // amostra, o ciclo roda no timeout para a lógica de segurança não parar
+  MedidorPeriodo medidor_encadeado("NAV");
+  const MedidorPeriodo &medidor =
+      encadeado ? medidor_encadeado : timer.medidor();
+  uint64_t seq_amostra = 0;
 
   // Estado do controlador persiste entre as chamadas do loop
   ControladorEstado controlador;
+  controlador.ganhos = ganhos;
+  ControladorMPC mpc; // Gera a biblioteca de primitivas aqui, fora do ciclo
 
   // 2. Definição do Loop Recursivo (Substitui o while(true) bloqueante)
   std::function<void()> loop_controle;
 
   loop_controle = [&]() {
     // --- INÍCIO DA LÓGICA DE CONTROLE (Crítica: deve rodar rápido) ---
-    float dt = 0.1f; // 10Hz
+    // dt medido entre despertares; limitado para que uma pausa longa (ou o
+    // primeiro ciclo) não injete um salto nos integradores
+    float dt = (float)medidor.ultimoPeriodo();
+    if (dt <= 0.0f || dt > 4.0f * dt_nominal)
+      dt = dt_nominal;
 
     // Ler Snapshot (Estado mais recente sem consumir do buffer de log)
-    DadosSensores leituraAtual = dados.lerUltimoEstado();
+    std::chrono::steady_clock::time_point instante_amostra;
+    DadosSensores leituraAtual =
+        dados.lerUltimoEstado(seq_amostra, instante_amostra);
     EstadoVeiculo estado = dados.getEstadoVeiculo();
     ComandosOperador comandos = dados.getComandosOperador();
 
     int saida_aceleracao = 0;
     int saida_direcao = 0;
+    bool publicar = true;
 
     // NEW: Read the Planner's order (Moved up for scope)
     ObjetivoNavegacao objetivo = dados.getObjetivo();
 
     // VERIFICAÇÃO DE SEGURANÇA VIA EVENTOS (Linha Vermelha)
     if (eventos.verificar_estado_falha()) {
-      saida_aceleracao = -100;      // Emergency Brake
-      controlador.integral_vel = 0; // Reset integrators on fault
+      saida_aceleracao = -100;              // Emergency Brake
+      controlador.lote.integral_vel[0] = 0; // Reset integrators on fault
+      controlador.integral_ang = 0;
+
+    } else if (dados.getManobraRecuo()) {
+      // Recuo pós-colisão: a lógica de comando dirige os atuadores
+      publicar = false;
+      controlador.lote.integral_vel[0] = 0;
       controlador.integral_ang = 0;
 
     } else if (estado.e_defeito) {
       saida_aceleracao = 0;
-      controlador.integral_vel = 0;
+      controlador.lote.integral_vel[0] = 0;
       controlador.integral_ang = 0;
 
     } else if (!estado.e_automatico) {
@@ -80,7 +113,7 @@ void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos) {
       controlador.setpoint_angulo = (float)leituraAtual.i_angulo_x;
 
       // Also reset integrators to avoid windup from previous auto sessions
-      controlador.integral_vel = 0;
+      controlador.lote.integral_vel[0] = 0;
       controlador.integral_ang = 0;
 
     } else {
@@ -88,122 +121,99 @@ void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos) {
       if (estado.e_automatico && objetivo.ativo) {
         // --- AUTOMATIC MODE (State Space Control - IP Topology) ---
 
-        // 1. Calculate Heading Error FIRST (needed for cornering speed)
+        // 1. Current pose and vector to the target waypoint
         float theta_atual = (float)leituraAtual.i_angulo_x;
         float x_atual = (float)leituraAtual.i_posicao_x;
         float y_atual = (float)leituraAtual.i_posicao_y;
 
         float dx = objetivo.x_alvo - x_atual;
         float dy = objetivo.y_alvo - y_atual;
-        float theta_ref = std::atan2(dy, dx) * 180.0f / M_PI;
 
-        float erro_ang = theta_ref - theta_atual;
-        // Normalize error to [-180, 180]
-        while (erro_ang > 180)
-          erro_ang -= 360;
-        while (erro_ang < -180)
-          erro_ang += 360;
-
-        // 2. Speed Control (IP) with Cornering Slowdown
+        // 2. Speed Control (IP) with planned speed profile
         float v_atual = (float)leituraAtual.i_velocidade;
         float v_ref = objetivo.velocidade_alvo;
 
-        // Cornering Logic: Slow down if error is large
-        // If error > 10 degrees, reduce speed.
-        float erro_abs = std::abs(erro_ang);
-        if (erro_abs > 10.0f) {
-          // User requested 4 m/s at 90 degrees (Base 20 m/s).
-          // Factor = 4/20 = 0.2.
-          // 0.2 = 1.0 - (90 / X) -> X = 112.5.
-          float factor = 1.0f - (std::min(erro_abs, 112.5f) / 112.5f);
-
-          v_ref = v_ref * factor;
-          // Min speed 2.0f to allow slowing down to 4.0f
-          if (v_ref < 2.0f)
-            v_ref = 2.0f;
+        // Curvas e frenagens já estão no perfil calculado pelo planejador;
+        // aqui só se consulta a velocidade no comprimento de arco atual
+        std::shared_ptr<const PerfilVelocidade> perfil =
+            dados.usarPerfilVelocidade();
+        if (perfil != controlador.perfil) {
+          controlador.perfil = perfil;
+          controlador.dicas = DicasPerfil();
         }
+        bool tem_perfil = perfil && !perfil->vazio();
 
-        float erro_vel = v_ref - v_atual;
-        controlador.integral_vel += erro_vel * dt;
-
-        // Anti-windup (Speed)
-        if (controlador.integral_vel > 100.0f)
-          controlador.integral_vel = 100.0f;
-        if (controlador.integral_vel < -100.0f)
-          controlador.integral_vel = -100.0f;
-
-        // IP Control Law: u = -Kp*y + Ki*Integral(e)
-        float u_acc = -controlador.kp_vel * v_atual +
-                      controlador.ki_vel * controlador.integral_vel;
-        saida_aceleracao = (int)u_acc;
-
-        // 3. Heading Control (Pure Pursuit)
-        // Replaces PID with a geometric path tracking algorithm.
-
-        const float WHEELBASE = 6.0f; // Truck Length/Wheelbase
-        const float K_LOOKAHEAD =
-            1.1f; // Lookahead gain (seconds) - User requested 1.1
-        const float MIN_LOOKAHEAD =
-            2.8f; // Minimum lookahead distance (meters) - User requested 2.8
-
-        // Calculate dynamic Lookahead Distance (Ld)
-        float ld = std::max(MIN_LOOKAHEAD, v_atual * K_LOOKAHEAD);
-
-        // Calculate distance to target waypoint
-        float dist_to_wp = std::sqrt(dx * dx + dy * dy);
-
-        // Determine Lookahead Point
+        // 3. Lookahead Point (Pure Pursuit) a Ld metros à frente
+        float ld = distancia_antecipacao(v_atual, controlador.ganhos);
         float target_x, target_y;
-        if (dist_to_wp > ld) {
-          float ratio = ld / dist_to_wp;
-          target_x = x_atual + dx * ratio;
-          target_y = y_atual + dy * ratio;
+        if (tem_perfil) {
+          referencia_perfil(*perfil, x_atual, y_atual, v_atual,
+                            controlador.ganhos, controlador.dicas, v_ref,
+                            target_x, target_y);
         } else {
-          // If waypoint is closer, aim at the waypoint.
-          target_x = objetivo.x_alvo;
-          target_y = objetivo.y_alvo;
-          // CRITICAL FIX: Do NOT reduce 'ld' to 'dist_to_wp'.
-          // Keeping 'ld' large acts as a dampener when close to the target,
-          // preventing infinite steering gain and oscillation.
+          // Sem perfil publicado: persegue só o waypoint atual
+          float dist_to_wp = std::sqrt(dx * dx + dy * dy);
+          if (dist_to_wp > ld) {
+            float ratio = ld / dist_to_wp;
+            target_x = x_atual + dx * ratio;
+            target_y = y_atual + dy * ratio;
+          } else {
+            target_x = objetivo.x_alvo;
+            target_y = objetivo.y_alvo;
+          }
         }
 
-        // Calculate Alpha (Angle between truck heading and lookahead point)
-        float dx_p = target_x - x_atual;
-        float dy_p = target_y - y_atual;
-        float angle_to_p = std::atan2(dy_p, dx_p) * 180.0f / M_PI;
-
-        float alpha = angle_to_p - theta_atual;
-        while (alpha > 180)
-          alpha -= 360;
-        while (alpha < -180)
-          alpha += 360;
-
-        // Pure Pursuit Control Law
-        // steering_angle = atan(2 * L * sin(alpha) / Ld)
-        // Note: alpha must be in radians for sin(), result is radians.
-        float alpha_rad = alpha * M_PI / 180.0f;
-        float steering_rad =
-            std::atan((2.0f * WHEELBASE * std::sin(alpha_rad)) / ld);
-        float steering_deg = steering_rad * 180.0f / M_PI;
-
-        // Apply correction to current heading
-        // Command = Current Heading + Steering Angle
-        float cmd_direcao = theta_atual + steering_deg;
-
-        // Normalize Command to 0-360
-        while (cmd_direcao > 360)
-          cmd_direcao -= 360;
-        while (cmd_direcao < 0)
-          cmd_direcao += 360;
-
-        saida_direcao = (int)cmd_direcao;
+        // Teto do CAS durante o desvio de um bloqueio: a referência não
+        // passa dele (o MPC segue o perfil e fica de fora até o teto cair)
+        float limite = dados.getLimiteVelocidade();
+        bool limitado = limite < v_ref;
+        v_ref = std::min(v_ref, limite);
+
+        // Malha IP de velocidade e lei de pure pursuit: o mesmo núcleo que
+        // calcula a frota em lote, aqui com um único caminhão
+        LoteControle &lote = controlador.lote;
+        lote.x[0] = x_atual;
+        lote.y[0] = y_atual;
+        lote.angulo[0] = theta_atual;
+        lote.velocidade[0] = v_atual;
+        lote.v_ref[0] = v_ref;
+        lote.alvo_x[0] = target_x;
+        lote.alvo_y[0] = target_y;
+        calcular_controle_lote(lote, dt, controlador.ganhos);
+        saida_aceleracao = lote.aceleracao[0];
+        saida_direcao = lote.direcao[0];
+
+        // 4. MPC: substitui as duas malhas quando há rota suavizada; acima
+        // do teto do CAS, freia
+        if (v_atual > limite) {
+          saida_aceleracao = -100;
+          controlador.lote.integral_vel[0] = 0;
+        } else if (modo == NAV_MPC && tem_perfil && !limitado) {
+          std::shared_ptr<const MapaFolga> folga = dados.getMapaFolga();
+          if (mpc.calcular(x_atual, y_atual, theta_atual, v_atual, *perfil,
+                           controlador.dicas.perfil, folga.get(),
+                           saida_aceleracao, saida_direcao)) {
+            // Retorno sem salto ao IP: integral recalculada para que a lei
+            // IP reproduza a aceleração aplicada pelo MPC
+            // (u = -Kp·v + Ki·∫e  =>  ∫e = (u + Kp·v) / Ki)
+            const GanhosControle &g = controlador.ganhos;
+            float u = (float)std::min(100, std::max(-100, saida_aceleracao));
+            float in = g.ki_vel != 0.0f ? (u + g.kp_vel * v_atual) / g.ki_vel
+                                        : 0.0f;
+            controlador.lote.integral_vel[0] = std::min(
+                g.limite_integral, std::max(-g.limite_integral, in));
+            if (mpc.ultimoTempoUs() > 1000.0f)
+              std::cerr << "[NAV] MPC acima do orcamento: "
+                        << mpc.ultimoTempoUs() << " us" << std::endl;
+          }
+        }
 
         // Saturação (Clamp Outputs)
         if (saida_aceleracao > 100)
           saida_aceleracao = 100;
         if (saida_aceleracao < -100)
           saida_aceleracao = -100;
-        // Direction is 0-360, no clamp needed other than normalization above.
+        // Direction is 0-360, already normalized by the control kernel.
 
       } else if (estado.e_automatico && !objetivo.ativo) {
         // Auto mode but no mission? Stop safely.
@@ -211,7 +221,7 @@ void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos) {
         // Keep current heading to avoid spinning while braking
         saida_direcao = (int)leituraAtual.i_angulo_x;
 
-        controlador.integral_vel = 0;
+        controlador.lote.integral_vel[0] = 0;
         controlador.integral_ang = 0;
       }
     }
@@ -220,7 +230,10 @@ void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos) {
     ComandosAtuador cmd;
     cmd.aceleracao = saida_aceleracao;
     cmd.direcao = saida_direcao;
-    dados.setComandosAtuador(cmd);
+    if (publicar && seq_amostra != 0)
+      dados.setComandosAtuador(cmd, instante_amostra);
+    else if (publicar)
+      dados.setComandosAtuador(cmd); // Ainda sem amostra do sensor
 
     // DEBUG: Print controller state every 1s (approx 10 cycles)
     static int debug_counter = 0;
@@ -230,7 +243,7 @@ void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos) {
       //           << " Obj:" << objetivo.ativo
       //           << " V_Ref:" << objetivo.velocidade_alvo
       //           << " V_Act:" << leituraAtual.i_velocidade
-      //           << " Int_Vel:" << controlador.integral_vel
+      //           << " Int_Vel:" << controlador.lote.integral_vel[0]
       //           << " U_Acc:" << saida_aceleracao
       //           << " Fault:" << eventos.verificar_estado_falha() <<
       //           std::endl;
@@ -238,8 +251,21 @@ void task_controle_navegacao(GerenciadorDados &dados, EventosSistema &eventos) {
 
     // --- FIM DA LÓGICA ---
 
-    // 3. Agendamento Preciso (Heartbeat de 10Hz)
-    timer.wait_next_tick(std::chrono::milliseconds(100),
+    if (encadeado) {
+      // 3. Próximo ciclo na próxima amostra (post evita recursão na pilha)
+      // O atraso conta da publicação da amostra; acordar mais de um período
+      // depois dela é estouro
+      dados.aguardarNovoEstado(seq_amostra, 2 * periodo);
+      uint64_t seq_nova;
+      std::chrono::steady_clock::time_point publicada;
+      dados.lerUltimoEstado(seq_nova, publicada);
+      medidor_encadeado.acordou(publicada, periodo);
+      boost::asio::post(io, [&]() { loop_controle(); });
+      return;
+    }
+
+    // 3. Agendamento Preciso (Heartbeat configurável, padrão 10Hz)
+    timer.wait_next_tick(periodo,
                          [&](const boost::system::error_code &ec) {
                            if (!ec)
                              loop_controle(); // Próximo ciclo
@@ -4,18 +4,32 @@
 #include <chrono>
 #include <functional>
 #include <iostream>
-#include <thread>
+
+// Manobra de recuo após rearme de colisão (código 4)
+const int FALHA_COLISAO = 4;
+const int ACELERACAO_RECUO = -50; // % de força, direção 0
+const std::chrono::seconds DURACAO_RECUO(2);
+
+/**
+ * Fases da manobra, avançadas a cada tick da própria tarefa: durante o recuo
+ * o laço continua processando falhas e comandos no período normal.
+ */
+enum FaseRecuo { RECUO_INATIVO, RECUO_EM_CURSO };
 
 void task_logica_comando(GerenciadorDados &gerenciadorDados,
-                         EventosSistema &eventos) {
+                         EventosSistema &eventos,
+                         std::chrono::steady_clock::duration periodo) {
   // 1. Configuração do Motor de Tempo Local (Exclusivo desta thread)
   boost::asio::io_context io;
-  SleepAsynch timer(io);
+  SleepAsynch timer(io, "COMANDO");
 
   // 2. Definição do Loop Recursivo (Substitui o while(true))
   // Usamos std::function para que o lambda possa chamar a si mesmo
   std::function<void()> loop_logica;
 
+  FaseRecuo fase_recuo = RECUO_INATIVO;
+  std::chrono::steady_clock::time_point fim_recuo;
+
   loop_logica = [&]() {
     // --- INÍCIO DA LÓGICA (Cópia da sua lógica original) ---
 
@@ -23,38 +37,65 @@ void task_logica_comando(GerenciadorDados &gerenciadorDados,
     ComandosOperador comandos = gerenciadorDados.getComandosOperador();
     EstadoVeiculo estado = gerenciadorDados.getEstadoVeiculo();
 
-    // --- LÓGICA DE REARME (Prioridade Máxima) ---
-    if (comandos.c_rearme) {
-      bool falha_ativa = eventos.verificar_estado_falha();
-      int codigo = eventos.getCodigoFalha();
-
-      // Se houver falha de colisão (Código 4), executa manobra de recuo
-      if (falha_ativa && codigo == 4) {
-        // std::cout << "[Logica] Rearme de COLISÃO. Iniciando Back-Off..." <<
-        // std::endl;
-
-        // 1. Recuar (Ré)
-        gerenciadorDados.setComandosAtuador({-50, 0}); // -50% força, 0 direção
-        std::this_thread::sleep_for(std::chrono::seconds(2)); // Bloqueia por 2s
-
-        // 2. Parar
+    // --- MANOBRA DE RECUO EM CURSO ---
+    if (fase_recuo == RECUO_EM_CURSO) {
+      if (eventos.verificar_estado_falha()) {
+        // Falha nova durante o recuo: aborta já com frenagem de emergência
+        // (a mesma da navegação em falha) e o defeito segue ativo
+        std::cout << "[Logica] Back-Off abortado: falha "
+                  << eventos.getCodigoFalha() << std::endl;
+        gerenciadorDados.setComandosAtuador({-100, 0});
+        fase_recuo = RECUO_INATIVO;
+        gerenciadorDados.setManobraRecuo(false);
+      } else if (std::chrono::steady_clock::now() >= fim_recuo) {
+        // Concluída: para e completa o rearme
         gerenciadorDados.setComandosAtuador({0, 0});
-
+        fase_recuo = RECUO_INATIVO;
+        gerenciadorDados.setManobraRecuo(false);
+
+        if (comandos.c_man) {
+          estado.e_automatico = false;
+        } else if (comandos.c_automatico) {
+          estado.e_automatico = true;
+        }
+        estado.e_defeito = false;
         // std::cout << "[Logica] Back-Off concluído." << std::endl;
+      } else {
+        // Reafirma o comando a cada tick (a navegação está suspensa)
+        gerenciadorDados.setComandosAtuador({ACELERACAO_RECUO, 0});
       }
+    }
+
+    // --- LÓGICA DE REARME (Prioridade Máxima) ---
+    if (comandos.c_rearme && fase_recuo == RECUO_INATIVO) {
+      bool falha_ativa = eventos.verificar_estado_falha();
+      int codigo = eventos.getCodigoFalha();
 
       // Resetar falhas (para qualquer tipo de falha)
       eventos.resetar_falhas();
 
-      // Modos de Operação (Prioridade para MANUAL)
-      if (comandos.c_man) {
-        estado.e_automatico = false;
-      } else if (comandos.c_automatico) {
-        estado.e_automatico = true;
+      if (falha_ativa && codigo == FALHA_COLISAO) {
+        // Colisão: o rearme só se completa ao fim da manobra de recuo. O
+        // defeito segue ativo (sem troca de modo) e a falha fica zerada para
+        // que qualquer falha nova aborte a manobra.
+        // std::cout << "[Logica] Rearme de COLISÃO. Iniciando Back-Off..." <<
+        // std::endl;
+        estado.e_defeito = true;
+        fase_recuo = RECUO_EM_CURSO;
+        fim_recuo = std::chrono::steady_clock::now() + DURACAO_RECUO;
+        gerenciadorDados.setManobraRecuo(true);
+        gerenciadorDados.setComandosAtuador({ACELERACAO_RECUO, 0});
+      } else {
+        // Modos de Operação (Prioridade para MANUAL)
+        if (comandos.c_man) {
+          estado.e_automatico = false;
+        } else if (comandos.c_automatico) {
+          estado.e_automatico = true;
+        }
+        estado.e_defeito = false;
+
+        // std::cout << "[Logica] Sistema REARMADO." << std::endl;
       }
-      estado.e_defeito = false;
-
-      // std::cout << "[Logica] Sistema REARMADO." << std::endl;
     }
 
     // Monitoramento de Falhas (Se não foi rearmado agora)
@@ -77,7 +118,7 @@ void task_logica_comando(GerenciadorDados &gerenciadorDados,
 
     // 3. Agendamento Preciso (Heartbeat)
     // Isso garante 10Hz cravados, compensando o tempo gasto na lógica acima.
-    timer.wait_next_tick(std::chrono::milliseconds(100),
+    timer.wait_next_tick(periodo,
                          [&](const boost::system::error_code &ec) {
                            if (!ec)
                              loop_logica(); // Recursão assíncrona
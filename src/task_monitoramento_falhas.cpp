@@ -6,10 +6,11 @@
 #include <iostream>
 
 void task_monitoramento_falhas(GerenciadorDados &gerenciadorDados,
-                               EventosSistema &eventos, ISensorDriver &driver) {
+                               EventosSistema &eventos, ISensorDriver &driver,
+                               std::chrono::steady_clock::duration periodo) {
   // 1. Setup do Motor de Tempo (Independente)
   boost::asio::io_context io;
-  SleepAsynch timer(io);
+  SleepAsynch timer(io, "MONITOR");
 
   // Loop recursivo para garantir periodicidade
   std::function<void()> loop_monitoramento;
@@ -77,9 +78,8 @@ void task_monitoramento_falhas(GerenciadorDados &gerenciadorDados,
 
     // --- FIM DA LÓGICA ---
 
-    // 5. Agendamento (5Hz é suficiente para monitoramento térmico)
-    // 200ms de período
-    timer.wait_next_tick(std::chrono::milliseconds(200),
+    // 5. Agendamento (5Hz por padrão é suficiente para monitoramento térmico)
+    timer.wait_next_tick(periodo,
                          [&](const boost::system::error_code &ec) {
                            if (!ec)
                              loop_monitoramento();
@@ -1,24 +1,28 @@
 #include "task_planejamento_rota.h"
+#include "cache_caminhos.h"
+#include "controlador_mpc.h"
+#include "perfil_velocidade.h"
+#include "planejador_rota.h"
 #include "utils/sleep_asynch.h"
+#include <algorithm>
 #include <cmath>
-#include <deque>
 #include <functional>
 #include <iostream>
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
+#include <memory>
 
-// Simple Point Struct for the internal queue
-struct Point {
-  float x, y;
-  float speed;
-};
-
-void task_planejamento_rota(GerenciadorDados &dados, MqttDriver &mqtt) {
+void task_planejamento_rota(GerenciadorDados &dados, MqttDriver &mqtt,
+                            std::chrono::steady_clock::duration periodo) {
   boost::asio::io_context io;
-  SleepAsynch timer(io);
+  SleepAsynch timer(io, "PLANNER");
+
+  // Internal Route Queue (The "Mission"): anel de capacidade fixa com a
+  // janela de waypoints; a missão em si fica no buffer do driver, indexada
+  // por proximo_ponto
+  Rota rota;
 
-  // Internal Route Queue (The "Mission")
-  std::deque<Point> rota;
+  // Planejador embarcado (JPS sobre o mapa publicado pelo simulador)
+  PlanejadorRota planejador;
+  std::vector<std::vector<char>> mapa;
 
   // std::cout << "[PLANNER] Task de Planejamento de Rota INICIADA." <<
   // std::endl;
@@ -34,6 +38,29 @@ void task_planejamento_rota(GerenciadorDados &dados, MqttDriver &mqtt) {
   // Acceptance radius (in meters)
   const float RAIO_CHEGADA = 5.0f;
 
+  // Tempo de CPU por ciclo para reparar o desvio (D* Lite)
+  const int ORCAMENTO_DESVIO_US = 20000;
+  bool desvio_falhou = false;
+
+  // O perfil de velocidade só é refeito quando a rota muda (não a cada
+  // waypoint alcançado)
+  bool rota_alterada = false;
+
+  // Três perfis alocados uma vez: o publicado, o que a navegação ainda lê
+  // (troca só no ciclo seguinte à publicação, ou nunca, fora do modo
+  // automático) e um livre para reconstruir quando a rota muda
+  std::shared_ptr<PerfilVelocidade> perfis[3] = {
+      std::make_shared<PerfilVelocidade>(),
+      std::make_shared<PerfilVelocidade>(),
+      std::make_shared<PerfilVelocidade>()};
+  const PerfilVelocidade *perfil_publicado = nullptr;
+
+  // Missão recebida (buffer do driver, válido até a próxima missão) e
+  // próximo waypoint dela ainda fora da fila
+  const MissaoDecodificada *missao = nullptr;
+  size_t proximo_ponto = 0;
+  const size_t JANELA_WAYPOINTS = 16;
+
   std::function<void()> loop_planejamento;
   loop_planejamento = [&]() {
     // 1. Get Current Position (Snapshot)
@@ -42,28 +69,120 @@ void task_planejamento_rota(GerenciadorDados &dados, MqttDriver &mqtt) {
     float pos_y = static_cast<float>(estado.i_posicao_y);
 
     // 2. Check MQTT for new missions (Phase 2 feature)
-    // 2. Check MQTT for new missions
-    std::string nova_missao = mqtt.checkNewRoute();
-    if (!nova_missao.empty()) {
-      try {
-        auto j = json::parse(nova_missao);
-        if (j.contains("route") && j["route"].is_array()) {
-          rota.clear();
-          // std::cout << "[PLANNER] Nova rota recebida com " <<
-          // j["route"].size()
-          //           << " pontos." << std::endl;
-          for (const auto &p : j["route"]) {
-            float x = p["x"];
-            float y = p["y"];
-            float speed = p.contains("speed") ? (float)p["speed"] : 20.0f;
-            rota.push_back({x, y, speed});
+    if (mqtt.checkNewMap(mapa)) {
+      planejador.setMapa(mapa);
+      dados.setMapaFolga(
+          std::make_shared<MapaFolga>(mapa, TAMANHO_CELULA_PADRAO));
+      std::cout << "[PLANNER] Mapa recebido (" << planejador.getGrade().largura()
+                << "x" << planejador.getGrade().altura() << ")" << std::endl;
+    }
+
+    // Grafo HPA* construído em segundo plano (mapas grandes)
+    if (planejador.receberHierarquia())
+      std::cout << "[PLANNER] Grafo hierarquico pronto." << std::endl;
+
+    // 2. Check MQTT for new missions (já decodificadas pelo driver)
+    const MissaoDecodificada *nova = mqtt.checkNewMission();
+    if (nova) {
+      const CacheCaminhos &cache = planejador.getCacheCaminhos();
+      std::cout << "[PLANNER] Cache de caminhos: " << cache.acertos()
+                << " acertos, " << cache.falhas() << " falhas (~"
+                << cache.economizadoUs() / 1000.0 << " ms economizados)"
+                << std::endl;
+      rota.clear();
+      planejador.descartarPendente();
+      desvio_falhou = false;
+      rota_alterada = true;
+      missao = nullptr;
+      if (nova->tem_destino) {
+        // Missão só com destino: o caminho é planejado a bordo
+        const Point &g = nova->destino;
+        if (!planejador.planejarMissao(pos_x, pos_y, g.x, g.y, g.speed, rota))
+          std::cerr << "[PLANNER] Sem caminho ate (" << g.x << "," << g.y
+                    << ")." << std::endl;
+      } else {
+        missao = nova;
+        proximo_ponto = 0;
+      }
+    }
+
+    // Waypoints da missão entram na fila em janelas, direto do buffer do
+    // driver: o custo por ciclo não depende do tamanho da rota. Um trecho JPS
+    // que não coube no anel termina de entrar antes da janela seguinte.
+    if (missao && rota.size() < JANELA_WAYPOINTS / 2 &&
+        !planejador.temPendente() &&
+        proximo_ponto < missao->pontos.size()) {
+      size_t fim =
+          std::min(missao->pontos.size(), proximo_ponto + JANELA_WAYPOINTS);
+      // Metade do anel fica livre para os trechos planejados com JPS; o que
+      // não couber entra na próxima janela
+      for (; proximo_ponto < fim && rota.size() < Rota::capacity() / 2;
+           ++proximo_ponto) {
+        const Point &p = missao->pontos[proximo_ponto];
+        float ox = rota.empty() ? pos_x : rota.back().x;
+        float oy = rota.empty() ? pos_y : rota.back().y;
+        // Trechos que atravessam paredes são substituídos por caminhos JPS
+        if (planejador.segmentoTransitavel(ox, oy, p.x, p.y)) {
+          rota.push_back(p);
+        } else if (!planejador.planejar(ox, oy, p.x, p.y, p.speed, rota)) {
+          std::cerr << "[PLANNER] Trecho sem caminho transitavel; mantendo "
+                       "waypoint original."
+                    << std::endl;
+          rota.push_back(p);
+        }
+      }
+      rota_alterada = true;
+    }
+
+    // Missões longas (HPA*) são refinadas só alguns trechos à frente; o que
+    // não coube no anel entra quando a fila esvazia
+    size_t tamanho_antes = rota.size();
+    if (rota.size() < 3 && !planejador.refinarPendente(rota))
+      std::cerr << "[PLANNER] Falha ao refinar rota pendente." << std::endl;
+    if (rota.size() != tamanho_antes)
+      rota_alterada = true;
+
+    // Bloqueio visto pelo LiDAR: marca a célula e desvia a rota
+    BloqueioDetectado bloqueio;
+    if (dados.consumirBloqueio(bloqueio) &&
+        planejador.marcarBloqueio(bloqueio.x, bloqueio.y))
+      std::cout << "[PLANNER] Bloqueio em (" << bloqueio.x << "," << bloqueio.y
+                << "); replanejando." << std::endl;
+    tamanho_antes = rota.size();
+    Point frente_antes = rota.empty() ? Point{0, 0, 0} : rota.front();
+    if (!planejador.desviarBloqueios(pos_x, pos_y, rota,
+                                     ORCAMENTO_DESVIO_US)) {
+      std::cerr << "[PLANNER] Sem desvio para o bloqueio." << std::endl;
+      desvio_falhou = true; // O CAS volta a intertravar
+    }
+    if (rota.size() != tamanho_antes ||
+        (!rota.empty() && (rota.front().x != frente_antes.x ||
+                           rota.front().y != frente_antes.y)))
+      rota_alterada = true;
+
+    // Suaviza a rota e publica o perfil de velocidade para a navegação
+    if (rota_alterada) {
+      rota_alterada = false;
+      std::shared_ptr<PerfilVelocidade> perfil;
+      if (!rota.empty()) {
+        // A navegação só pega o publicado: com três, sempre sobra um livre
+        const PerfilVelocidade *em_uso = dados.perfilEmUso();
+        for (const std::shared_ptr<PerfilVelocidade> &p : perfis) {
+          if (p.get() != em_uso && p.get() != perfil_publicado) {
+            perfil = p;
+            break;
           }
         }
-      } catch (const std::exception &e) {
-        std::cerr << "[PLANNER] Erro ao parsear rota: " << e.what()
-                  << std::endl;
+        bool continua = planejador.temPendente() ||
+                        (missao && proximo_ponto < missao->pontos.size());
+        perfil->construir(pos_x, pos_y, (float)estado.i_velocidade, rota,
+                          !continua);
       }
+      perfil_publicado = perfil.get();
+      dados.setPerfilVelocidade(perfil);
     }
+    dados.setReplanejamentoAtivo(planejador.temMapa() && !rota.empty() &&
+                                 !desvio_falhou);
 
     // 3. Logic: Update Objective
     ObjetivoNavegacao novoObjetivo;
@@ -90,6 +209,8 @@ void task_planejamento_rota(GerenciadorDados &dados, MqttDriver &mqtt) {
         // If route finished, stop immediately
         if (rota.empty()) {
           novoObjetivo = {false, 0, 0, 0};
+          perfil_publicado = nullptr;
+          dados.setPerfilVelocidade(nullptr);
         } else {
           alvo = rota.front();
           novoObjetivo = {true, alvo.x, alvo.y, alvo.speed};
@@ -103,8 +224,8 @@ void task_planejamento_rota(GerenciadorDados &dados, MqttDriver &mqtt) {
     // 4. Write to Shared Memory (Direct Memory Access)
     dados.setObjetivo(novoObjetivo);
 
-    // Run at 10Hz (Planning doesn't need to be as fast as Control)
-    timer.wait_next_tick(std::chrono::milliseconds(100),
+    // Padrão 10Hz (Planning doesn't need to be as fast as Control)
+    timer.wait_next_tick(periodo,
                          [&](const boost::system::error_code &ec) {
                            if (!ec)
                              loop_planejamento();
@@ -1,5 +1,8 @@
 #include "task_tratamento_sensores.h"
 #include "simulacao_mina.h"
+#include "utils/medidor_periodo.h"
+#include "utils/trigonometria.h"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <iostream>
@@ -10,6 +13,7 @@
 // Constantes do filtro
 const int N = 10;                  // Número de períodos para suavização
 const float K = 2.0f / (1.0f + N); // Fator de suavização
+const float PERIODO_REFERENCIA_EMA = 0.1f; // Período para o qual K foi ajustado
 
 /**
  * @brief Calcula o próximo valor da Média Móvel Exponencial (EMA).
@@ -23,6 +27,11 @@ float calcular_media_movel_exponencial(float valor_atual,
   return (valor_atual - media_anterior) * K + media_anterior;
 }
 
+float calcular_media_movel_exponencial(float valor_atual, float media_anterior,
+                                       float k) {
+  return (valor_atual - media_anterior) * k + media_anterior;
+}
+
 /**
  * @brief Tarefa responsável pela leitura e tratamento dos dados dos sensores.
  *
@@ -35,8 +44,14 @@ float calcular_media_movel_exponencial(float valor_atual,
  * @param id_caminhao ID do caminhão a ser monitorado.
  */
 void task_tratamento_sensores(GerenciadorDados &gerenciadorDados,
-                              ISensorDriver &driver, int id_caminhao) {
+                              ISensorDriver &driver, int id_caminhao,
+                              std::chrono::steady_clock::duration periodo) {
   std::default_random_engine generator;
+  MedidorPeriodo relogio("SENSORES");
+
+  // Mesma constante de tempo do filtro em qualquer taxa: (1 - k)^(1/T) fixo
+  float periodo_s = std::chrono::duration<float>(periodo).count();
+  float k = 1.0f - std::pow(1.0f - K, periodo_s / PERIODO_REFERENCIA_EMA);
 
   // Configuração dos geradores de ruído
   std::normal_distribution<float> noise_pos(0.0, 1.0);
@@ -49,9 +64,17 @@ void task_tratamento_sensores(GerenciadorDados &gerenciadorDados,
   float ema_ang_x = 0.0f;
   bool primeira_leitura = true;
 
+  // Lacunas e idade das amostras da origem (simulador)
+  EstatisticasSensores estatisticas = {0, 0, 0, 0, 0};
+  uint64_t seq_anterior = 0;
+  MedidorLatencia idade("SENSORES idade");
+
   while (true) {
+    relogio.acordou();
+
     // --- 1. Leitura do Estado Real da Simulação ---
-    CaminhaoFisico estadoReal = driver.readSensorData(id_caminhao);
+    CarimboAmostra carimbo;
+    CaminhaoFisico estadoReal = driver.readSensorData(id_caminhao, carimbo);
 
     // --- 2. Aplicação de Ruído (Simulação de Sensores) ---
     float raw_pos_x_f = estadoReal.i_posicao_x + noise_pos(generator);
@@ -70,16 +93,18 @@ void task_tratamento_sensores(GerenciadorDados &gerenciadorDados,
       // evitar convergência lenta
       ema_pos_x = static_cast<float>(raw_pos_x);
       ema_pos_y = static_cast<float>(raw_pos_y);
-      ema_ang_x = static_cast<float>(raw_ang_x);
+      ema_ang_x = normalizar_graus(static_cast<float>(raw_ang_x));
       primeira_leitura = false;
     } else {
       // Nas leituras subsequentes, aplicamos o filtro EMA
       ema_pos_x = calcular_media_movel_exponencial(
-          static_cast<float>(raw_pos_x), ema_pos_x);
+          static_cast<float>(raw_pos_x), ema_pos_x, k);
       ema_pos_y = calcular_media_movel_exponencial(
-          static_cast<float>(raw_pos_y), ema_pos_y);
-      ema_ang_x = calcular_media_movel_exponencial(
-          static_cast<float>(raw_ang_x), ema_ang_x);
+          static_cast<float>(raw_pos_y), ema_pos_y, k);
+      // Rumo filtrado sobre o círculo: a média linear passaria por 180 graus
+      // na volta 359 -> 0
+      ema_ang_x =
+          media_movel_angulo(static_cast<float>(raw_ang_x), ema_ang_x, k);
     }
 
     // --- 4. Empacotamento e Envio ---
@@ -109,8 +134,31 @@ void task_tratamento_sensores(GerenciadorDados &gerenciadorDados,
               << " Y=" << novosDados.i_posicao_y
               << " Temp=" << novosDados.i_temperatura << std::endl;
 
+    novosDados.carimbo = carimbo;
+
+    // --- 5. Lacunas e idade ---
+    // Sequência repetida: a origem não produziu nada novo desde o último
+    // ciclo; salto: amostras perdidas no MQTT ou sobrescritas no driver. Uma
+    // sequência menor é recomeço da origem e só reinicia a contagem.
+    if (carimbo.seq != 0) {
+      if (carimbo.seq == seq_anterior) {
+        ++estatisticas.repetidas;
+      } else {
+        if (seq_anterior != 0 && carimbo.seq > seq_anterior + 1)
+          estatisticas.perdidas += carimbo.seq - seq_anterior - 1;
+        ++estatisticas.amostras;
+      }
+      seq_anterior = carimbo.seq;
+      estatisticas.idade_us = relogio_monotonico_us() - carimbo.t_origem_us;
+      estatisticas.idade_max_us =
+          std::max(estatisticas.idade_max_us, estatisticas.idade_us);
+      idade.registrar(std::chrono::steady_clock::time_point(
+          std::chrono::microseconds(carimbo.t_origem_us)));
+      gerenciadorDados.setEstatisticasSensores(estatisticas);
+    }
+
     gerenciadorDados.setDados(novosDados);
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::this_thread::sleep_until(relogio.proximo(periodo));
   }
 }
@@ -0,0 +1,108 @@
+#include "utils/medidor_periodo.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+const std::chrono::seconds INTERVALO_RELATORIO(10);
+}
+
+MedidorPeriodo::MedidorPeriodo(const std::string &nome)
+    : nome(nome), previsto(std::chrono::steady_clock::now()),
+      anterior(previsto), ultimo_relatorio(previsto), tem_anterior(false),
+      ultimo_periodo(0.0) {
+  reiniciar();
+}
+
+void MedidorPeriodo::reiniciar() {
+  ciclos = 0;
+  soma = soma2 = 0.0;
+  minimo = maximo = atraso_max = 0.0;
+  estouros = 0;
+}
+
+void MedidorPeriodo::acordou() {
+  auto agora = std::chrono::steady_clock::now();
+  double atraso =
+      std::chrono::duration<double, std::milli>(agora - previsto).count();
+  if (tem_anterior) {
+    double p =
+        std::chrono::duration<double, std::milli>(agora - anterior).count();
+    ultimo_periodo = p / 1000.0;
+    minimo = ciclos == 0 ? p : std::min(minimo, p);
+    maximo = ciclos == 0 ? p : std::max(maximo, p);
+    soma += p;
+    soma2 += p * p;
+    ++ciclos;
+    atraso_max = std::max(atraso_max, atraso);
+  }
+  anterior = agora;
+  tem_anterior = true;
+
+  if (!nome.empty() &&
+      agora - ultimo_relatorio >= INTERVALO_RELATORIO) {
+    ultimo_relatorio = agora;
+    EstatisticasPeriodo e = estatisticas();
+    std::cout << "[" << nome << "] periodo " << e.medio << " ms (min "
+              << e.minimo << ", max " << e.maximo << "), jitter " << e.desvio
+              << " ms, atraso max " << e.atraso_max << " ms, estouros "
+              << e.estouros << "/" << e.ciclos << std::endl;
+    reiniciar();
+  }
+}
+
+void MedidorPeriodo::acordou(std::chrono::steady_clock::time_point evento,
+                             std::chrono::steady_clock::duration prazo) {
+  previsto = evento;
+  if (tem_anterior && std::chrono::steady_clock::now() - evento > prazo)
+    ++estouros;
+  acordou();
+}
+
+std::chrono::steady_clock::time_point
+MedidorPeriodo::proximo(std::chrono::steady_clock::duration periodo) {
+  previsto += periodo;
+  auto agora = std::chrono::steady_clock::now();
+  if (previsto < agora) {
+    ++estouros;
+    previsto = agora;
+  }
+  return previsto;
+}
+
+EstatisticasPeriodo MedidorPeriodo::estatisticas() const {
+  EstatisticasPeriodo e{ciclos, 0.0, 0.0, minimo, maximo, atraso_max,
+                        estouros};
+  if (ciclos > 0) {
+    e.medio = soma / ciclos;
+    e.desvio = std::sqrt(std::max(0.0, soma2 / ciclos - e.medio * e.medio));
+  }
+  return e;
+}
+
+MedidorLatencia::MedidorLatencia(const std::string &nome)
+    : nome(nome), ultimo_relatorio(std::chrono::steady_clock::now()) {
+  reiniciar();
+}
+
+void MedidorLatencia::reiniciar() {
+  n = 0;
+  soma = min_ms = max_ms = 0.0;
+}
+
+void MedidorLatencia::registrar(std::chrono::steady_clock::time_point origem) {
+  auto agora = std::chrono::steady_clock::now();
+  double ms = std::chrono::duration<double, std::milli>(agora - origem).count();
+  min_ms = n == 0 ? ms : std::min(min_ms, ms);
+  max_ms = n == 0 ? ms : std::max(max_ms, ms);
+  soma += ms;
+  ++n;
+
+  if (!nome.empty() && agora - ultimo_relatorio >= INTERVALO_RELATORIO) {
+    ultimo_relatorio = agora;
+    std::cout << "[" << nome << "] latencia " << media() << " ms (min "
+              << min_ms << ", max " << max_ms << ") em " << n << " amostras"
+              << std::endl;
+    reiniciar();
+  }
+}
@@ -1,17 +1,17 @@
 #include "utils/sleep_asynch.h"
 
 // Implementação do construtor
-SleepAsynch::SleepAsynch(boost::asio::io_context& io) 
-    : timer_(io) {
-        
-     next_wake_time_ = std::chrono::steady_clock::now();
-}
+SleepAsynch::SleepAsynch(boost::asio::io_context& io, const std::string& nome)
+    : timer_(io), medidor_(nome) {}
 
 // Implementação do método
-void SleepAsynch::wait_next_tick(std::chrono::milliseconds period, Callback on_complete) {
-    
-    // Define o tempo de expiração
-    next_wake_time_ += period;
-    timer_.expires_at(next_wake_time_); 
-    timer_.async_wait(on_complete);
+void SleepAsynch::wait_next_tick(std::chrono::steady_clock::duration period, Callback on_complete) {
+
+    // Define o tempo de expiração (sem deriva; realinha se o ciclo estourou)
+    timer_.expires_at(medidor_.proximo(period));
+    timer_.async_wait([this, on_complete](const boost::system::error_code& ec) {
+        if (!ec)
+            medidor_.acordou();
+        on_complete(ec);
+    });
 }
\ No newline at end of file
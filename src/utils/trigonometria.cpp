@@ -0,0 +1,42 @@
+#include "utils/trigonometria.h"
+
+// Geração da tabela em tempo de compilação. Em C++11 uma função constexpr
+// tem um único return, então a série é recursiva e os índices da tabela
+// vêm de um pacote de parâmetros.
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+template <size_t... I> struct Indices {};
+template <size_t N, size_t... I>
+struct GerarIndices : GerarIndices<N - 1, N - 1, I...> {};
+template <size_t... I> struct GerarIndices<0, I...> {
+  typedef Indices<I...> tipo;
+};
+
+// Série de Taylor do seno; com x em [-pi, pi], 20 termos sobram
+constexpr double serie_seno(double x2, double termo, int k) {
+  return k > 20 ? 0.0
+                : termo + serie_seno(x2, -termo * x2 / ((2 * k) * (2 * k + 1)),
+                                     k + 1);
+}
+
+constexpr double seno(double x) { return serie_seno(x * x, x, 1); }
+
+constexpr double seno_grau_inteiro(size_t g) {
+  return seno((g > 180 ? (double)g - 360.0 : (double)g) * PI / 180.0);
+}
+
+template <size_t... I>
+constexpr TabelaTrig<sizeof...(I)> gerar_seno(Indices<I...>) {
+  return TabelaTrig<sizeof...(I)>{{(float)seno_grau_inteiro(I)...}};
+}
+
+} // namespace
+
+constexpr TabelaTrig<PONTOS_SENO> TABELA_SENO =
+    gerar_seno(GerarIndices<PONTOS_SENO>::tipo());
+
+static_assert(TABELA_SENO.v[90] == 1.0f && TABELA_SENO.v[270] == -1.0f,
+              "tabela de seno gerada incorretamente");
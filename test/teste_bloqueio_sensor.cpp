@@ -0,0 +1,116 @@
+// Teste: bloqueios vistos pelo LiDAR valem para as buscas seguintes (missão
+// nova, janela de waypoints, campo de fluxo) e um bloqueio reavisado volta a
+// desviar a rota que o cruza.
+//
+// Uso: bin/teste_bloqueio_sensor (código de saída 0 = passou)
+
+#include "campo_fluxo.h"
+#include "planejador_rota.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int LADO = 64;
+const float CELULA = TAMANHO_CELULA_PADRAO;
+int falhas = 0;
+
+void verificar(bool ok, const char *descricao) {
+  std::printf("%s: %s\n", ok ? "ok   " : "FALHA", descricao);
+  if (!ok)
+    ++falhas;
+}
+
+// Mapa aberto com parede na borda
+std::vector<std::vector<char>> mapa_aberto() {
+  std::vector<std::vector<char>> m(LADO, std::vector<char>(LADO, '0'));
+  for (int i = 0; i < LADO; ++i)
+    m[0][i] = m[LADO - 1][i] = m[i][0] = m[i][LADO - 1] = '1';
+  return m;
+}
+
+float centro(int c) { return (c + 0.5f) * CELULA; }
+
+// Amostra cada trecho da rota a cada 1/8 de célula
+bool cruza(float x0, float y0, const Rota &rota, int cx, int cy) {
+  for (const Point &p : rota) {
+    for (int k = 0; k <= 64; ++k) {
+      float t = k / 64.0f;
+      int x = (int)((x0 + (p.x - x0) * t) / CELULA);
+      int y = (int)((y0 + (p.y - y0) * t) / CELULA);
+      if (x == cx && y == cy)
+        return true;
+    }
+    x0 = p.x;
+    y0 = p.y;
+  }
+  return false;
+}
+
+// Missão em linha reta pelo meio do mapa, com um bloqueio no caminho
+void missao_nova() {
+  PlanejadorRota p;
+  p.setMapa(mapa_aberto());
+  verificar(p.marcarBloqueio(centro(32), centro(32)), "bloqueio marcado");
+  verificar(!p.segmentoTransitavel(centro(5), centro(32), centro(58),
+                                   centro(32)),
+            "janela: segmento pelo bloqueio nao e transitavel");
+
+  Rota rota;
+  bool ok = p.planejarMissao(centro(5), centro(32), centro(58), centro(32),
+                             10.0f, rota);
+  verificar(ok && !rota.empty(), "missao planejada");
+  verificar(!cruza(centro(5), centro(32), rota, 32, 32),
+            "missao nova contorna o bloqueio");
+}
+
+// Campo de fluxo gerado antes do bloqueio não pode mais ser seguido
+void campo_fluxo() {
+  PlanejadorRota p;
+  p.setMapa(mapa_aberto());
+  Rota rota;
+  for (int i = 0; i < 200 && p.getCamposFluxo().tamanho() == 0; ++i) {
+    rota.clear();
+    p.planejarMissao(centro(5), centro(32), centro(58), centro(32), 10.0f,
+                     rota);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  verificar(p.getCamposFluxo().tamanho() == 1, "campo de fluxo gerado");
+
+  p.marcarBloqueio(centro(32), centro(32));
+  rota.clear();
+  bool ok = p.planejarMissao(centro(5), centro(32), centro(58), centro(32),
+                             10.0f, rota);
+  verificar(ok && !cruza(centro(5), centro(32), rota, 32, 32),
+            "rota do destino com campo contorna o bloqueio");
+}
+
+// Rota antiga que volta a cruzar um bloqueio já marcado
+void bloqueio_reavisado() {
+  PlanejadorRota p;
+  p.setMapa(mapa_aberto());
+  p.marcarBloqueio(centro(32), centro(32));
+  Rota rota;
+  p.desviarBloqueios(centro(5), centro(32), rota, 100000);
+
+  rota.push_back(Point{centro(58), centro(32), 10.0f});
+  verificar(!p.marcarBloqueio(centro(32), centro(32)),
+            "reaviso nao marca de novo");
+  bool ok = p.desviarBloqueios(centro(5), centro(32), rota, 100000);
+  verificar(ok && !cruza(centro(5), centro(32), rota, 32, 32),
+            "reaviso desvia a rota que cruza o bloqueio");
+  verificar(!rota.empty() && rota.back().x == centro(58) &&
+                rota.back().y == centro(32),
+            "desvio termina no waypoint original");
+}
+
+} // namespace
+
+int main() {
+  missao_nova();
+  campo_fluxo();
+  bloqueio_reavisado();
+  return falhas == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+// Teste: caminho com mais waypoints do que cabem no anel da rota. O que não
+// cabe fica pendente e entra conforme a fila esvazia, sem trechos que cruzem
+// paredes e terminando no destino pedido.
+//
+// Uso: bin/teste_rota_longa (código de saída 0 = passou)
+
+#include "planejador_rota.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int LARGURA = 6;
+const int CORREDORES = 2200; // ~2 waypoints por corredor: passa de 2048
+const int ALTURA = 2 * CORREDORES + 1;
+const float CELULA = TAMANHO_CELULA_PADRAO;
+int falhas = 0;
+
+void verificar(bool ok, const char *descricao) {
+  std::printf("%s: %s\n", ok ? "ok   " : "FALHA", descricao);
+  if (!ok)
+    ++falhas;
+}
+
+// Serpentina: corredores nas linhas ímpares, ligados por uma passagem que
+// alterna entre as pontas
+std::vector<std::vector<char>> mapa_serpentina() {
+  std::vector<std::vector<char>> m(ALTURA, std::vector<char>(LARGURA, '1'));
+  for (int y = 1; y < ALTURA - 1; y += 2)
+    for (int x = 1; x < LARGURA - 1; ++x)
+      m[y][x] = '0';
+  for (int y = 2; y < ALTURA - 1; y += 2)
+    m[y][(y / 2) % 2 ? LARGURA - 2 : 1] = '0';
+  return m;
+}
+
+float centro(int c) { return (c + 0.5f) * CELULA; }
+
+void rota_maior_que_o_anel() {
+  PlanejadorRota p;
+  p.setMapa(mapa_serpentina());
+  float x1 = centro(CORREDORES % 2 ? LARGURA - 2 : 1);
+  float y1 = centro(ALTURA - 2);
+
+  Rota rota;
+  bool ok = p.planejarMissao(centro(1), centro(1), x1, y1, 10.0f, rota);
+  verificar(ok && rota.full(), "missao enche o anel");
+  verificar(p.temPendente(), "restante fica pendente");
+
+  // Percorre a rota como a tarefa: consome waypoints e refina com a fila
+  // quase vazia
+  float x0 = centro(1), y0 = centro(1);
+  size_t percorridos = 0, cruzam = 0;
+  bool refino_ok = true;
+  Point ultimo = Point{x0, y0, 0};
+  while (!rota.empty() || p.temPendente()) {
+    if (rota.size() < 3)
+      refino_ok = p.refinarPendente(rota) && refino_ok;
+    if (rota.empty())
+      break;
+    ultimo = rota.front();
+    rota.pop_front();
+    if (!p.segmentoTransitavel(x0, y0, ultimo.x, ultimo.y))
+      ++cruzam;
+    x0 = ultimo.x;
+    y0 = ultimo.y;
+    ++percorridos;
+  }
+  std::printf("       %zu waypoints percorridos\n", percorridos);
+  verificar(refino_ok && !p.temPendente(), "pendente anexado por inteiro");
+  verificar(percorridos > Rota::capacity(), "rota maior que o anel");
+  verificar(cruzam == 0, "nenhum trecho cruza parede");
+  verificar(ultimo.x == x1 && ultimo.y == y1, "rota termina no destino");
+}
+
+} // namespace
+
+int main() {
+  rota_maior_que_o_anel();
+  return falhas == 0 ? 0 : 1;
+}